@@ -0,0 +1,115 @@
+//
+//  cache_stats.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "cache_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+// The percentiles exported for each histogram, and their names.
+constexpr pair<double, const char*> kPercentiles[] = {
+  { 0.5, "p50" }, { 0.99, "p99" }, { 0.999, "p999" },
+};
+
+} // namespace
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  max_ = max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const {
+  if (count_ == 0) {
+    return 0;
+  }
+
+  uint64_t rank = max<uint64_t>(1, uint64_t(ceil(fraction * count_)));
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return i + 1 < kNumBuckets ? min(max_, BucketStart(i + 1) - 1) : max_;
+    }
+  }
+  return max_;
+}
+
+uint64_t LatencyHistogram::BucketStart(int bucket) {
+  if (bucket < (1 << kSubBucketBits)) {
+    return bucket;
+  }
+  int exponent = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+  uint64_t mantissa = (1 << kSubBucketBits) | (bucket & ((1 << kSubBucketBits) - 1));
+  return mantissa << (exponent - kSubBucketBits);
+}
+
+CacheStats& CacheStats::operator+=(const CacheStats& other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  inserts_ += other.inserts_;
+  updates_ += other.updates_;
+  evictions_ += other.evictions_;
+  expirations_ += other.expirations_;
+  size_ += other.size_;
+  weight_ += other.weight_;
+  get_latency_.Merge(other.get_latency_);
+  put_latency_.Merge(other.put_latency_);
+  return *this;
+}
+
+string CacheStats::ToText() const {
+  ostringstream out;
+  out << "hits " << hits_ << "\n"
+      << "misses " << misses_ << "\n"
+      << "hit_ratio " << HitRatio() << "\n"
+      << "inserts " << inserts_ << "\n"
+      << "updates " << updates_ << "\n"
+      << "evictions " << evictions_ << "\n"
+      << "expirations " << expirations_ << "\n"
+      << "size " << size_ << "\n"
+      << "weight " << weight_ << "\n";
+  for (auto [name, histogram] : { pair("get_latency_ns", &get_latency_), pair("put_latency_ns", &put_latency_) }) {
+    out << name << "_count " << histogram->Count() << "\n"
+        << name << "_mean " << histogram->Mean() << "\n";
+    for (auto [fraction, percentile] : kPercentiles) {
+      out << name << "_" << percentile << " " << histogram->Percentile(fraction) << "\n";
+    }
+    out << name << "_max " << histogram->Max() << "\n";
+  }
+  return out.str();
+}
+
+string CacheStats::ToJson() const {
+  ostringstream out;
+  out << "{\"hits\":" << hits_
+      << ",\"misses\":" << misses_
+      << ",\"hit_ratio\":" << HitRatio()
+      << ",\"inserts\":" << inserts_
+      << ",\"updates\":" << updates_
+      << ",\"evictions\":" << evictions_
+      << ",\"expirations\":" << expirations_
+      << ",\"size\":" << size_
+      << ",\"weight\":" << weight_;
+  for (auto [name, histogram] : { pair("get_latency_ns", &get_latency_), pair("put_latency_ns", &put_latency_) }) {
+    out << ",\"" << name << "\":{\"count\":" << histogram->Count()
+        << ",\"mean\":" << histogram->Mean();
+    for (auto [fraction, percentile] : kPercentiles) {
+      out << ",\"" << percentile << "\":" << histogram->Percentile(fraction);
+    }
+    out << ",\"max\":" << histogram->Max() << "}";
+  }
+  out << "}";
+  return out.str();
+}
@@ -0,0 +1,116 @@
+//
+//  cache_stats.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef cache_stats_hpp
+#define cache_stats_hpp
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// A histogram of latencies in nanoseconds, with log-linear buckets: 4 per
+// power of 2, so a percentile is accurate to within 25%. Recording is a
+// few arithmetic ops and an increment, no allocation.
+class LatencyHistogram {
+public:
+  static constexpr int kSubBucketBits = 2;
+  static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+  void Record(uint64_t nanos) {
+    ++buckets_[BucketOf(nanos)];
+    ++count_;
+    sum_ += nanos;
+    if (nanos > max_) {
+      max_ = nanos;
+    }
+  }
+
+  // Adds other's latencies to this one's.
+  void Merge(const LatencyHistogram& other);
+
+  uint64_t Count() const { return count_; }
+  uint64_t Max() const { return max_; }
+  double Mean() const { return count_ ? double(sum_) / count_ : 0; }
+
+  // Returns a latency that fraction (0 to 1) of those recorded are at or
+  // below: the top of the bucket the percentile falls in, or the maximum
+  // if that is lower. 0 if nothing was recorded.
+  uint64_t Percentile(double fraction) const;
+
+private:
+  static int BucketOf(uint64_t nanos) {
+    if (nanos < (1 << kSubBucketBits)) {
+      return int(nanos);
+    }
+    // The power of 2, then the next kSubBucketBits bits below it.
+    int exponent = bit_width(nanos) - 1;
+    int sub_bucket = int(nanos >> (exponent - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+    return ((exponent - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket;
+  }
+
+  // Returns the least latency that goes in bucket.
+  static uint64_t BucketStart(int bucket);
+
+  array<uint64_t, kNumBuckets> buckets_ = {};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+// Records the time from its construction to its destruction in a
+// histogram, unless given none (then it doesn't read the clock at all).
+class ScopedLatency {
+public:
+  ScopedLatency(LatencyHistogram* histogram)
+      : histogram_(histogram),
+        start_(histogram ? chrono::steady_clock::now() : chrono::steady_clock::time_point()) {}
+  virtual ~ScopedLatency() {
+    if (histogram_) {
+      histogram_->Record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start_).count());
+    }
+  }
+
+private:
+  LatencyHistogram* histogram_;
+  chrono::steady_clock::time_point start_;
+};
+
+// Counters for a cache (see LRUCache::GetStats()), summed with += across
+// shards. The latency histograms are only filled in if the cache was
+// asked to record latencies.
+struct CacheStats {
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  // New entries, and values overwritten in place.
+  uint64_t inserts_ = 0;
+  uint64_t updates_ = 0;
+  uint64_t evictions_ = 0;
+  uint64_t expirations_ = 0;
+  // The entries cached when the snapshot was taken, and their total
+  // weight (bytes resident, when the cache weighs entries in bytes).
+  uint64_t size_ = 0;
+  uint64_t weight_ = 0;
+  LatencyHistogram get_latency_;
+  LatencyHistogram put_latency_;
+
+  CacheStats& operator+=(const CacheStats& other);
+
+  // Returns hits over lookups, 0 if there were none.
+  double HitRatio() const { return hits_ + misses_ ? double(hits_) / (hits_ + misses_) : 0; }
+
+  // Returns the stats as lines of "name value", latencies in nanoseconds.
+  string ToText() const;
+
+  // Returns the stats as a JSON object, latencies in nanoseconds.
+  string ToJson() const;
+};
+
+#endif /* cache_stats_hpp */
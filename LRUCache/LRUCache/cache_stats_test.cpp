@@ -0,0 +1,78 @@
+//
+//  cache_stats_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "cache_stats_test.hpp"
+#include "cache_stats.hpp"
+
+#include <cassert>
+#include <string>
+
+using namespace std;
+
+void CACHE_STATS_TEST_PERCENTILES() {
+  LatencyHistogram histogram;
+  assert(histogram.Percentile(0.5) == 0);
+
+  // 1 to 1000ns, once each.
+  for (uint64_t nanos = 1; nanos <= 1000; ++nanos) {
+    histogram.Record(nanos);
+  }
+  assert(histogram.Count() == 1000);
+  assert(histogram.Max() == 1000);
+  assert(histogram.Mean() == 500.5);
+
+  // Percentiles are the tops of their buckets, no more than 25% high.
+  for (double fraction : { 0.1, 0.5, 0.9, 0.99, 0.999 }) {
+    uint64_t exact = uint64_t(fraction * 1000);
+    uint64_t percentile = histogram.Percentile(fraction);
+    assert(percentile >= exact && percentile <= exact + exact / 4);
+  }
+  assert(histogram.Percentile(1) == 1000);
+
+  // Small latencies have exact buckets, and huge ones still fit.
+  LatencyHistogram extremes;
+  extremes.Record(0);
+  extremes.Record(3);
+  extremes.Record(UINT64_MAX);
+  assert(extremes.Percentile(0.3) == 0);
+  assert(extremes.Percentile(0.6) == 3);
+  assert(extremes.Percentile(1) == UINT64_MAX);
+
+  histogram.Merge(extremes);
+  assert(histogram.Count() == 1003);
+  assert(histogram.Max() == UINT64_MAX);
+}
+
+void CACHE_STATS_TEST_EXPORT() {
+  CacheStats stats;
+  stats.hits_ = 3;
+  stats.misses_ = 1;
+  stats.evictions_ = 2;
+  CacheStats other = stats;
+  other.size_ = 10;
+  other.put_latency_.Record(100);
+  stats += other;
+  assert(stats.hits_ == 6 && stats.evictions_ == 4 && stats.size_ == 10);
+  assert(stats.HitRatio() == 0.75);
+
+  string text = stats.ToText();
+  assert(text.find("hits 6\n") != string::npos);
+  assert(text.find("hit_ratio 0.75\n") != string::npos);
+  assert(text.find("put_latency_ns_count 1\n") != string::npos);
+  assert(text.find("get_latency_ns_p99 0\n") != string::npos);
+
+  string json = stats.ToJson();
+  assert(json.front() == '{' && json.back() == '}');
+  assert(json.find("\"hits\":6,\"misses\":2,") != string::npos);
+  assert(json.find("\"put_latency_ns\":{\"count\":1,\"mean\":100,") != string::npos);
+  assert(json.find("\"max\":100}") != string::npos);
+}
+
+void RUN_CACHE_STATS_TESTS() {
+  CACHE_STATS_TEST_PERCENTILES();
+  CACHE_STATS_TEST_EXPORT();
+}
@@ -0,0 +1,13 @@
+//
+//  cache_stats_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef cache_stats_test_hpp
+#define cache_stats_test_hpp
+
+extern void RUN_CACHE_STATS_TESTS();
+
+#endif /* cache_stats_test_hpp */
@@ -0,0 +1,183 @@
+//
+//  clock_cache.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef clock_cache_hpp
+#define clock_cache_hpp
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "lru_cache.hpp"
+#include "swiss_index.hpp"
+
+using namespace std;
+
+// An approximate-LRU cache using the CLOCK (second chance) algorithm.
+// Entries sit in a fixed ring of slots, each with a reference bit. A hit
+// only sets that bit, and doesn't move anything, so Get() is const and
+// may run concurrently with other Get()s (under a shared lock, say). To
+// evict, a hand sweeps the ring, clearing set bits, and takes the first
+// slot whose bit was already clear. Keys are only stored in their slots:
+// a SwissIndex maps hashes to slot indices, as in LRUCache.
+//
+// Otherwise used like LRUCache, with the same requirements on Key, Value,
+// Hash and Eq.
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>>
+class ClockCache {
+public:
+  using KeyType = Key;
+  using ValueType = Value;
+  using HashType = Hash;
+  using EqType = Eq;
+
+  // Get() only reads the cache (see ShardedCache).
+  static constexpr bool kConcurrentGet = true;
+
+  ClockCache(size_t max_size) : slots_(max_size) {
+    assert(max_size < kNullIndex);
+    hash_index_.Reserve(max_size);
+  }
+  virtual ~ClockCache() {}
+
+  size_t Size() const { return hash_index_.Size(); }
+  size_t MaxSize() const { return slots_.size(); }
+
+  // Caches value under key. If key is already cached its value is updated
+  // in place and it is marked referenced. New entries start unreferenced,
+  // so one that is never hit is evicted on the hand's first pass.
+  template <typename K>
+  void Put(K&& key, Value value) {
+    if (slots_.empty()) {
+      return;
+    }
+
+    size_t hash = Hash()(key);
+    Index index = Find(key, hash);
+    if (index != kNullIndex) {
+      Slot& slot = slots_[index];
+      slot.value_ = std::move(value);
+      slot.referenced_.store(true, memory_order_relaxed);
+      return;
+    }
+
+    Insert(Key(std::forward<K>(key)), std::move(value), hash);
+  }
+
+  // Like Put(), but returns the value previously cached under key, or
+  // nullopt if there wasn't one.
+  template <typename K>
+  optional<Value> Upsert(K&& key, Value value) {
+    if (slots_.empty()) {
+      return nullopt;
+    }
+
+    size_t hash = Hash()(key);
+    Index index = Find(key, hash);
+    if (index != kNullIndex) {
+      Slot& slot = slots_[index];
+      optional<Value> previous = std::move(slot.value_);
+      slot.value_ = std::move(value);
+      slot.referenced_.store(true, memory_order_relaxed);
+      return previous;
+    }
+
+    Insert(Key(std::forward<K>(key)), std::move(value), hash);
+    return nullopt;
+  }
+
+  // Returns a pointer to the cached value, or nullptr if key isn't cached.
+  // The pointer is only valid until the next Put() or Upsert().
+  template <typename K>
+  const Value* Get(const K& key) const {
+    Index index = Find(key, Hash()(key));
+    if (index == kNullIndex) {
+      return nullptr;
+    }
+
+    // Only store the bit if it isn't already set, so hot entries' cache
+    // lines aren't written over and over.
+    const Slot& slot = slots_[index];
+    if (!slot.referenced_.load(memory_order_relaxed)) {
+      slot.referenced_.store(true, memory_order_relaxed);
+    }
+    return &slot.value_;
+  }
+
+  // Like Get(), but leaves the entry's reference bit as it is.
+  template <typename K>
+  const Value* Peek(const K& key) const {
+    Index index = Find(key, Hash()(key));
+    return index != kNullIndex ? &slots_[index].value_ : nullptr;
+  }
+
+  template <typename K>
+  bool IsReferencedForTesting(const K& key) const {
+    Index index = Find(key, Hash()(key));
+    return index != kNullIndex && slots_[index].referenced_.load(memory_order_relaxed);
+  }
+
+private:
+  using Index = SwissIndex::Index;
+  static constexpr Index kNullIndex = SwissIndex::kNullIndex;
+
+  struct Slot {
+    Key key_;
+    Value value_;
+    mutable atomic<bool> referenced_ = false;
+  };
+
+  // Returns the slot key, whose hash is hash, is in, or kNullIndex.
+  template <typename K>
+  Index Find(const K& key, size_t hash) const {
+    return hash_index_.Find(hash, [this, &key](Index index) { return Eq()(slots_[index].key_, key); });
+  }
+
+  // Inserts key, whose hash is hash and which must not already be cached,
+  // evicting the entry under the hand if at capacity.
+  void Insert(Key&& key, Value&& value, size_t hash) {
+    Index index;
+    if (hash_index_.Size() < slots_.size()) {
+      // Not full yet, slots fill up in order.
+      index = static_cast<Index>(hash_index_.Size());
+    } else {
+      // Reuse the victim's slot.
+      index = AdvanceHand();
+      bool indexed = hash_index_.Erase(Hash()(slots_[index].key_), index);
+      assert(indexed);
+    }
+    Slot& slot = slots_[index];
+    slot.key_ = std::move(key);
+    slot.value_ = std::move(value);
+    slot.referenced_.store(false, memory_order_relaxed);
+    hash_index_.Insert(hash, index);
+  }
+
+  // Sweeps the hand forward, giving referenced slots a second chance by
+  // clearing their bit, until it reaches an unreferenced slot. Returns
+  // that slot, and leaves the hand just past it.
+  Index AdvanceHand() {
+    while (true) {
+      Index index = hand_;
+      hand_ = hand_ + 1 == slots_.size() ? 0 : hand_ + 1;
+      Slot& slot = slots_[index];
+      if (!slot.referenced_.load(memory_order_relaxed)) {
+        return index;
+      }
+      slot.referenced_.store(false, memory_order_relaxed);
+    }
+  }
+
+  vector<Slot> slots_;
+  SwissIndex hash_index_;
+  Index hand_ = 0;
+};
+
+#endif /* clock_cache_hpp */
@@ -0,0 +1,115 @@
+//
+//  clock_cache_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "clock_cache_test.hpp"
+#include "clock_cache.hpp"
+#include "link_list.hpp"
+#include "sharded_lru_cache.hpp"
+
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void CLOCK_CACHE_TEST_SECOND_CHANCE() {
+  ClockCache<string, int> cache(3);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+  cache.Put("zara", 30);
+  assert(cache.Size() == 3);
+
+  // Nothing has been hit yet.
+  assert(!cache.IsReferencedForTesting("rose"));
+  assert(*cache.Get("rose") == 10);
+  assert(cache.IsReferencedForTesting("rose"));
+
+  // The hand starts at "rose", which gets a second chance, so "mars" is
+  // evicted and "rose" loses its reference bit.
+  cache.Put("luna", 40);
+  assert(!cache.Get("mars"));
+  assert(!cache.IsReferencedForTesting("rose"));
+  assert(*cache.Get("zara") == 30);
+  assert(*cache.Get("luna") == 40);
+
+  // The hand is now at "zara", which was just hit and gets a second
+  // chance. It wraps around to "rose", which is no longer referenced.
+  cache.Put("vega", 50);
+  assert(!cache.Get("rose"));
+  assert(*cache.Get("zara") == 30);
+  assert(*cache.Get("luna") == 40);
+  assert(*cache.Get("vega") == 50);
+  assert(cache.Size() == 3);
+}
+
+void CLOCK_CACHE_TEST_ALL_REFERENCED() {
+  ClockCache<string, int> cache(2);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+  cache.Get("rose");
+  cache.Get("mars");
+
+  // Every slot is referenced, the hand clears them all, comes back
+  // around to where it started and evicts that.
+  cache.Put("zara", 30);
+  assert(!cache.Get("rose"));
+  assert(!cache.IsReferencedForTesting("mars"));
+  assert(*cache.Get("zara") == 30);
+}
+
+void CLOCK_CACHE_TEST_UPDATE() {
+  ClockCache<string, int> cache(2);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+
+  // Updating in place marks the entry referenced, so it survives the
+  // next eviction.
+  const int* rose = cache.Get("rose");
+  assert(cache.Upsert("rose", 11) == 10);
+  assert(cache.Get("rose") == rose);
+  assert(*rose == 11);
+  cache.Put("zara", 30);
+  assert(!cache.Get("mars"));
+  assert(*cache.Get("rose") == 11);
+  assert(cache.Size() == 2);
+}
+
+void CLOCK_CACHE_TEST_CONCURRENT() {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumItems = 2000;
+  constexpr int kNumOps = 20000;
+  ShardedClockCache<string, int> cache(kNumItems / 2, 4);
+  vector<LinkList::Node::Contents> items = LinkList::Node::GetRandomItems(kNumItems);
+
+  // Mostly Get()s, which share their shard's lock, racing with Put()s.
+  vector<thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&cache, &items, t]() {
+      unsigned int seed = t;
+      for (int i = 0; i < kNumOps; ++i) {
+        const LinkList::Node::Contents& item = items[rand_r(&seed) % items.size()];
+        if (i % 10 == 0) {
+          cache.Put(get<0>(item), get<1>(item));
+        } else {
+          optional<int> value = cache.Get(get<0>(item));
+          assert(!value || value == get<1>(item));
+        }
+      }
+    });
+  }
+  for (thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void RUN_CLOCK_CACHE_TESTS() {
+  CLOCK_CACHE_TEST_SECOND_CHANCE();
+  CLOCK_CACHE_TEST_ALL_REFERENCED();
+  CLOCK_CACHE_TEST_UPDATE();
+  CLOCK_CACHE_TEST_CONCURRENT();
+}
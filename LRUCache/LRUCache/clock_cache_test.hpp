@@ -0,0 +1,13 @@
+//
+//  clock_cache_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef clock_cache_test_hpp
+#define clock_cache_test_hpp
+
+extern void RUN_CLOCK_CACHE_TESTS();
+
+#endif /* clock_cache_test_hpp */
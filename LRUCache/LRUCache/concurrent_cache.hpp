@@ -0,0 +1,225 @@
+//
+//  concurrent_cache.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef concurrent_cache_hpp
+#define concurrent_cache_hpp
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "epoch.hpp"
+#include "lru_cache.hpp"
+
+using namespace std;
+
+// A CLOCK cache whose Get() takes no lock and writes nothing shared, for
+// read-heavy workloads that need to scale across every core. Each entry
+// is an immutable, heap-allocated node on a bucket's chain of atomic
+// pointers. Get() walks the chain inside an EpochManager::Guard, copies
+// out the value, and records the hit by setting the node's reference bit,
+// only if it isn't already set: no retries, no CAS, and no writes to hot
+// entries' cache lines.
+//
+// Put() and Erase() are serialized by a writer lock. They never change a
+// node a reader may be on: an update links in a new node in place of the
+// old, and eviction (by CLOCK, as in ClockCache) unlinks the victim. The
+// nodes unlinked are retired to the EpochManager, and deleted once no
+// reader can still reach them.
+//
+// Value must be copyable, as Get() returns a copy. Otherwise used like
+// LRUCache, with the same requirements on Key, Hash and Eq. At most
+// EpochManager::kMaxThreads threads may use caches at once.
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>>
+class ConcurrentCache {
+public:
+  using KeyType = Key;
+  using ValueType = Value;
+  using HashType = Hash;
+  using EqType = Eq;
+
+  // Buckets for up to max_size entries, at a load factor of at most 1.
+  ConcurrentCache(size_t max_size)
+      : buckets_(bit_ceil(max(max_size, size_t(2)))),
+        bucket_shift_(64 - countr_zero(buckets_.size())),
+        slots_(max_size, nullptr) {
+    free_slots_.reserve(max_size);
+    for (size_t slot = max_size; slot > 0; --slot) {
+      free_slots_.push_back(slot - 1);
+    }
+  }
+  virtual ~ConcurrentCache() {
+    for (Node* node : slots_) {
+      delete node;
+    }
+  }
+  ConcurrentCache(const ConcurrentCache&) = delete;
+  ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+  size_t Size() const { return size_.load(memory_order_relaxed); }
+  size_t MaxSize() const { return slots_.size(); }
+
+  // Caches value under key. If key is already cached, its node is
+  // replaced by one with the new value, marked referenced. New entries
+  // start unreferenced.
+  template <typename K>
+  void Put(K&& key, Value value) {
+    if (slots_.empty()) {
+      return;
+    }
+    size_t hash = Hash()(key);
+    lock_guard<mutex> lock(mutex_);
+
+    atomic<Node*>* link = FindLink(key, hash);
+    if (Node* old = link->load(memory_order_relaxed)) {
+      Node* node = new Node(Key(std::forward<K>(key)), std::move(value), hash, old->slot_);
+      node->next_.store(old->next_.load(memory_order_relaxed), memory_order_relaxed);
+      node->referenced_.store(true, memory_order_relaxed);
+      link->store(node, memory_order_release);
+      slots_[node->slot_] = node;
+      epochs_.Retire(old);
+      return;
+    }
+
+    if (free_slots_.empty()) {
+      Unlink(slots_[AdvanceHand()]);
+    }
+    size_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    Node* node = new Node(Key(std::forward<K>(key)), std::move(value), hash, slot);
+    atomic<Node*>& bucket = buckets_[Bucket(hash)];
+    node->next_.store(bucket.load(memory_order_relaxed), memory_order_relaxed);
+    bucket.store(node, memory_order_release);
+    slots_[slot] = node;
+    size_.store(size_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+  }
+
+  // Returns a copy of the value cached under key, or nullopt. Lock-free,
+  // and safe to call concurrently with anything.
+  template <typename K>
+  optional<Value> Get(const K& key) const {
+    size_t hash = Hash()(key);
+    EpochManager::Guard guard(epochs_);
+    for (const Node* node = buckets_[Bucket(hash)].load(memory_order_acquire); node != nullptr;
+         node = node->next_.load(memory_order_acquire)) {
+      if (node->hash_ == hash && Eq()(node->key_, key)) {
+        if (!node->referenced_.load(memory_order_relaxed)) {
+          node->referenced_.store(true, memory_order_relaxed);
+        }
+        return node->value_;
+      }
+    }
+    return nullopt;
+  }
+
+  // Removes key. Returns false if it wasn't cached.
+  template <typename K>
+  bool Erase(const K& key) {
+    size_t hash = Hash()(key);
+    lock_guard<mutex> lock(mutex_);
+    Node* node = FindLink(key, hash)->load(memory_order_relaxed);
+    if (node == nullptr) {
+      return false;
+    }
+    Unlink(node);
+    return true;
+  }
+
+  // Returns the number of unlinked nodes not yet deleted.
+  size_t NumRetiredForTesting() const {
+    lock_guard<mutex> lock(mutex_);
+    return epochs_.NumRetired();
+  }
+
+  template <typename K>
+  bool IsReferencedForTesting(const K& key) const {
+    size_t hash = Hash()(key);
+    lock_guard<mutex> lock(mutex_);
+    const Node* node = const_cast<ConcurrentCache*>(this)->FindLink(key, hash)->load(memory_order_relaxed);
+    return node != nullptr && node->referenced_.load(memory_order_relaxed);
+  }
+
+private:
+  struct Node {
+    Node(Key&& key, Value&& value, size_t hash, size_t slot)
+        : key_(std::move(key)), value_(std::move(value)), hash_(hash), slot_(slot) {}
+
+    const Key key_;
+    const Value value_;
+    const size_t hash_;
+    atomic<Node*> next_ = nullptr;
+    mutable atomic<bool> referenced_ = false;
+    // The node's place in slots_, for CLOCK.
+    size_t slot_;
+  };
+
+  size_t Bucket(size_t hash) const {
+    // Fibonacci hashing: the top bits of the product depend on all of
+    // hash's, so a weak Hash still spreads over the buckets.
+    return (uint64_t(hash) * 0x9E3779B97F4A7C15) >> bucket_shift_;
+  }
+
+  // Returns the link that points at key's node, or the null link at the
+  // end of its bucket's chain if it isn't cached. Writers only.
+  template <typename K>
+  atomic<Node*>* FindLink(const K& key, size_t hash) {
+    atomic<Node*>* link = &buckets_[Bucket(hash)];
+    for (Node* node; (node = link->load(memory_order_relaxed)) != nullptr; link = &node->next_) {
+      if (node->hash_ == hash && Eq()(node->key_, key)) {
+        break;
+      }
+    }
+    return link;
+  }
+
+  // Unlinks node from its chain and from the clock, and retires it.
+  // Readers on it can still follow its next_ to the rest of the chain.
+  void Unlink(Node* node) {
+    atomic<Node*>* link = &buckets_[Bucket(node->hash_)];
+    while (link->load(memory_order_relaxed) != node) {
+      link = &link->load(memory_order_relaxed)->next_;
+    }
+    link->store(node->next_.load(memory_order_relaxed), memory_order_release);
+    slots_[node->slot_] = nullptr;
+    free_slots_.push_back(node->slot_);
+    size_.store(size_.load(memory_order_relaxed) - 1, memory_order_relaxed);
+    epochs_.Retire(node);
+  }
+
+  // Sweeps the hand forward, as ClockCache's does, until it reaches an
+  // unreferenced node. Only called when every slot is taken.
+  size_t AdvanceHand() {
+    while (true) {
+      size_t slot = hand_;
+      hand_ = hand_ + 1 == slots_.size() ? 0 : hand_ + 1;
+      Node* node = slots_[slot];
+      if (!node->referenced_.load(memory_order_relaxed)) {
+        return slot;
+      }
+      node->referenced_.store(false, memory_order_relaxed);
+    }
+  }
+
+  vector<atomic<Node*>> buckets_;
+  int bucket_shift_;
+  atomic<size_t> size_ = 0;
+
+  // Everything below is the writers', under mutex_.
+  mutable mutex mutex_;
+  // Every node, in clock order; nullptr for a free slot.
+  vector<Node*> slots_;
+  vector<size_t> free_slots_;
+  size_t hand_ = 0;
+  mutable EpochManager epochs_;
+};
+
+#endif /* concurrent_cache_hpp */
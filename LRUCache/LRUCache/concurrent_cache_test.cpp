@@ -0,0 +1,125 @@
+//
+//  concurrent_cache_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "concurrent_cache_test.hpp"
+#include "concurrent_cache.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void CONCURRENT_CACHE_TEST_BASIC() {
+  ConcurrentCache<string, int> cache(3);
+  assert(!cache.Get("rose"));
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+  assert(cache.Get("rose") == 10);
+  assert(cache.Get(string_view("mars")) == 20);
+  assert(cache.Size() == 2);
+
+  cache.Put("rose", 11);
+  assert(cache.Get("rose") == 11);
+  assert(cache.Size() == 2);
+
+  assert(cache.Erase("rose"));
+  assert(!cache.Erase("rose"));
+  assert(!cache.Get("rose"));
+  assert(cache.Get("mars") == 20);
+  assert(cache.Size() == 1);
+
+  ConcurrentCache<string, int> empty(0);
+  empty.Put("rose", 10);
+  assert(!empty.Get("rose"));
+}
+
+void CONCURRENT_CACHE_TEST_SECOND_CHANCE() {
+  ConcurrentCache<string, int> cache(3);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+  cache.Put("zara", 30);
+  assert(!cache.IsReferencedForTesting("rose"));
+  assert(cache.Get("rose") == 10);
+  assert(cache.IsReferencedForTesting("rose"));
+
+  // As in ClockCache, "rose" gets a second chance and "mars" is evicted.
+  cache.Put("luna", 40);
+  assert(!cache.Get("mars"));
+  assert(!cache.IsReferencedForTesting("rose"));
+
+  // Replacing a node marks the new one referenced, so "rose" would
+  // survive the next eviction; the hand is at "zara" anyway.
+  cache.Put("rose", 11);
+  assert(cache.IsReferencedForTesting("rose"));
+  cache.Put("vega", 50);
+  assert(!cache.Get("zara"));
+  assert(cache.Get("rose") == 11);
+  assert(cache.Get("luna") == 40);
+  assert(cache.Get("vega") == 50);
+  assert(cache.Size() == 3);
+}
+
+void CONCURRENT_CACHE_TEST_RECLAIM() {
+  // With no readers about, replaced and evicted nodes are deleted a few
+  // reclaim periods after they are unlinked, so they don't pile up.
+  ConcurrentCache<string, int> cache(10);
+  for (int i = 0; i < 10000; ++i) {
+    cache.Put(to_string(i % 20), i);
+  }
+  assert(cache.Size() == 10);
+  assert(cache.NumRetiredForTesting() <= 3 * EpochManager::kReclaimPeriod);
+}
+
+void CONCURRENT_CACHE_TEST_CONCURRENT() {
+  constexpr int kNumReaders = 4;
+  constexpr int kNumKeys = 200;
+  constexpr int kNumOps = 20000;
+  ConcurrentCache<string, string> cache(kNumKeys / 2);
+  vector<string> keys;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.push_back("key" + to_string(i));
+  }
+
+  // Readers race with a writer that keeps replacing, evicting and erasing
+  // the nodes they read. A value is always its key's.
+  atomic<bool> done = false;
+  vector<thread> readers;
+  for (int t = 0; t < kNumReaders; ++t) {
+    readers.emplace_back([&cache, &keys, &done, t]() {
+      unsigned int seed = t;
+      while (!done) {
+        const string& key = keys[rand_r(&seed) % keys.size()];
+        optional<string> value = cache.Get(key);
+        assert(!value || value == key + "!");
+      }
+    });
+  }
+  unsigned int seed = kNumReaders;
+  for (int i = 0; i < kNumOps; ++i) {
+    const string& key = keys[rand_r(&seed) % keys.size()];
+    if (i % 10 == 0) {
+      cache.Erase(key);
+    } else {
+      cache.Put(key, key + "!");
+    }
+  }
+  done = true;
+  for (thread& reader : readers) {
+    reader.join();
+  }
+  assert(cache.Size() <= cache.MaxSize());
+}
+
+void RUN_CONCURRENT_CACHE_TESTS() {
+  CONCURRENT_CACHE_TEST_BASIC();
+  CONCURRENT_CACHE_TEST_SECOND_CHANCE();
+  CONCURRENT_CACHE_TEST_RECLAIM();
+  CONCURRENT_CACHE_TEST_CONCURRENT();
+}
@@ -0,0 +1,13 @@
+//
+//  concurrent_cache_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef concurrent_cache_test_hpp
+#define concurrent_cache_test_hpp
+
+extern void RUN_CONCURRENT_CACHE_TESTS();
+
+#endif /* concurrent_cache_test_hpp */
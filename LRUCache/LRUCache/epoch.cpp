@@ -0,0 +1,115 @@
+//
+//  epoch.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "epoch.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+
+// Which thread slots are taken, process-wide.
+mutex g_slots_mutex;
+array<bool, EpochManager::kMaxThreads> g_slots_taken = {};
+
+// Takes a slot for the thread on construction, gives it back at exit.
+struct ThreadSlotOwner {
+  ThreadSlotOwner() {
+    lock_guard<mutex> lock(g_slots_mutex);
+    auto it = find(g_slots_taken.begin(), g_slots_taken.end(), false);
+    if (it == g_slots_taken.end()) {
+      // Every per-thread array is sized for kMaxThreads, so there is no
+      // going on, in a release build either.
+      fprintf(stderr, "More than %zu threads using EpochManagers at once\n", EpochManager::kMaxThreads);
+      abort();
+    }
+    *it = true;
+    slot_ = it - g_slots_taken.begin();
+  }
+  ~ThreadSlotOwner() {
+    lock_guard<mutex> lock(g_slots_mutex);
+    g_slots_taken[slot_] = false;
+  }
+
+  size_t slot_;
+};
+
+} // namespace
+
+EpochManager::Guard::Guard(EpochManager& epochs) : epochs_(epochs), thread_(ThreadSlot()) {
+  Slot& slot = epochs_.slots_[thread_];
+  if (slot.depth_++ == 0) {
+    slot.epoch_.store(epochs_.epoch_.load(memory_order_relaxed), memory_order_relaxed);
+    // Publish the epoch before reading anything it protects, pairing with
+    // the fence in Reclaim().
+    atomic_thread_fence(memory_order_seq_cst);
+  }
+}
+
+EpochManager::Guard::~Guard() {
+  Slot& slot = epochs_.slots_[thread_];
+  if (--slot.depth_ == 0) {
+    slot.epoch_.store(kQuiescent, memory_order_release);
+  }
+}
+
+EpochManager::EpochManager() {
+}
+
+EpochManager::~EpochManager() {
+  for (const Retired& retired : retired_) {
+    retired.deleter_(retired.object_);
+  }
+}
+
+void EpochManager::Retire(void* object, void (*deleter)(void*)) {
+  retired_.push_back({ object, deleter, epoch_.load(memory_order_relaxed) });
+  if (++retires_since_reclaim_ >= kReclaimPeriod) {
+    Reclaim();
+  }
+}
+
+size_t EpochManager::Reclaim() {
+  retires_since_reclaim_ = 0;
+
+  // Order the unlinking of everything retired before reading the slots,
+  // pairing with the fence in Guard().
+  atomic_thread_fence(memory_order_seq_cst);
+  uint64_t epoch = epoch_.load(memory_order_relaxed);
+  bool caught_up = true;
+  for (const Slot& slot : slots_) {
+    uint64_t thread_epoch = slot.epoch_.load(memory_order_acquire);
+    if (thread_epoch != kQuiescent && thread_epoch != epoch) {
+      caught_up = false;
+      break;
+    }
+  }
+  if (caught_up) {
+    epoch_.store(++epoch, memory_order_release);
+  }
+
+  // An object retired in epoch e may still be seen by a reader that
+  // entered in e - 1, which holds the epoch back at e; by e + 2, every
+  // such reader has left.
+  size_t num_deleted = 0;
+  auto safe = partition(retired_.begin(), retired_.end(), [epoch](const Retired& retired) {
+    return retired.epoch_ + 2 > epoch;
+  });
+  for (auto it = safe; it != retired_.end(); ++it) {
+    it->deleter_(it->object_);
+    ++num_deleted;
+  }
+  retired_.erase(safe, retired_.end());
+  return num_deleted;
+}
+
+size_t EpochManager::ThreadSlot() {
+  thread_local ThreadSlotOwner owner;
+  return owner.slot_;
+}
@@ -0,0 +1,108 @@
+//
+//  epoch.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef epoch_hpp
+#define epoch_hpp
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Epoch-based memory reclamation, so lock-free readers can follow
+// pointers to objects that a writer may unlink at any time (see
+// ConcurrentCache). Readers do their reads inside a Guard, which
+// publishes the global epoch the thread saw on entry. A writer that
+// unlinks an object Retire()s it rather than deleting it; it is deleted
+// once the global epoch has advanced twice, which it only does once every
+// thread inside a Guard has seen the current epoch, so no reader that
+// could have reached the object is still inside its Guard.
+//
+// Entering and leaving a Guard is a store each and a fence, with no
+// shared writes, so readers on different cores don't contend. Retire()
+// and Reclaim() are not thread-safe: writers must serialize them (a
+// ConcurrentCache calls them under its writer lock).
+//
+// Each thread takes a slot, the same in every EpochManager, the first
+// time it enters a Guard, and gives it back when it exits. At most
+// kMaxThreads threads can use EpochManagers at once; one more aborts the
+// process.
+class EpochManager {
+public:
+  static constexpr size_t kMaxThreads = 256;
+  // Retire() tries to reclaim every this many retirements.
+  static constexpr size_t kReclaimPeriod = 64;
+
+  // Marks the calling thread as reading, for as long as it lives. Guards
+  // may nest.
+  class Guard {
+  public:
+    Guard(EpochManager& epochs);
+    virtual ~Guard();
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+  private:
+    EpochManager& epochs_;
+    size_t thread_;
+  };
+
+  EpochManager();
+  // Deletes everything still retired: there must be no readers left.
+  virtual ~EpochManager();
+  EpochManager(const EpochManager&) = delete;
+  EpochManager& operator=(const EpochManager&) = delete;
+
+  // Hands an unlinked object to be deleted, by deleter, once no reader
+  // can still be using it.
+  void Retire(void* object, void (*deleter)(void*));
+
+  template <typename T>
+  void Retire(T* object) {
+    Retire(object, [](void* p) { delete static_cast<T*>(p); });
+  }
+
+  // Advances the epoch if every reader has caught up with it, and deletes
+  // what is safe to. Returns the number of objects deleted.
+  size_t Reclaim();
+
+  uint64_t Epoch() const { return epoch_.load(memory_order_relaxed); }
+
+  // Returns the number of objects retired but not yet deleted.
+  size_t NumRetired() const { return retired_.size(); }
+
+  // Returns the calling thread's slot, below kMaxThreads and unique among
+  // live threads, taking one if it has none. Also keys other per-thread
+  // state (see FrontCache).
+  static size_t ThreadSlot();
+
+private:
+  // The epoch of a thread that isn't reading.
+  static constexpr uint64_t kQuiescent = UINT64_MAX;
+
+  // A thread's published epoch, on its own cache line.
+  struct alignas(64) Slot {
+    atomic<uint64_t> epoch_ = kQuiescent;
+    // Guards the thread has entered, only touched by the thread.
+    int depth_ = 0;
+  };
+
+  struct Retired {
+    void* object_;
+    void (*deleter_)(void*);
+    uint64_t epoch_;
+  };
+
+  atomic<uint64_t> epoch_ = 0;
+  array<Slot, kMaxThreads> slots_;
+  vector<Retired> retired_;
+  size_t retires_since_reclaim_ = 0;
+};
+
+#endif /* epoch_hpp */
@@ -0,0 +1,125 @@
+//
+//  epoch_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "epoch_test.hpp"
+#include "epoch.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+int g_num_deleted = 0;
+
+void CountDeleted(void*) {
+  ++g_num_deleted;
+}
+
+} // namespace
+
+void EPOCH_TEST_RECLAIM() {
+  g_num_deleted = 0;
+  EpochManager epochs;
+  int objects[3];
+  for (int& object : objects) {
+    epochs.Retire(&object, CountDeleted);
+  }
+  assert(epochs.NumRetired() == 3);
+
+  // With no readers, every Reclaim() advances the epoch, and what was
+  // retired is deleted two epochs on.
+  assert(epochs.Reclaim() == 0);
+  assert(epochs.Epoch() == 1);
+  assert(epochs.Reclaim() == 3);
+  assert(epochs.Epoch() == 2);
+  assert(g_num_deleted == 3);
+  assert(epochs.NumRetired() == 0);
+}
+
+void EPOCH_TEST_GUARD_BLOCKS_RECLAIM() {
+  g_num_deleted = 0;
+  EpochManager epochs;
+  atomic<bool> entered = false;
+  atomic<bool> release = false;
+  thread reader([&]() {
+    EpochManager::Guard guard(epochs);
+    entered = true;
+    while (!release) {
+      this_thread::yield();
+    }
+  });
+  while (!entered) {
+    this_thread::yield();
+  }
+
+  // The reader entered in epoch 0, so the epoch can advance once, but not
+  // again until it leaves.
+  int object;
+  epochs.Retire(&object, CountDeleted);
+  for (int i = 0; i < 10; ++i) {
+    assert(epochs.Reclaim() == 0);
+  }
+  assert(epochs.Epoch() == 1);
+  assert(g_num_deleted == 0);
+
+  release = true;
+  reader.join();
+  assert(epochs.Reclaim() == 1);
+  assert(g_num_deleted == 1);
+}
+
+void EPOCH_TEST_NESTED_GUARDS() {
+  g_num_deleted = 0;
+  EpochManager epochs;
+  atomic<int> step = 0;
+  thread reader([&]() {
+    EpochManager::Guard outer(epochs);
+    {
+      EpochManager::Guard inner(epochs);
+    }
+    // Leaving the inner Guard doesn't leave the outer one.
+    step = 1;
+    while (step != 2) {
+      this_thread::yield();
+    }
+  });
+  while (step != 1) {
+    this_thread::yield();
+  }
+
+  int object;
+  epochs.Retire(&object, CountDeleted);
+  for (int i = 0; i < 10; ++i) {
+    epochs.Reclaim();
+  }
+  assert(g_num_deleted == 0);
+
+  step = 2;
+  reader.join();
+  assert(epochs.Reclaim() == 1);
+}
+
+void EPOCH_TEST_DESTRUCTOR() {
+  g_num_deleted = 0;
+  {
+    EpochManager epochs;
+    int object;
+    epochs.Retire(&object, CountDeleted);
+    epochs.Retire(new int(1));
+  }
+  assert(g_num_deleted == 1);
+}
+
+void RUN_EPOCH_TESTS() {
+  EPOCH_TEST_RECLAIM();
+  EPOCH_TEST_GUARD_BLOCKS_RECLAIM();
+  EPOCH_TEST_NESTED_GUARDS();
+  EPOCH_TEST_DESTRUCTOR();
+}
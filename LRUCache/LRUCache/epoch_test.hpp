@@ -0,0 +1,13 @@
+//
+//  epoch_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef epoch_test_hpp
+#define epoch_test_hpp
+
+extern void RUN_EPOCH_TESTS();
+
+#endif /* epoch_test_hpp */
@@ -0,0 +1,600 @@
+//
+//  eviction_policy.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef eviction_policy_hpp
+#define eviction_policy_hpp
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "frequency_sketch.hpp"
+#include "slab_list.hpp"
+
+using namespace std;
+
+// Eviction policies for LRUCache, which decide which entry makes room for
+// a new one. A policy owns the cache's node storage, a SlabList whose
+// slots the cache's hash map indexes, and keeps the entries in order on
+// as many of its lists as it needs. The cache calls:
+//
+//   Insert(contents)     to link a new entry, returning its index (the
+//                        slab must have a free slot).
+//   Restore(contents, list)
+//                        like Insert(), but onto the head of list, for an
+//                        entry loaded from a snapshot that was saved from
+//                        it (EvictionPolicyBase provides it).
+//   Touch(index)         on a hit.
+//   RecordAccess(key)    on every lookup, hit or miss, and every put.
+//   ChooseVictim(key)    for the entry to evict to make room for key.
+//   ChooseVictim()       for an entry to evict to shrink the cache, after
+//                        Resize(); not to make room for any key in
+//                        particular.
+//   Resize(capacity)     when the cache's capacity changes, to resize the
+//                        policy's lists. The slab is grown separately, and
+//                        the cache evicts down to a smaller capacity.
+//   Remove(index, evicted)
+//                        to unlink an entry and free its slot, evicted
+//                        being false if it was erased or expired instead.
+//   AddMemoryUsage(usage)
+//                        for GetMemoryUsage(): EvictionPolicyBase adds the
+//                        slab, and policies add their own state.
+//
+// Policies other than LRUPolicy size their lists by number of entries,
+// so they are only for caches of a number of entries.
+
+// The storage and list bookkeeping shared by the policies: kNumLists
+// lists over one slab, remembering which list each node is on.
+template <typename Key, typename Value, size_t kNumLists>
+class EvictionPolicyBase {
+public:
+  using Contents = tuple<Key, Value>;
+  using List = SlabList<Contents, kNumLists>;
+  using Index = typename List::Index;
+  using Node = typename List::Node;
+
+  EvictionPolicyBase(size_t capacity) : list_(capacity), lists_(kNumLists > 1 ? capacity : 0) {}
+  virtual ~EvictionPolicyBase() {}
+
+  size_t Size() const { return list_.Size(); }
+  size_t Capacity() const { return list_.Capacity(); }
+  bool IsFull() const { return list_.IsFull(); }
+
+  // Adds free slots until there are capacity in all, see SlabList::Grow().
+  void Grow(size_t capacity) {
+    list_.Grow(capacity);
+    if constexpr (kNumLists > 1) {
+      lists_.resize(list_.Capacity());
+    }
+  }
+
+  Node& At(Index index) { return list_.At(index); }
+  const Node& At(Index index) const { return list_.At(index); }
+
+  static constexpr size_t NumLists() { return kNumLists; }
+
+  // Returns the head of list, to walk it through Node::next_ (to snapshot
+  // it, or in tests).
+  Index GetHead(size_t list = 0) const { return list_.GetHead(list); }
+
+  // Links an entry loaded from a snapshot at the head of list, the one it
+  // was saved from. A list over its share of a smaller cache drains as
+  // after a Resize().
+  Index Restore(Contents contents, size_t list) { return Push(std::move(contents), list); }
+
+  // Adds the slab to usage's nodes, and the list each slot is on.
+  void AddMemoryUsage(MemoryUsage& usage) const {
+    list_.AddMemoryUsage(usage, usage.node_bytes_);
+    usage.AddBlock(usage.node_bytes_, lists_.capacity());
+  }
+
+protected:
+  size_t ListOf(Index index) const {
+    if constexpr (kNumLists > 1) {
+      return lists_[index];
+    }
+    return 0;
+  }
+
+  // Links a new entry at the head of list.
+  Index Push(Contents&& contents, size_t list) {
+    Index index = list_.PushHead(std::move(contents), list);
+    assert(index != List::kNullIndex);
+    if constexpr (kNumLists > 1) {
+      lists_[index] = static_cast<uint8_t>(list);
+    }
+    return index;
+  }
+
+  // Moves the node at index to the head of its list.
+  void Promote(Index index) { list_.PromoteNodeHead(index, ListOf(index)); }
+
+  // Moves the node at index to the head of list to.
+  void Move(Index index, size_t to) {
+    list_.MoveNodeHead(index, ListOf(index), to);
+    if constexpr (kNumLists > 1) {
+      lists_[index] = static_cast<uint8_t>(to);
+    }
+  }
+
+  void Free(Index index) { list_.Remove(index, ListOf(index)); }
+
+  size_t ListSize(size_t list) const { return list_.ListSize(list); }
+  Index GetTail(size_t list) const { return list_.GetTail(list); }
+  const Key& KeyAt(Index index) const { return get<0>(list_.At(index).contents_); }
+
+  List list_;
+  // The list each slot's node is on, when there are several.
+  vector<uint8_t> lists_;
+};
+
+// Remembers the hashes of recently evicted keys (ARC's and 2Q's "ghost"
+// entries), dropping the oldest beyond max_size.
+class GhostList {
+public:
+  GhostList(size_t max_size) : max_size_(max<size_t>(max_size, 1)), list_(max_size_) {
+    index_.reserve(max_size_);
+  }
+  virtual ~GhostList() {}
+
+  size_t Size() const { return list_.Size(); }
+  bool Contains(uint64_t hash) const { return index_.count(hash) != 0; }
+
+  // Changes the most entries remembered. Shrinking drops nothing now:
+  // each Add() drops one extra oldest entry until the list fits.
+  void Resize(size_t max_size) {
+    max_size_ = max<size_t>(max_size, 1);
+    if (max_size_ > list_.Capacity()) {
+      list_.Grow(max_size_);
+      index_.reserve(max_size_);
+    }
+  }
+
+  // Adds hash as the newest entry.
+  void Add(uint64_t hash) {
+    Remove(hash);
+    HashMap::node_type map_node;
+    if (list_.Size() >= max_size_) {
+      map_node = index_.extract(*list_.PopTail());
+      if (list_.Size() >= max_size_) {
+        RemoveOldest();
+      }
+    }
+    Index index = list_.PushHead(hash);
+    if (!map_node.empty()) {
+      map_node.key() = hash;
+      map_node.mapped() = index;
+      index_.insert(std::move(map_node));
+    } else {
+      index_.emplace(hash, index);
+    }
+  }
+
+  // Removes hash, returning false if it wasn't there.
+  bool Remove(uint64_t hash) {
+    HashMap::iterator it = index_.find(hash);
+    if (it == index_.end()) {
+      return false;
+    }
+    list_.Remove(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  void RemoveOldest() {
+    if (!list_.IsEmpty()) {
+      index_.erase(*list_.PopTail());
+    }
+  }
+
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+    list_.AddMemoryUsage(usage, component);
+    AddHashMap(usage, component, index_);
+  }
+
+private:
+  using List = SlabList<uint64_t>;
+  using Index = List::Index;
+  using HashMap = unordered_map<uint64_t, Index>;
+
+  size_t max_size_;
+  List list_;
+  HashMap index_;
+};
+
+// Least-recently-used: one list, hits move to its head, the tail goes.
+template <typename Key, typename Value, typename Hash>
+class LRUPolicy : public EvictionPolicyBase<Key, Value, 1> {
+public:
+  using Base = EvictionPolicyBase<Key, Value, 1>;
+  using typename Base::Contents;
+  using typename Base::Index;
+
+  static constexpr bool kSupportsWeights = true;
+
+  LRUPolicy(size_t capacity) : Base(capacity) {}
+
+  Index Insert(Contents contents) { return this->Push(std::move(contents), 0); }
+  void Touch(Index index) { this->Promote(index); }
+
+  template <typename K>
+  void RecordAccess(const K& key) {}
+
+  template <typename K>
+  Index ChooseVictim(const K& key) {
+    return ChooseVictim();
+  }
+  Index ChooseVictim() { return this->GetTail(0); }
+
+  void Resize(size_t capacity) {}
+
+  void Remove(Index index, bool evicted) { this->Free(index); }
+};
+
+// Segmented LRU: new entries go on probation, and move to the protected
+// segment (80% of the cache) when hit again, so entries hit once don't
+// push out those hit repeatedly. Protected's LRU entry is demoted back to
+// probation when it overflows, and probation's LRU entry is evicted.
+template <typename Key, typename Value, typename Hash>
+class SLRUPolicy : public EvictionPolicyBase<Key, Value, 2> {
+public:
+  using Base = EvictionPolicyBase<Key, Value, 2>;
+  using typename Base::Contents;
+  using typename Base::Index;
+
+  static constexpr bool kSupportsWeights = false;
+
+  SLRUPolicy(size_t capacity) : Base(capacity), max_protected_size_(capacity * 8 / 10) {}
+
+  Index Insert(Contents contents) { return this->Push(std::move(contents), kProbation); }
+
+  void Touch(Index index) {
+    if (this->ListOf(index) == kProtected) {
+      this->Promote(index);
+      return;
+    }
+
+    this->Move(index, kProtected);
+    if (this->ListSize(kProtected) > max_protected_size_) {
+      this->Move(this->GetTail(kProtected), kProbation);
+    }
+  }
+
+  template <typename K>
+  void RecordAccess(const K& key) {}
+
+  template <typename K>
+  Index ChooseVictim(const K& key) {
+    return ChooseVictim();
+  }
+  Index ChooseVictim() {
+    return this->ListSize(kProbation) > 0 ? this->GetTail(kProbation) : this->GetTail(kProtected);
+  }
+
+  // An overfull protected segment is left to drain through evictions and
+  // demotions.
+  void Resize(size_t capacity) { max_protected_size_ = capacity * 8 / 10; }
+
+  void Remove(Index index, bool evicted) { this->Free(index); }
+
+private:
+  enum : size_t { kProbation, kProtected };
+
+  size_t max_protected_size_;
+};
+
+// 2Q (Johnson and Shasha, the full version): new entries go in a FIFO
+// (25% of the cache), hits there don't count. Entries pushed out of the
+// FIFO are remembered, by key hash, for as long again as half the cache;
+// if one comes back in that time it goes in the main LRU list instead.
+template <typename Key, typename Value, typename Hash>
+class TwoQPolicy : public EvictionPolicyBase<Key, Value, 2> {
+public:
+  using Base = EvictionPolicyBase<Key, Value, 2>;
+  using typename Base::Contents;
+  using typename Base::Index;
+
+  static constexpr bool kSupportsWeights = false;
+
+  TwoQPolicy(size_t capacity)
+      : Base(capacity), max_in_size_(max<size_t>(1, capacity / 4)), ghosts_(capacity / 2) {}
+
+  Index Insert(Contents contents) {
+    bool is_ghost = ghosts_.Remove(Hash()(get<0>(contents)));
+    return this->Push(std::move(contents), is_ghost ? kMain : kIn);
+  }
+
+  void Touch(Index index) {
+    if (this->ListOf(index) == kMain) {
+      this->Promote(index);
+    }
+  }
+
+  template <typename K>
+  void RecordAccess(const K& key) {}
+
+  template <typename K>
+  Index ChooseVictim(const K& key) {
+    return ChooseVictim();
+  }
+  Index ChooseVictim() {
+    if (this->ListSize(kIn) > max_in_size_ || this->ListSize(kMain) == 0) {
+      return this->GetTail(kIn);
+    }
+    return this->GetTail(kMain);
+  }
+
+  void Resize(size_t capacity) {
+    max_in_size_ = max<size_t>(1, capacity / 4);
+    ghosts_.Resize(capacity / 2);
+  }
+
+  void AddMemoryUsage(MemoryUsage& usage) const {
+    Base::AddMemoryUsage(usage);
+    ghosts_.AddMemoryUsage(usage, usage.metadata_bytes_);
+  }
+
+  void Remove(Index index, bool evicted) {
+    if (evicted && this->ListOf(index) == kIn) {
+      ghosts_.Add(Hash()(this->KeyAt(index)));
+    }
+    this->Free(index);
+  }
+
+private:
+  // The FIFO (A1in) and the main LRU list (Am).
+  enum : size_t { kIn, kMain };
+
+  size_t max_in_size_;
+  // Keys recently pushed out of the FIFO (A1out).
+  GhostList ghosts_;
+};
+
+// Adaptive Replacement Cache (Megiddo and Modha): entries seen once are on
+// the recent list (T1), entries seen again on the frequent list (T2), and
+// the keys of entries evicted from each are remembered (B1 and B2). The
+// target size of the recent list adapts: a miss on a key in B1 means it
+// was too small, one in B2 that it was too big.
+template <typename Key, typename Value, typename Hash>
+class ARCPolicy : public EvictionPolicyBase<Key, Value, 2> {
+public:
+  using Base = EvictionPolicyBase<Key, Value, 2>;
+  using typename Base::Contents;
+  using typename Base::Index;
+
+  static constexpr bool kSupportsWeights = false;
+
+  ARCPolicy(size_t capacity)
+      : Base(capacity), capacity_(capacity), recent_ghosts_(capacity), frequent_ghosts_(2 * capacity) {}
+
+  Index Insert(Contents contents) {
+    uint64_t hash = Hash()(get<0>(contents));
+    Adapt(hash);
+    adapted_ = false;
+    if (recent_ghosts_.Remove(hash) || frequent_ghosts_.Remove(hash)) {
+      return this->Push(std::move(contents), kFrequent);
+    }
+
+    // A new key: keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c.
+    size_t num_recent = this->ListSize(kRecent);
+    if (num_recent + recent_ghosts_.Size() >= capacity_) {
+      recent_ghosts_.RemoveOldest();
+    } else if (this->Size() + recent_ghosts_.Size() + frequent_ghosts_.Size() >= 2 * capacity_) {
+      frequent_ghosts_.RemoveOldest();
+    }
+    return this->Push(std::move(contents), kRecent);
+  }
+
+  void Touch(Index index) {
+    if (this->ListOf(index) == kFrequent) {
+      this->Promote(index);
+    } else {
+      this->Move(index, kFrequent);
+    }
+  }
+
+  template <typename K>
+  void RecordAccess(const K& key) {}
+
+  // ARC's REPLACE: evicts from the recent list while it is over its
+  // target size, from the frequent list otherwise.
+  template <typename K>
+  Index ChooseVictim(const K& key) {
+    uint64_t hash = Hash()(key);
+    Adapt(hash);
+    bool is_frequent_ghost = frequent_ghosts_.Contains(hash);
+    size_t num_recent = this->ListSize(kRecent);
+
+    // The cache is all recent entries, and the new key isn't remembered:
+    // evict the oldest without remembering it either.
+    if (num_recent >= capacity_ && !is_frequent_ghost && !recent_ghosts_.Contains(hash)) {
+      forget_victim_ = true;
+      return this->GetTail(kRecent);
+    }
+
+    if (num_recent > 0 &&
+        (num_recent > target_recent_size_ || (is_frequent_ghost && num_recent == target_recent_size_) ||
+         this->ListSize(kFrequent) == 0)) {
+      return this->GetTail(kRecent);
+    }
+    return this->GetTail(kFrequent);
+  }
+
+  // REPLACE without a new key, so without adapting.
+  Index ChooseVictim() {
+    size_t num_recent = this->ListSize(kRecent);
+    if (num_recent > 0 && (num_recent > target_recent_size_ || this->ListSize(kFrequent) == 0)) {
+      return this->GetTail(kRecent);
+    }
+    return this->GetTail(kFrequent);
+  }
+
+  // The ghost lists shrink as keys are added to them, see GhostList.
+  void Resize(size_t capacity) {
+    capacity_ = capacity;
+    target_recent_size_ = min(target_recent_size_, capacity);
+    recent_ghosts_.Resize(capacity);
+    frequent_ghosts_.Resize(2 * capacity);
+  }
+
+  void AddMemoryUsage(MemoryUsage& usage) const {
+    Base::AddMemoryUsage(usage);
+    recent_ghosts_.AddMemoryUsage(usage, usage.metadata_bytes_);
+    frequent_ghosts_.AddMemoryUsage(usage, usage.metadata_bytes_);
+  }
+
+  void Remove(Index index, bool evicted) {
+    if (evicted && !forget_victim_) {
+      GhostList& ghosts = this->ListOf(index) == kRecent ? recent_ghosts_ : frequent_ghosts_;
+      ghosts.Add(Hash()(this->KeyAt(index)));
+    }
+    forget_victim_ = false;
+    this->Free(index);
+  }
+
+private:
+  enum : size_t { kRecent, kFrequent };
+
+  // Adjusts the recent list's target size on a miss on the key with hash,
+  // once per insert (ChooseVictim() and Insert() both call it).
+  void Adapt(uint64_t hash) {
+    if (adapted_) {
+      return;
+    }
+    adapted_ = true;
+
+    size_t num_recent_ghosts = recent_ghosts_.Size();
+    size_t num_frequent_ghosts = frequent_ghosts_.Size();
+    if (recent_ghosts_.Contains(hash)) {
+      size_t delta = max<size_t>(1, num_frequent_ghosts / num_recent_ghosts);
+      target_recent_size_ = min(capacity_, target_recent_size_ + delta);
+    } else if (frequent_ghosts_.Contains(hash)) {
+      size_t delta = max<size_t>(1, num_recent_ghosts / num_frequent_ghosts);
+      target_recent_size_ -= min(target_recent_size_, delta);
+    }
+  }
+
+  size_t capacity_;
+  // ARC's p.
+  size_t target_recent_size_ = 0;
+  GhostList recent_ghosts_;
+  GhostList frequent_ghosts_;
+  // Whether the current insert has adapted target_recent_size_ yet.
+  bool adapted_ = false;
+  // Whether the entry being evicted is to be forgotten, not remembered.
+  bool forget_victim_ = false;
+};
+
+// W-TinyLFU (Einziger, Friedman and Manes): accesses are counted in a
+// FrequencySketch, 1% of the cache is an LRU window that new entries
+// enter, and the rest is a segmented LRU (see SLRUPolicy). An entry pushed
+// out of the window (the candidate) is only admitted to the main segments
+// if the sketch has seen it more often than their LRU entry (the victim),
+// which it then evicts; otherwise it is evicted itself. So a scan of cold
+// keys only passes through the window. Costs about 9 bytes per entry.
+template <typename Key, typename Value, typename Hash>
+class WTinyLFUPolicy : public EvictionPolicyBase<Key, Value, 3> {
+public:
+  using Base = EvictionPolicyBase<Key, Value, 3>;
+  using typename Base::Contents;
+  using typename Base::Index;
+
+  static constexpr bool kSupportsWeights = false;
+
+  WTinyLFUPolicy(size_t capacity)
+      : Base(capacity),
+        sketch_(capacity),
+        max_window_size_(max<size_t>(1, capacity / 100)),
+        max_protected_size_((capacity - min(capacity, max_window_size_)) * 8 / 10) {}
+
+  // New entries enter the window. An overfull window sends its LRU entry
+  // on probation; there is room for it, since either the cache or the
+  // window wasn't full.
+  Index Insert(Contents contents) {
+    Index index = this->Push(std::move(contents), kWindow);
+    if (this->ListSize(kWindow) > max_window_size_) {
+      this->Move(this->GetTail(kWindow), kProbation);
+    }
+    return index;
+  }
+
+  void Touch(Index index) {
+    size_t list = this->ListOf(index);
+    if (list != kProbation) {
+      this->Promote(index);
+      return;
+    }
+
+    this->Move(index, kProtected);
+    if (this->ListSize(kProtected) > max_protected_size_) {
+      this->Move(this->GetTail(kProtected), kProbation);
+    }
+  }
+
+  template <typename K>
+  void RecordAccess(const K& key) {
+    sketch_.Increment(Hash()(key));
+  }
+
+  // When the window is full its LRU entry is due to move to the main
+  // segments, so it duels with their LRU entry. Ties go to the victim,
+  // which keeps keys seen once out.
+  template <typename K>
+  Index ChooseVictim(const K& key) {
+    Index candidate = this->ListSize(kWindow) >= max_window_size_ ? this->GetTail(kWindow)
+                                                                  : Base::List::kNullIndex;
+    Index victim = this->ListSize(kProbation) > 0 ? this->GetTail(kProbation) : this->GetTail(kProtected);
+    if (candidate == Base::List::kNullIndex || victim == Base::List::kNullIndex) {
+      return candidate == Base::List::kNullIndex ? victim : candidate;
+    }
+
+    if (EstimateFrequency(candidate) > EstimateFrequency(victim)) {
+      this->Move(candidate, kProbation);
+      return victim;
+    }
+    return candidate;
+  }
+
+  // Evicts the main segments' LRU entry, without a duel, leaving the
+  // window to drain as entries are inserted; the window's once they are
+  // empty.
+  Index ChooseVictim() {
+    if (this->ListSize(kProbation) > 0) {
+      return this->GetTail(kProbation);
+    }
+    return this->ListSize(kProtected) > 0 ? this->GetTail(kProtected) : this->GetTail(kWindow);
+  }
+
+  // The sketch keeps its size: too big after a shrink costs a little
+  // memory, too small after a grow only some accuracy, and a new one
+  // would forget every count.
+  void Resize(size_t capacity) {
+    max_window_size_ = max<size_t>(1, capacity / 100);
+    max_protected_size_ = (capacity - min(capacity, max_window_size_)) * 8 / 10;
+  }
+
+  void AddMemoryUsage(MemoryUsage& usage) const {
+    Base::AddMemoryUsage(usage);
+    sketch_.AddMemoryUsage(usage, usage.metadata_bytes_);
+  }
+
+  void Remove(Index index, bool evicted) { this->Free(index); }
+
+private:
+  enum : size_t { kWindow, kProbation, kProtected };
+
+  int EstimateFrequency(Index index) const { return sketch_.Estimate(Hash()(this->KeyAt(index))); }
+
+  FrequencySketch sketch_;
+  size_t max_window_size_;
+  size_t max_protected_size_;
+};
+
+#endif /* eviction_policy_hpp */
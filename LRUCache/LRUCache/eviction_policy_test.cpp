@@ -0,0 +1,259 @@
+//
+//  eviction_policy_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "eviction_policy_test.hpp"
+#include "eviction_policy.hpp"
+#include "lru_cache.hpp"
+
+#include <cassert>
+#include <random>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+template <template <typename, typename, typename> class Policy>
+using PolicyCache = LRUCache<int, int, LRUCacheHash<int>, equal_to<>, Policy>;
+
+// Runs a random mix of Put(), Get() and Erase() on a cache with Policy,
+// checking that it never holds more than its capacity and that every hit
+// is the value last put.
+template <template <typename, typename, typename> class Policy>
+void CheckPolicyConsistent(size_t max_size) {
+  PolicyCache<Policy> cache(max_size);
+  unordered_map<int, int> latest;
+  minstd_rand rng(1);
+  for (int i = 0; i < 100000; ++i) {
+    // Skewed towards low keys, so there are hits and repeated misses.
+    int key = int(rng() % 64) * int(rng() % 64) / 16;
+    switch (rng() % 8) {
+      case 0:
+        cache.Erase(key);
+        break;
+      case 1:
+      case 2:
+        cache.Put(key, i);
+        latest[key] = i;
+        break;
+      default:
+        if (int* value = cache.Get(key)) {
+          assert(*value == latest[key]);
+        } else {
+          cache.Put(key, i);
+          latest[key] = i;
+        }
+        break;
+    }
+    assert(cache.Size() <= max_size);
+  }
+}
+
+// Runs a random mix of Put() and Get() on a cache with Policy, resizing it
+// now and then, checking that its size never grows while it is over
+// capacity, and that it gets back within capacity.
+template <template <typename, typename, typename> class Policy>
+void CheckPolicyResizes() {
+  PolicyCache<Policy> cache(50);
+  minstd_rand rng(1);
+  for (int i = 0; i < 100000; ++i) {
+    if (i % 5000 == 0) {
+      cache.Resize(1 + rng() % 200);
+    }
+    size_t size = cache.Size();
+    int key = int(rng() % 300);
+    if (!cache.Get(key)) {
+      cache.Put(key, i);
+    }
+    if (size > cache.MaxSize()) {
+      assert(cache.Size() <= size);
+    } else {
+      assert(cache.Size() <= cache.MaxSize());
+    }
+  }
+  assert(cache.Size() <= cache.MaxSize());
+}
+
+} // namespace
+
+void EVICTION_POLICY_TEST_CONSISTENT() {
+  for (size_t max_size : { 1, 2, 10, 100 }) {
+    CheckPolicyConsistent<LRUPolicy>(max_size);
+    CheckPolicyConsistent<SLRUPolicy>(max_size);
+    CheckPolicyConsistent<TwoQPolicy>(max_size);
+    CheckPolicyConsistent<ARCPolicy>(max_size);
+    CheckPolicyConsistent<WTinyLFUPolicy>(max_size);
+  }
+}
+
+void EVICTION_POLICY_TEST_SLRU() {
+  PolicyCache<SLRUPolicy> cache(10);
+  for (int i = 0; i < 10; ++i) {
+    cache.Put(i, i);
+  }
+
+  // Hit keys are protected, a scan only evicts those on probation.
+  for (int i = 0; i < 5; ++i) {
+    cache.Get(i);
+  }
+  for (int i = 100; i < 200; ++i) {
+    cache.Put(i, i);
+  }
+  for (int i = 0; i < 5; ++i) {
+    assert(*cache.Get(i) == i);
+  }
+  assert(cache.Get(5) == nullptr);
+  assert(*cache.Get(199) == 199);
+
+  // Protected holds 8, the least recently hit beyond that go back on
+  // probation, and are evicted first.
+  for (int i = 200; i < 205; ++i) {
+    cache.Put(i, i);
+    cache.Get(i);
+  }
+  cache.Put(300, 300);
+  cache.Put(301, 301);
+  assert(cache.Get(0) == nullptr);
+  assert(*cache.Get(204) == 204);
+}
+
+void EVICTION_POLICY_TEST_TWO_Q() {
+  // A 2-entry FIFO, and 4 ghosts.
+  PolicyCache<TwoQPolicy> cache(8);
+  for (int i = 0; i < 8; ++i) {
+    cache.Put(i, i);
+  }
+
+  // The FIFO is over its size, so it is evicted from, oldest first, even
+  // if hit.
+  assert(*cache.Get(0) == 0);
+  cache.Put(8, 8);
+  assert(cache.Get(0) == nullptr);
+
+  // Coming back while remembered puts a key in the main list, where a
+  // scan doesn't reach it.
+  cache.Put(0, 0);
+  for (int i = 100; i < 200; ++i) {
+    cache.Put(i, i);
+  }
+  assert(*cache.Get(0) == 0);
+  assert(cache.Get(1) == nullptr);
+  assert(*cache.Get(199) == 199);
+}
+
+void EVICTION_POLICY_TEST_ARC() {
+  PolicyCache<ARCPolicy> cache(4);
+
+  // 1 and 2 are frequent, 3 and 4 recent.
+  cache.Put(1, 1);
+  cache.Put(2, 2);
+  cache.Get(1);
+  cache.Get(2);
+  cache.Put(3, 3);
+  cache.Put(4, 4);
+
+  // The recent list is over its target size (0), so it is evicted from.
+  cache.Put(5, 5);
+  assert(cache.Get(3) == nullptr);
+
+  // A miss on the evicted recent key grows the recent list's target.
+  cache.Put(3, 3);
+  assert(cache.Get(4) == nullptr);
+  assert(*cache.Get(3) == 3);
+
+  // A scan evicts from the frequent list only until the recent list is
+  // back over its target (1), from then on only scanned keys go.
+  for (int i = 100; i < 200; ++i) {
+    cache.Put(i, i);
+  }
+  assert(cache.Get(1) == nullptr);
+  assert(*cache.Get(2) == 2);
+  assert(*cache.Get(3) == 3);
+}
+
+void EVICTION_POLICY_TEST_W_TINY_LFU_SCAN() {
+  LRUCache<int, int> lru_cache(100);
+  PolicyCache<WTinyLFUPolicy> tiny_lfu_cache(100);
+
+  // Fill both with hot keys, each read a few times.
+  for (int i = 0; i < 100; ++i) {
+    lru_cache.Put(i, i);
+    tiny_lfu_cache.Put(i, i);
+  }
+  for (int n = 0; n < 3; ++n) {
+    for (int i = 0; i < 100; ++i) {
+      lru_cache.Get(i);
+      tiny_lfu_cache.Get(i);
+    }
+  }
+
+  // A scan of cold keys, while the hot keys are still read, flushes
+  // LRU, but only passes through TinyLFU's window.
+  int lru_hits = 0;
+  int tiny_lfu_hits = 0;
+  for (int i = 0; i < 10000; ++i) {
+    lru_cache.Put(1000 + i, i);
+    tiny_lfu_cache.Put(1000 + i, i);
+    lru_hits += lru_cache.Get(i % 100) != nullptr;
+    tiny_lfu_hits += tiny_lfu_cache.Get(i % 100) != nullptr;
+  }
+  assert(lru_hits == 0);
+  assert(tiny_lfu_hits > 9500);
+  assert(tiny_lfu_cache.Size() == 100);
+}
+
+void EVICTION_POLICY_TEST_W_TINY_LFU_ADMISSION() {
+  PolicyCache<WTinyLFUPolicy> cache(100);
+  for (int i = 0; i < 100; ++i) {
+    cache.Put(i, i);
+  }
+
+  // A new key seen once is turned away once it leaves the window...
+  cache.Put(1000, 1000);
+  cache.Put(1001, 1001);
+  assert(cache.Get(1000) == nullptr);
+  assert(*cache.Get(1001) == 1001);
+
+  // ...but one seen more often than the victim gets in, and stays.
+  for (int n = 0; n < 3; ++n) {
+    cache.Get(2000);
+  }
+  cache.Put(2000, 2000);
+  cache.Put(2001, 2001);
+  assert(*cache.Get(2000) == 2000);
+  for (int i = 3000; i < 3100; ++i) {
+    cache.Put(i, i);
+  }
+  assert(*cache.Get(2000) == 2000);
+
+  // Erasing from any segment makes room.
+  assert(cache.Erase(2000));
+  assert(cache.Erase(50));
+  assert(cache.Size() == 98);
+  cache.Put(4000, 4000);
+  cache.Put(4001, 4001);
+  assert(cache.Size() == 100);
+  assert(*cache.Get(4000) == 4000);
+}
+
+void EVICTION_POLICY_TEST_RESIZE() {
+  CheckPolicyResizes<LRUPolicy>();
+  CheckPolicyResizes<SLRUPolicy>();
+  CheckPolicyResizes<TwoQPolicy>();
+  CheckPolicyResizes<ARCPolicy>();
+  CheckPolicyResizes<WTinyLFUPolicy>();
+}
+
+void RUN_EVICTION_POLICY_TESTS() {
+  EVICTION_POLICY_TEST_CONSISTENT();
+  EVICTION_POLICY_TEST_SLRU();
+  EVICTION_POLICY_TEST_TWO_Q();
+  EVICTION_POLICY_TEST_ARC();
+  EVICTION_POLICY_TEST_W_TINY_LFU_SCAN();
+  EVICTION_POLICY_TEST_W_TINY_LFU_ADMISSION();
+  EVICTION_POLICY_TEST_RESIZE();
+}
@@ -0,0 +1,13 @@
+//
+//  eviction_policy_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef eviction_policy_test_hpp
+#define eviction_policy_test_hpp
+
+extern void RUN_EVICTION_POLICY_TESTS();
+
+#endif /* eviction_policy_test_hpp */
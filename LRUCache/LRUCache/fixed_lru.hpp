@@ -0,0 +1,263 @@
+//
+//  fixed_lru.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef fixed_lru_hpp
+#define fixed_lru_hpp
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "lru_cache.hpp"
+
+using namespace std;
+
+// An LRU cache of at most N entries, N known at compile time, for small
+// caches on latency-critical paths, where an LRUCache's stats, listeners,
+// expiry and heap-allocated slab and index are more than is needed. All of
+// it is inline in the object: an array of N entries, linked into the LRU
+// list by 8-bit indices (16-bit past 255 entries), and a linear-probing
+// index of 2N rounded up to a power of 2 buckets, each a 1-byte tag (7
+// bits of the hash) and an entry index. Probes compare tags, so keys are
+// only compared on a likely match, and erasing shifts the entries after
+// back rather than leaving tombstones, so the index never needs
+// rebuilding. The constructor is constexpr and nothing is ever allocated
+// (keys and values aside), so a FixedLRU can be constinit, or live on the
+// stack. Every method is constexpr too, so with a constexpr Hash, a
+// FixedLRU can be filled and read at compile time.
+//
+// Like LRUCache, Key and Value must be default-constructible: free slots
+// hold a default Key and Value, and removed ones keep theirs until
+// overwritten. Not thread-safe.
+template <typename Key, typename Value, size_t N, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>>
+class FixedLRU {
+public:
+  using KeyType = Key;
+  using ValueType = Value;
+  using Index = conditional_t<(N <= numeric_limits<uint8_t>::max()), uint8_t, uint16_t>;
+
+  static_assert(N > 0 && N < numeric_limits<uint16_t>::max(), "a FixedLRU holds 1 to 65534 entries");
+  static constexpr Index kNullIndex = numeric_limits<Index>::max();
+  // At most half full, so probes stay short.
+  static constexpr size_t kIndexSize = bit_ceil(2 * N);
+  static constexpr int kIndexBits = countr_zero(kIndexSize);
+
+  constexpr FixedLRU() { Clear(); }
+  // Not virtual, so the object is nothing but its entries and index.
+  constexpr ~FixedLRU() {}
+
+  constexpr size_t Size() const { return size_; }
+  constexpr bool IsEmpty() const { return size_ == 0; }
+  static constexpr size_t MaxSize() { return N; }
+
+  // Empties the cache. Keys and values are left in place, to be overwritten
+  // by the next puts.
+  constexpr void Clear() {
+    tags_.fill(0);
+    for (size_t i = 0; i < N; ++i) {
+      entries_[i].next_ = i + 1 < N ? Index(i + 1) : kNullIndex;
+    }
+    free_ = 0;
+    head_ = tail_ = kNullIndex;
+    size_ = 0;
+  }
+
+  // Caches value under key, as the most recently used entry, evicting the
+  // least recently used one if the cache is full. If key is already cached
+  // its value is updated, and a Key only constructed from key on insert.
+  // Returns true if key was inserted, false if updated.
+  template <typename K>
+  constexpr bool Put(K&& key, Value value) {
+    uint32_t hash = HashOf(key);
+    size_t bucket = Find(key, hash);
+    if (bucket != kIndexSize) {
+      Index index = slots_[bucket];
+      entries_[index].value_ = std::move(value);
+      MoveHead(index);
+      return false;
+    }
+
+    if (size_ == N) {
+      Index tail = tail_;
+      Unlink(tail);
+      EraseBucket(BucketOf(tail));
+      entries_[tail].next_ = free_;
+      free_ = tail;
+      --size_;
+    }
+    Index index = free_;
+    Entry& entry = entries_[index];
+    free_ = entry.next_;
+    entry.key_ = Key(std::forward<K>(key));
+    entry.value_ = std::move(value);
+    entry.hash_ = hash;
+    LinkHead(index);
+    ++size_;
+
+    bucket = HomeOf(hash);
+    while (tags_[bucket] != 0) {
+      bucket = (bucket + 1) & (kIndexSize - 1);
+    }
+    tags_[bucket] = TagOf(hash);
+    slots_[bucket] = index;
+    return true;
+  }
+
+  // Returns a pointer to the cached value, making it the most recently
+  // used, or nullptr if key isn't cached. The pointer is only valid until
+  // the next Put() or Erase().
+  template <typename K>
+  constexpr Value* Get(const K& key) {
+    size_t bucket = Find(key, HashOf(key));
+    if (bucket == kIndexSize) {
+      return nullptr;
+    }
+
+    Index index = slots_[bucket];
+    MoveHead(index);
+    return &entries_[index].value_;
+  }
+
+  // Like Get(), but doesn't promote the entry.
+  template <typename K>
+  constexpr Value* Peek(const K& key) {
+    size_t bucket = Find(key, HashOf(key));
+    return bucket != kIndexSize ? &entries_[slots_[bucket]].value_ : nullptr;
+  }
+
+  // Removes key from the cache. Returns false if it wasn't cached.
+  template <typename K>
+  constexpr bool Erase(const K& key) {
+    size_t bucket = Find(key, HashOf(key));
+    if (bucket == kIndexSize) {
+      return false;
+    }
+
+    Index index = slots_[bucket];
+    EraseBucket(bucket);
+    Unlink(index);
+    entries_[index].next_ = free_;
+    free_ = index;
+    --size_;
+    return true;
+  }
+
+  // Returns the least recently used key, the next to be evicted. The cache
+  // must not be empty.
+  constexpr const Key& LeastRecentlyUsed() const { return entries_[tail_].key_; }
+
+private:
+  struct Entry {
+    Key key_ = {};
+    Value value_ = {};
+    // The top 32 bits of the key's mixed hash, for its home bucket and tag.
+    uint32_t hash_ = 0;
+    Index next_ = kNullIndex;
+    Index prev_ = kNullIndex;
+  };
+
+  // Multiplies the hash by 2^64 / phi, which spreads it to the top bits
+  // (std::hash of an integer being the integer), and keeps those.
+  template <typename K>
+  static constexpr uint32_t HashOf(const K& key) {
+    return uint32_t((uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+  // The home bucket is the hash's top bits, the tag the next 7 below them,
+  // with the top bit set, so 0 can mean empty.
+  static constexpr size_t HomeOf(uint32_t hash) { return hash >> (32 - kIndexBits); }
+  static constexpr uint8_t TagOf(uint32_t hash) { return uint8_t(0x80 | ((hash >> (25 - kIndexBits)) & 0x7f)); }
+
+  // Returns the bucket of key, or kIndexSize if it isn't cached.
+  template <typename K>
+  constexpr size_t Find(const K& key, uint32_t hash) const {
+    uint8_t tag = TagOf(hash);
+    for (size_t bucket = HomeOf(hash); tags_[bucket] != 0; bucket = (bucket + 1) & (kIndexSize - 1)) {
+      if (tags_[bucket] == tag && Eq()(entries_[slots_[bucket]].key_, key)) {
+        return bucket;
+      }
+    }
+    return kIndexSize;
+  }
+
+  // Returns the bucket of the entry at index, which must be cached.
+  constexpr size_t BucketOf(Index index) const {
+    size_t bucket = HomeOf(entries_[index].hash_);
+    while (tags_[bucket] == 0 || slots_[bucket] != index) {
+      bucket = (bucket + 1) & (kIndexSize - 1);
+    }
+    return bucket;
+  }
+
+  // Empties bucket, then moves back each entry after it in the probe
+  // sequence that can go there, so every entry is still reached from its
+  // home bucket without crossing an empty one.
+  constexpr void EraseBucket(size_t bucket) {
+    tags_[bucket] = 0;
+    for (size_t next = (bucket + 1) & (kIndexSize - 1); tags_[next] != 0; next = (next + 1) & (kIndexSize - 1)) {
+      size_t home = HomeOf(entries_[slots_[next]].hash_);
+      // Moves unless its home is after the empty bucket, up to next.
+      if (((next - home) & (kIndexSize - 1)) >= ((next - bucket) & (kIndexSize - 1))) {
+        tags_[bucket] = tags_[next];
+        slots_[bucket] = slots_[next];
+        tags_[next] = 0;
+        bucket = next;
+      }
+    }
+  }
+
+  constexpr void LinkHead(Index index) {
+    Entry& entry = entries_[index];
+    entry.prev_ = kNullIndex;
+    entry.next_ = head_;
+    if (head_ != kNullIndex) {
+      entries_[head_].prev_ = index;
+    } else {
+      tail_ = index;
+    }
+    head_ = index;
+  }
+
+  constexpr void Unlink(Index index) {
+    Entry& entry = entries_[index];
+    if (entry.prev_ != kNullIndex) {
+      entries_[entry.prev_].next_ = entry.next_;
+    } else {
+      head_ = entry.next_;
+    }
+    if (entry.next_ != kNullIndex) {
+      entries_[entry.next_].prev_ = entry.prev_;
+    } else {
+      tail_ = entry.prev_;
+    }
+  }
+
+  constexpr void MoveHead(Index index) {
+    if (index != head_) {
+      Unlink(index);
+      LinkHead(index);
+    }
+  }
+
+  array<Entry, N> entries_ = {};
+  // 0 for an empty bucket, else the tag of the key whose entry is at the
+  // same position in slots_.
+  array<uint8_t, kIndexSize> tags_ = {};
+  array<Index, kIndexSize> slots_ = {};
+  // The most and least recently used entries, and the first free one, its
+  // next_ linking to the next free one.
+  Index head_ = kNullIndex;
+  Index tail_ = kNullIndex;
+  Index free_ = 0;
+  Index size_ = 0;
+};
+
+#endif /* fixed_lru_hpp */
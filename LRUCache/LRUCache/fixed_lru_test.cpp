@@ -0,0 +1,160 @@
+//
+//  fixed_lru_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "fixed_lru_test.hpp"
+#include "fixed_lru.hpp"
+
+#include <cassert>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "lru_cache.hpp"
+
+using namespace std;
+
+namespace {
+
+// Hashes every key alike, so all of them probe from the same bucket.
+struct CollidingHash {
+  constexpr size_t operator()(int) const { return 42; }
+};
+
+struct IdentityHash {
+  constexpr size_t operator()(int key) const { return size_t(key); }
+};
+
+// Built before main(), without running any code.
+constinit FixedLRU<int, int, 8> global_cache;
+
+} // namespace
+
+void FIXED_LRU_TEST_PUT_GET() {
+  static_assert(is_same_v<FixedLRU<int, int, 255>::Index, uint8_t>);
+  static_assert(is_same_v<FixedLRU<int, int, 256>::Index, uint16_t>);
+  static_assert(FixedLRU<int, int, 100>::kIndexSize == 256);
+  // Nothing but the entries and the index: 64 * (4 + 4 + 4 + 1 + 1) bytes,
+  // then 128 tags and 128 indices, and 4 more indices.
+  static_assert(sizeof(FixedLRU<int, int, 64>) == 64 * 16 + 128 * 2 + 4);
+
+  FixedLRU<string, int, 3> cache;
+  assert(cache.IsEmpty() && cache.MaxSize() == 3);
+  assert(cache.Get("rose") == nullptr);
+
+  assert(cache.Put("rose", 10));
+  assert(cache.Put(string("mars"), 20));
+  assert(cache.Put(string_view("zara"), 30));
+  assert(cache.Size() == 3);
+  assert(*cache.Get("rose") == 10);
+  assert(*cache.Get(string_view("mars")) == 20);
+  assert(*cache.Peek(string("zara")) == 30);
+
+  // An update doesn't grow the cache, and promotes.
+  assert(!cache.Put("zara", 31));
+  assert(cache.Size() == 3);
+  assert(*cache.Get("zara") == 31);
+
+  // rose is now the least recently used.
+  assert(cache.LeastRecentlyUsed() == "rose");
+  assert(cache.Put("kiwi", 40));
+  assert(cache.Get("rose") == nullptr);
+  assert(cache.Size() == 3);
+
+  assert(cache.Erase("mars"));
+  assert(!cache.Erase("mars"));
+  assert(cache.Size() == 2);
+  assert(cache.Put("rose", 11));
+  assert(*cache.Get("rose") == 11 && *cache.Get("kiwi") == 40 && *cache.Get("zara") == 31);
+
+  cache.Clear();
+  assert(cache.IsEmpty() && cache.Get("rose") == nullptr);
+}
+
+void FIXED_LRU_TEST_PEEK_DOESNT_PROMOTE() {
+  FixedLRU<int, int, 2> cache;
+  cache.Put(1, 1);
+  cache.Put(2, 2);
+  assert(*cache.Peek(1) == 1);
+  cache.Put(3, 3);
+  assert(cache.Peek(1) == nullptr);
+  assert(*cache.Get(2) == 2);
+  cache.Put(4, 4);
+  assert(cache.Peek(3) == nullptr && *cache.Peek(2) == 2);
+}
+
+void FIXED_LRU_TEST_COLLISIONS() {
+  // Every key in one probe sequence, wrapping around the index: erasing
+  // any one of them must leave the rest reachable.
+  FixedLRU<int, int, 16, CollidingHash> cache;
+  for (int erased = 0; erased < 16; ++erased) {
+    cache.Clear();
+    for (int key = 0; key < 16; ++key) {
+      cache.Put(key, key * 10);
+    }
+    assert(cache.Erase(erased));
+    for (int key = 0; key < 16; ++key) {
+      if (key == erased) {
+        assert(cache.Peek(key) == nullptr);
+      } else {
+        assert(*cache.Peek(key) == key * 10);
+      }
+    }
+    cache.Put(100, 1000);
+    assert(*cache.Peek(100) == 1000);
+  }
+}
+
+void FIXED_LRU_TEST_MATCHES_LRU_CACHE() {
+  // Random puts, gets and erases, against an LRUCache of the same size.
+  FixedLRU<int, int, 64> fixed;
+  LRUCache<int, int> cache(64);
+  minstd_rand rng(1);
+  for (int i = 0; i < 100000; ++i) {
+    int key = rng() % 200;
+    switch (rng() % 8) {
+      case 0:
+        assert(fixed.Erase(key) == cache.Erase(key));
+        break;
+      case 1:
+      case 2:
+        fixed.Put(key, i);
+        cache.Put(key, i);
+        break;
+      default:
+        int* value = fixed.Get(key);
+        int* expected = cache.Get(key);
+        assert((value == nullptr) == (expected == nullptr));
+        assert(!value || *value == *expected);
+    }
+    assert(fixed.Size() == cache.Size());
+  }
+}
+
+void FIXED_LRU_TEST_CONSTEXPR() {
+  // With a constexpr hash, a FixedLRU works at compile time.
+  static_assert([] {
+    FixedLRU<int, int, 2, IdentityHash> cache;
+    cache.Put(1, 10);
+    cache.Put(2, 20);
+    cache.Get(1);
+    cache.Put(3, 30);
+    return cache.Size() == 2 && *cache.Get(1) == 10 && cache.Get(2) == nullptr;
+  }());
+
+  assert(global_cache.IsEmpty());
+  global_cache.Put(1, 10);
+  assert(*global_cache.Get(1) == 10);
+  global_cache.Clear();
+}
+
+void RUN_FIXED_LRU_TESTS() {
+  FIXED_LRU_TEST_PUT_GET();
+  FIXED_LRU_TEST_PEEK_DOESNT_PROMOTE();
+  FIXED_LRU_TEST_COLLISIONS();
+  FIXED_LRU_TEST_MATCHES_LRU_CACHE();
+  FIXED_LRU_TEST_CONSTEXPR();
+}
@@ -0,0 +1,13 @@
+//
+//  fixed_lru_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef fixed_lru_test_hpp
+#define fixed_lru_test_hpp
+
+extern void RUN_FIXED_LRU_TESTS();
+
+#endif /* fixed_lru_test_hpp */
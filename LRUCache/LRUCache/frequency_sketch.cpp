@@ -0,0 +1,78 @@
+//
+//  frequency_sketch.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "frequency_sketch.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Odd multipliers, one per row, to derive each row's hash from the key's.
+constexpr uint64_t kSeeds[FrequencySketch::kDepth] = {
+  0xc3a5c85c97cb3127, 0xb492b66fbe98f273, 0x9ae16a3b2f90404f, 0xcbf29ce484222325,
+};
+
+// Every counter's high bit, for halving a whole word at once.
+constexpr uint64_t kResetMask = 0x7777777777777777;
+
+// Returns where row's counter for the key with hash is: a word of the
+// table, and the counter's bit offset within it.
+inline void Locate(uint64_t hash, int row, uint64_t mask, size_t* word, int* shift) {
+  uint64_t h = (hash + kSeeds[row]) * kSeeds[row];
+  h ^= h >> 32;
+  *word = h & mask;
+  // Each row has its own quarter of the word's 16 counters.
+  *shift = ((row << 2) | (h >> 62)) << 2;
+}
+
+} // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity)
+    : table_(bit_ceil(max<size_t>(capacity, 1))),
+      mask_(table_.size() - 1),
+      max_samples_(max<size_t>(capacity, 1) * kSampleFactor) {
+}
+
+FrequencySketch::~FrequencySketch() {
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  bool incremented = false;
+  for (int row = 0; row < kDepth; ++row) {
+    size_t word;
+    int shift;
+    Locate(hash, row, mask_, &word, &shift);
+    if (((table_[word] >> shift) & kMaxCount) != kMaxCount) {
+      table_[word] += uint64_t(1) << shift;
+      incremented = true;
+    }
+  }
+
+  // Keys that have saturated don't count towards aging.
+  if (incremented && ++num_samples_ >= max_samples_) {
+    Age();
+  }
+}
+
+int FrequencySketch::Estimate(uint64_t hash) const {
+  int estimate = kMaxCount;
+  for (int row = 0; row < kDepth; ++row) {
+    size_t word;
+    int shift;
+    Locate(hash, row, mask_, &word, &shift);
+    estimate = min(estimate, int((table_[word] >> shift) & kMaxCount));
+  }
+  return estimate;
+}
+
+void FrequencySketch::Age() {
+  for (uint64_t& word : table_) {
+    word = (word >> 1) & kResetMask;
+  }
+  num_samples_ /= 2;
+}
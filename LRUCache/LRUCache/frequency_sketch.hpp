@@ -0,0 +1,64 @@
+//
+//  frequency_sketch.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef frequency_sketch_hpp
+#define frequency_sketch_hpp
+
+#include <cstdint>
+#include <vector>
+
+#include "memory_usage.hpp"
+
+using namespace std;
+
+// A count-min sketch of how often keys have been seen recently, for
+// TinyLFU admission (see LRUCache). Keys are given by their hash.
+//
+// Counters are 4 bits, 16 to a 64-bit word, and a key has one counter in
+// each of kDepth rows. A row's counters are a quarter of a word, so a key
+// touches kDepth words, and its estimate is the least of its counters.
+// Once capacity * kSampleFactor increments have been counted, every
+// counter is halved, so the sketch forgets old history.
+class FrequencySketch {
+public:
+  static constexpr int kDepth = 4;
+  static constexpr int kMaxCount = 15;
+  static constexpr size_t kSampleFactor = 10;
+
+  // A sketch for a cache of capacity entries. It takes about 8 bytes per
+  // entry.
+  FrequencySketch(size_t capacity);
+  virtual ~FrequencySketch();
+
+  // Counts one occurrence of the key with hash.
+  void Increment(uint64_t hash);
+
+  // Returns how often the key with hash has been seen, from 0 to
+  // kMaxCount. Never less than the true count since the last aging,
+  // though collisions can make it more.
+  int Estimate(uint64_t hash) const;
+
+  // Returns the number of increments counted since the last aging.
+  size_t NumSamples() const { return num_samples_; }
+
+  // Adds the counters to component of usage.
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+    usage.AddBlock(component, table_.capacity() * sizeof(uint64_t));
+  }
+
+private:
+  // Halves every counter.
+  void Age();
+
+  vector<uint64_t> table_;
+  // table_.size() - 1, table_'s size being a power of 2.
+  uint64_t mask_;
+  size_t max_samples_;
+  size_t num_samples_ = 0;
+};
+
+#endif /* frequency_sketch_hpp */
@@ -0,0 +1,82 @@
+//
+//  frequency_sketch_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "frequency_sketch_test.hpp"
+#include "frequency_sketch.hpp"
+
+#include <cassert>
+#include <functional>
+
+using namespace std;
+
+void FREQUENCY_SKETCH_TEST_INCREMENT() {
+  FrequencySketch sketch(100);
+  uint64_t rose = hash<int>()(1);
+  uint64_t mars = hash<int>()(2);
+  assert(sketch.Estimate(rose) == 0);
+
+  // Counts go up, and stop at the maximum.
+  for (int i = 1; i <= 20; ++i) {
+    sketch.Increment(rose);
+    assert(sketch.Estimate(rose) == min(i, FrequencySketch::kMaxCount));
+  }
+  sketch.Increment(mars);
+  assert(sketch.Estimate(mars) == 1);
+  assert(sketch.Estimate(rose) == FrequencySketch::kMaxCount);
+}
+
+void FREQUENCY_SKETCH_TEST_AGING() {
+  FrequencySketch sketch(10);
+  uint64_t rose = hash<int>()(1);
+  for (int i = 0; i < 8; ++i) {
+    sketch.Increment(rose);
+  }
+
+  // Once enough increments are counted, every count is halved (the last
+  // of them may land on rose's counters too).
+  int num_keys = 0;
+  int estimate = 0;
+  size_t num_samples = 0;
+  while (sketch.NumSamples() >= num_samples) {
+    num_samples = sketch.NumSamples();
+    estimate = sketch.Estimate(rose);
+    sketch.Increment(hash<int>()(1000 + num_keys++));
+  }
+  assert(estimate >= 8);
+  assert(sketch.Estimate(rose) >= estimate / 2 && sketch.Estimate(rose) <= (estimate + 1) / 2);
+  assert(num_samples + 1 == 10 * FrequencySketch::kSampleFactor);
+  assert(sketch.NumSamples() == 10 * FrequencySketch::kSampleFactor / 2);
+}
+
+void FREQUENCY_SKETCH_TEST_FEW_COLLISIONS() {
+  // One hot key among many seen once each, in a sketch for that many.
+  constexpr int kNumKeys = 1000;
+  FrequencySketch sketch(kNumKeys);
+  for (int i = 0; i < 10; ++i) {
+    sketch.Increment(hash<int>()(-1));
+  }
+  for (int i = 0; i < kNumKeys; ++i) {
+    sketch.Increment(hash<int>()(i));
+  }
+
+  // The cold keys are rarely overestimated, and never by as much as the
+  // hot key is seen.
+  assert(sketch.Estimate(hash<int>()(-1)) == 10);
+  int num_overestimated = 0;
+  for (int i = 0; i < kNumKeys; ++i) {
+    int estimate = sketch.Estimate(hash<int>()(i));
+    assert(estimate >= 1 && estimate < 10);
+    num_overestimated += estimate > 1;
+  }
+  assert(num_overestimated < kNumKeys / 10);
+}
+
+void RUN_FREQUENCY_SKETCH_TESTS() {
+  FREQUENCY_SKETCH_TEST_INCREMENT();
+  FREQUENCY_SKETCH_TEST_AGING();
+  FREQUENCY_SKETCH_TEST_FEW_COLLISIONS();
+}
@@ -0,0 +1,13 @@
+//
+//  frequency_sketch_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef frequency_sketch_test_hpp
+#define frequency_sketch_test_hpp
+
+extern void RUN_FREQUENCY_SKETCH_TESTS();
+
+#endif /* frequency_sketch_test_hpp */
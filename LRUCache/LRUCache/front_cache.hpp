@@ -0,0 +1,211 @@
+//
+//  front_cache.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef front_cache_hpp
+#define front_cache_hpp
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "epoch.hpp"
+#include "lru_cache.hpp"
+#include "sharded_lru_cache.hpp"
+
+using namespace std;
+
+// A ShardedCache of LRUCaches with a small cache in front of it for each
+// thread, so a few very hot keys are served without taking any shard's
+// lock or promoting them in its list. Each thread's front cache is
+// direct-mapped, kFrontSize slots of a key, a copy of its value and a
+// version: a hit on the shared cache fills the key's slot, replacing
+// whatever was there.
+//
+// Keys hash to one of kNumVersions shared version counters, which are
+// bumped after every update of a key and every removal (by the shared
+// cache's eviction listener). A front cache entry is only served while
+// its counter still has the version read before the shared lookup that
+// filled it, so it is never served after its shared entry has changed,
+// or gone, and a hit costs a load from a cache line that only changes
+// when a key sharing it does. Serving from the front doesn't count as a
+// hit in GetStats(), or promote the shared entry: a key hot enough to be
+// served from the front mostly stays resident anyway.
+//
+// Entries with a time to live leave the front cache when the shared one
+// removes them, which for a key only ever hit in the front is when Tick()
+// expires it. Writes have to go through the FrontCache, for updates to
+// be seen.
+template <typename Key, typename Value, size_t kFrontSize = 64, typename Hash = LRUCacheHash<Key>,
+          typename Eq = equal_to<>, template <typename, typename, typename> class Policy = LRUPolicy>
+class FrontCache {
+public:
+  using ShardCache = LRUCache<Key, Value, Hash, Eq, Policy>;
+  using Cache = ShardedCache<ShardCache>;
+  using KeyType = Key;
+  using ValueType = Value;
+  using EvictionListener = typename ShardCache::EvictionListener;
+
+  static_assert(has_single_bit(kFrontSize), "the front cache size must be a power of 2");
+  static constexpr size_t kNumVersions = 4096;
+  static_assert(has_single_bit(kNumVersions));
+
+  // The arguments are the shared cache's, see ShardedCache.
+  template <typename... Args>
+  FrontCache(Args&&... args) : cache_(std::forward<Args>(args)...) {
+    SetEvictionListener(nullptr);
+  }
+  virtual ~FrontCache() {
+    for (atomic<Front*>& front : fronts_) {
+      delete front.load(memory_order_acquire);
+    }
+  }
+  FrontCache(const FrontCache&) = delete;
+  FrontCache& operator=(const FrontCache&) = delete;
+
+  // Returns a copy of the value cached under key, from the calling
+  // thread's front cache if it is there and current, else from the shared
+  // cache, filling the front cache on a hit.
+  template <typename K>
+  optional<Value> Get(const K& key) {
+    uint64_t h = Mix(key);
+    Front& front = GetFront();
+    Slot& slot = front.slots_[SlotOf(h)];
+    atomic<uint64_t>& version = versions_[VersionOf(h)];
+    uint64_t current = version.load(memory_order_acquire);
+    if (slot.entry_ && slot.version_ == current && Eq()(slot.entry_->first, key)) {
+      front.num_hits_.store(front.num_hits_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+      return slot.entry_->second;
+    }
+
+    optional<Value> value = cache_.Get(key);
+    if (value) {
+      slot.entry_.emplace(Key(key), *value);
+      slot.version_ = current;
+    }
+    return value;
+  }
+
+  // Like Get(), but on a miss caches and returns loader(key), see
+  // ShardedCache::GetOrLoad().
+  template <typename K, typename Loader>
+  Value GetOrLoad(const K& key, Loader&& loader) {
+    if (optional<Value> value = Get(key)) {
+      return *value;
+    }
+    return cache_.GetOrLoad(key, std::forward<Loader>(loader));
+  }
+
+  template <typename K>
+  bool Put(K&& key, Value value) {
+    uint64_t h = Mix(key);
+    bool put = cache_.Put(std::forward<K>(key), std::move(value));
+    Invalidate(h);
+    return put;
+  }
+
+  template <typename K, typename Rep, typename Period>
+  bool Put(K&& key, Value value, chrono::duration<Rep, Period> ttl) {
+    uint64_t h = Mix(key);
+    bool put = cache_.Put(std::forward<K>(key), std::move(value), ttl);
+    Invalidate(h);
+    return put;
+  }
+
+  template <typename K>
+  optional<Value> Upsert(K&& key, Value value) {
+    uint64_t h = Mix(key);
+    optional<Value> previous = cache_.Upsert(std::forward<K>(key), std::move(value));
+    Invalidate(h);
+    return previous;
+  }
+
+  // Erasing is a removal, so the listener invalidates it.
+  template <typename K>
+  bool Erase(const K& key) {
+    return cache_.Erase(key);
+  }
+
+  size_t Tick(size_t max_work_per_shard = ShardCache::kDefaultTickWork) {
+    return cache_.Tick(max_work_per_shard);
+  }
+
+  void Resize(size_t max_size) { cache_.Resize(max_size); }
+
+  // Returns the shared cache's stats, which don't count front cache hits.
+  CacheStats GetStats() { return cache_.GetStats(); }
+
+  // Returns the number of hits served by front caches, in all threads.
+  uint64_t NumFrontHits() const {
+    uint64_t num_hits = 0;
+    for (const atomic<Front*>& front : fronts_) {
+      if (Front* f = front.load(memory_order_acquire)) {
+        num_hits += f->num_hits_.load(memory_order_relaxed);
+      }
+    }
+    return num_hits;
+  }
+
+  // Has listener called with each entry removed from the shared cache,
+  // see LRUCache::SetEvictionListener().
+  void SetEvictionListener(EvictionListener listener) {
+    cache_.SetEvictionListener([this, listener](const Key& key, const Value& value, RemovalCause cause) {
+      Invalidate(Mix(key));
+      if (listener) {
+        listener(key, value, cause);
+      }
+    });
+  }
+
+private:
+  struct Slot {
+    optional<pair<Key, Value>> entry_;
+    uint64_t version_ = 0;
+  };
+
+  // A thread's front cache. Only its thread touches the slots.
+  struct Front {
+    array<Slot, kFrontSize> slots_;
+    atomic<uint64_t> num_hits_ = 0;
+  };
+
+  // Mixes the key's hash, std::hash of an integer being the integer. The
+  // slot and the version are picked from different bits, high enough to
+  // depend on most of the hash's.
+  template <typename K>
+  static uint64_t Mix(const K& key) {
+    return Hash()(key) * 0x9E3779B97F4A7C15ull;
+  }
+  static size_t SlotOf(uint64_t h) { return (h >> 32) & (kFrontSize - 1); }
+  static size_t VersionOf(uint64_t h) { return (h >> 20) & (kNumVersions - 1); }
+
+  void Invalidate(uint64_t h) { versions_[VersionOf(h)].fetch_add(1, memory_order_release); }
+
+  // Returns the calling thread's front cache, creating it the first time.
+  // A thread's slot may have been another's, now exited: its entries are
+  // just as valid.
+  Front& GetFront() {
+    atomic<Front*>& front = fronts_[EpochManager::ThreadSlot()];
+    Front* f = front.load(memory_order_relaxed);
+    if (!f) {
+      f = new Front();
+      front.store(f, memory_order_release);
+    }
+    return *f;
+  }
+
+  Cache cache_;
+  array<atomic<uint64_t>, kNumVersions> versions_ = {};
+  array<atomic<Front*>, EpochManager::kMaxThreads> fronts_ = {};
+};
+
+#endif /* front_cache_hpp */
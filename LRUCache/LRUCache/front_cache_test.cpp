@@ -0,0 +1,137 @@
+//
+//  front_cache_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "front_cache_test.hpp"
+#include "front_cache.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void FRONT_CACHE_TEST_HITS() {
+  FrontCache<string, int> cache(100, 4);
+  assert(cache.Put("rose", 1));
+
+  // The first Get() is a shared hit, and fills the front, which serves the
+  // next ones.
+  assert(cache.Get("rose") == 1);
+  assert(cache.NumFrontHits() == 0);
+  assert(cache.Get("rose") == 1);
+  assert(cache.Get(string_view("rose")) == 1);
+  assert(cache.NumFrontHits() == 2);
+  assert(cache.GetStats().hits_ == 1);
+
+  // Misses go to the shared cache, and fill nothing.
+  assert(cache.Get("mars") == nullopt);
+  assert(cache.Get("mars") == nullopt);
+  assert(cache.GetStats().misses_ == 2);
+  assert(cache.GetOrLoad("mars", [](const string& key) { return 2; }) == 2);
+  assert(cache.Get("mars") == 2);
+  assert(cache.Get("mars") == 2);
+  assert(cache.NumFrontHits() == 3);
+
+  // An update invalidates the front entry, so the next Get() goes to the
+  // shared cache for the new value.
+  assert(cache.Put("rose", 10));
+  assert(cache.Get("rose") == 10);
+  assert(cache.NumFrontHits() == 3);
+  assert(cache.Get("rose") == 10);
+  assert(cache.NumFrontHits() == 4);
+  assert(cache.Upsert("rose", 20) == 10);
+  assert(cache.Get("rose") == 20);
+
+  // As does erasing.
+  assert(cache.Erase("rose"));
+  assert(cache.Get("rose") == nullopt);
+}
+
+void FRONT_CACHE_TEST_EVICTION() {
+  // One shard of 2: putting a third key evicts the LRU one, which the
+  // front cache still holds, but doesn't serve.
+  FrontCache<int, int, 4> cache(2, 1);
+  int num_evicted = 0;
+  cache.SetEvictionListener([&num_evicted](int, int, RemovalCause cause) {
+    assert(cause == RemovalCause::kEvicted);
+    ++num_evicted;
+  });
+  cache.Put(1, 1);
+  cache.Put(2, 2);
+  assert(cache.Get(1) == 1 && cache.Get(1) == 1);
+  assert(cache.Get(2) == 2 && cache.Get(2) == 2);
+  assert(cache.NumFrontHits() == 2);
+  cache.Put(3, 3);
+  assert(num_evicted == 1);
+  assert(cache.Get(1) == nullopt);
+  assert(cache.Get(2) == 2);
+
+  // Shrinking evicts too.
+  cache.Resize(1);
+  assert(cache.Get(3) == 3);
+  assert(cache.Get(2) == nullopt);
+  assert(num_evicted == 2);
+}
+
+void FRONT_CACHE_TEST_TTL() {
+  FrontCache<int, int> cache(100, 1);
+  cache.Put(1, 1, chrono::milliseconds(1));
+  assert(cache.Get(1) == 1 && cache.Get(1) == 1);
+  this_thread::sleep_for(chrono::milliseconds(5));
+  assert(cache.Tick() == 1);
+  assert(cache.Get(1) == nullopt);
+}
+
+void FRONT_CACHE_TEST_CONCURRENT() {
+  // Readers hammer a few hot keys while a writer counts each one up: a
+  // reader must never see a key's value go back, and once the writer is
+  // done, every reader must see the final values.
+  constexpr int kNumReaders = 4;
+  constexpr int kNumKeys = 8;
+  constexpr int kNumUpdates = 20000;
+  FrontCache<int, int> cache(1000, 4);
+  for (int key = 0; key < kNumKeys; ++key) {
+    cache.Put(key, 0);
+  }
+
+  atomic<bool> done = false;
+  vector<thread> threads;
+  for (int t = 0; t < kNumReaders; ++t) {
+    threads.emplace_back([&cache, &done]() {
+      vector<int> latest(kNumKeys, 0);
+      for (int i = 0; !done.load(); ++i) {
+        int key = i % kNumKeys;
+        optional<int> value = cache.Get(key);
+        assert(value && *value >= latest[key]);
+        latest[key] = *value;
+      }
+      for (int key = 0; key < kNumKeys; ++key) {
+        assert(cache.Get(key).value_or(-1) == kNumUpdates);
+      }
+    });
+  }
+  for (int i = 1; i <= kNumUpdates; ++i) {
+    for (int key = 0; key < kNumKeys; ++key) {
+      cache.Put(key, i);
+    }
+  }
+  done = true;
+  for (thread& thread : threads) {
+    thread.join();
+  }
+  assert(cache.NumFrontHits() > 0);
+}
+
+void RUN_FRONT_CACHE_TESTS() {
+  FRONT_CACHE_TEST_HITS();
+  FRONT_CACHE_TEST_EVICTION();
+  FRONT_CACHE_TEST_TTL();
+  FRONT_CACHE_TEST_CONCURRENT();
+}
@@ -0,0 +1,13 @@
+//
+//  front_cache_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef front_cache_test_hpp
+#define front_cache_test_hpp
+
+extern void RUN_FRONT_CACHE_TESTS();
+
+#endif /* front_cache_test_hpp */
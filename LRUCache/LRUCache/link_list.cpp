@@ -7,6 +7,8 @@
 
 #include "link_list.hpp"
 
+#include <unordered_set>
+
 #define LOG_REF_COUNT(node) \
   cout << __FUNCTION__ << " line: " << __LINE__ << " "#node".use_count() " << node.use_count() << endl;
 
@@ -22,15 +24,6 @@ string GetRandomString(int length) {
   return s;
 }
 
-bool IsContentsPresent(const vector<LinkList::Node::Contents>&items, const LinkList::Node::Contents& contents) {
-  for (size_t i = 0; i < items.size(); ++i) {
-    if (get<0>(items[i]) == get<0>(contents)) {
-      return true;
-    }
-  }
-  return false;
-}
-
 } // namespace
 
 /*static*/ vector<LinkList::Node::Contents> LinkList::Node::GetRandomItems(int num_items) {
@@ -39,12 +32,16 @@ bool IsContentsPresent(const vector<LinkList::Node::Contents>&items, const LinkL
   constexpr int kStringLen = 6;
   constexpr int kMaxValue = 1000000;
 
+  // The keys so far, so a duplicate is found without scanning items.
+  unordered_set<string> keys;
+  keys.reserve(num_items);
+  items.reserve(num_items);
   for (int i = 0; i < num_items; ++i) {
     bool present = true;
     LinkList::Node::Contents contents;
     while (present) {
       contents = make_tuple<string, int>(GetRandomString(kStringLen), rand()%kMaxValue);
-      present = IsContentsPresent(items, contents);
+      present = !keys.insert(get<0>(contents)).second;
     }
     items.push_back(contents);
   }
@@ -173,7 +170,7 @@ optional<LinkList::Node::Contents> LinkList::PopHead() {
   Node* node = head_.get();
   Node::Contents contents = node->contents_;
   head_ = node->next_;
-  tail_->prev_ = nullptr;
+  head_->prev_ = nullptr;
   return contents;
 }
 
@@ -252,6 +249,25 @@ vector<LinkList::Node::Contents> LinkList::WalkTailToHead() {
   return v;
 }
 
+MemoryUsage LinkList::GetMemoryUsage() const {
+  // A vtable pointer, and the use and weak counts.
+  constexpr size_t kControlBlockBytes = sizeof(void*) + 2 * sizeof(int);
+  constexpr size_t kKeyBytes = sizeof(tuple_element_t<0, Node::Contents>);
+  constexpr size_t kValueBytes = sizeof(tuple_element_t<1, Node::Contents>);
+
+  MemoryUsage usage;
+  usage.metadata_bytes_ += sizeof(*this);
+  for (const Node* node = head_.get(); node; node = node->next_.get()) {
+    ++usage.num_entries_;
+    usage.AddBlock(usage.node_bytes_, kControlBlockBytes + sizeof(Node));
+    usage.node_bytes_ -= kKeyBytes + kValueBytes;
+    usage.key_bytes_ += kKeyBytes;
+    usage.value_bytes_ += kValueBytes;
+    usage.AddBlock(usage.key_bytes_, HeapBytes(get<0>(node->contents_)));
+  }
+  return usage;
+}
+
 // Checks if the list is empty and inserts contents if it is,
 // return true in that case, false otherwise.
 bool LinkList::CheckInsertEmpty(Node::Contents contents) {
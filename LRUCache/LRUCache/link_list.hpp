@@ -13,6 +13,8 @@
 #include <vector>
 #include <string>
 
+#include "memory_usage.hpp"
+
 using namespace std;
 
 class LinkList {
@@ -79,6 +81,12 @@ public:
   vector<Node::Contents> WalkHeadToTail();
   vector<Node::Contents> WalkTailToHead();
 
+  // Returns the bytes the list takes, see MemoryUsage. Each node is one
+  // block, from make_shared(): the shared_ptr control block, then the
+  // Node. The control block, the Node's vtable pointer and its links count
+  // as node bytes, its contents as a key and a value.
+  MemoryUsage GetMemoryUsage() const;
+
 private:
   // Checks if the list is empty and inserts contents if it is,
   // return true in that case, false otherwise.
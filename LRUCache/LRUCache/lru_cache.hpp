@@ -8,28 +8,1078 @@
 #ifndef lru_cache_hpp
 #define lru_cache_hpp
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
-#include "link_list.hpp"
+#include "cache_stats.hpp"
+#include "eviction_policy.hpp"
+#include "memory_usage.hpp"
+#include "miss_ratio_curve.hpp"
+#include "small_string.hpp"
+#include "snapshot.hpp"
+#include "swiss_index.hpp"
+#include "task.hpp"
+#include "timer_wheel.hpp"
+#include "write_back_queue.hpp"
 
 using namespace std;
 
+// The default hash for LRUCache keys. For string keys it is transparent,
+// hashing anything convertible to a string_view, so Get() can be called
+// with a string_view or a literal without building a temporary string.
+template <typename Key>
+struct LRUCacheHash : hash<Key> {};
+
+template <>
+struct LRUCacheHash<string> {
+  using is_transparent = void;
+  size_t operator()(string_view key) const { return hash<string_view>()(key); }
+};
+
+template <size_t kInlineSize>
+struct LRUCacheHash<SmallString<kInlineSize>> {
+  using is_transparent = void;
+  size_t operator()(string_view key) const { return hash<string_view>()(key); }
+};
+
+// Why an entry left an LRUCache, as told to its EvictionListener.
+enum class RemovalCause {
+  // To make room for another.
+  kEvicted,
+  // Its time to live ran out.
+  kExpired,
+  // By Erase(), or by a Put() of a value too heavy to cache.
+  kErased,
+};
+
+// Evicts least-recently-used entries to stay within a capacity, which is
+// either a number of entries or a total weight (bytes, say) as measured
+// by a user-supplied Weigher. Which entries are evicted is up to Policy,
+// LRU by default (see eviction_policy.hpp for the others).
+//
+// Given a number of entries, all of them are preallocated at construction,
+// in the policy's SlabList, and indexed by key in a SwissIndex reserved
+// to hold them. Evicted slots are recycled, so Put() and Get() do not
+// allocate (short, SSO-sized keys), with LRUPolicy at least.
+//
+// Entries may also be given a time to live, after which they expire. An
+// expired entry is removed when it is next looked up, or by Tick(), which
+// reclaims expired entries a bounded number at a time, using a
+// TimerWheel.
+//
+// An EvictionListener can be told of every entry that leaves the cache.
+// For a cache in front of a slower store, entries may also be put dirty
+// (see PutDirty()); with a WriteBackQueue set, dirty entries that are
+// evicted or expire are moved into it, to be written back to the store by
+// its thread rather than by the Put() that evicted them.
+//
+// The cache can be saved to a snapshot file and loaded back, most
+// recently used entries first, for a warm restart (see SaveSnapshot()).
+//
+// Coroutines can look entries up with GetAsync(), which on a miss awaits
+// an asynchronous loader, once for all the coroutines missing on a key.
+//
+// Hits, misses, inserts and removals are always counted (see GetStats()),
+// which costs an increment each. Get() and Put() latencies are only
+// recorded if asked for, since that reads the clock twice per call.
+//
+// Key and Value must be default-constructible, since the slab holds a
+// default Key and Value in each free slot. Values are moved in and out,
+// never copied, so move-only types work. Lookups take any type that Hash
+// and Eq accept (see LRUCacheHash), when both are transparent.
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>,
+          template <typename, typename, typename> class Policy = LRUPolicy>
 class LRUCache {
 public:
-  LRUCache(size_t max_size);
-  virtual ~LRUCache();
+  using KeyType = Key;
+  using ValueType = Value;
+  using HashType = Hash;
+  using EqType = Eq;
+  using PolicyType = Policy<Key, Value, Hash>;
+  using Contents = typename PolicyType::Contents;
+  using Clock = chrono::steady_clock;
+
+  // Returns the weight of an entry. Must always return the same weight for
+  // the same key and value, since entries are weighed again on removal.
+  using Weigher = function<size_t(const Key&, const Value&)>;
+
+  // Called with each entry that leaves the cache, other than by having its
+  // value overwritten, and why. It runs inside the call that removed the
+  // entry (under the shard's lock, in a ShardedCache), so should be quick,
+  // and must not call back into the cache.
+  using EvictionListener = function<void(const Key&, const Value&, RemovalCause)>;
+
+  // Get() promotes, which writes to the policy's lists (see ShardedCache).
+  static constexpr bool kConcurrentGet = false;
+
+  // The most entries Tick() expires, by default.
+  static constexpr size_t kDefaultTickWork = 1000;
+
+  // A cache of at most max_size entries.
+  LRUCache(size_t max_size)
+      : max_weight_(max_size), max_entry_weight_(max_size), weight_limit_(max_size), policy_(max_size) {
+    hash_index_.Reserve(max_size);
+  }
+
+  // A cache whose entries weigh at most max_weight in total. Entries that
+  // weigh more than max_entry_fraction of max_weight are rejected. The slab
+  // and hash map grow with the number of entries, and keep their size when
+  // entries are evicted, to reuse it. Only for policies that support it.
+  LRUCache(size_t max_weight, Weigher weigher, double max_entry_fraction = 1.0)
+      : weigher_(std::move(weigher)),
+        max_weight_(max_weight),
+        max_entry_fraction_(min(max_entry_fraction, 1.0)),
+        max_entry_weight_(static_cast<size_t>(max_weight * max_entry_fraction_)),
+        weight_limit_(max_weight),
+        policy_(0) {
+    static_assert(PolicyType::kSupportsWeights, "Policy can't evict by weight");
+    assert(weigher_);
+  }
+  virtual ~LRUCache() {}
+
+  // Returns the number of entries cached.
+  size_t Size() const { return hash_index_.Size(); }
+
+  // Returns the total weight of the entries cached (their number, if the
+  // cache has no Weigher).
+  size_t Weight() const { return weight_; }
+
+  // Returns the capacity, as a number of entries or as a total weight.
+  size_t MaxSize() const { return max_weight_; }
+
+  // Changes the capacity, as a number of entries or as a total weight.
+  // Doesn't evict: if the cache is now over capacity, every call that
+  // looks up or puts an entry (and Tick()) first evicts a batch of up to
+  // kShrinkBatchSize entries, the ones the policy would evict next, until
+  // it fits, and puts never add to its weight meanwhile. Growing a cache
+  // of a number of entries grows the slab now, and the hash index as it is
+  // used, see SwissIndex. Memory isn't released by shrinking.
+  void Resize(size_t max_size) {
+    max_weight_ = max_size;
+    weight_limit_ = max(max_weight_, weight_);
+    policy_.Resize(max_size);
+    if (weigher_) {
+      max_entry_weight_ = static_cast<size_t>(max_size * max_entry_fraction_);
+    } else {
+      max_entry_weight_ = max_size;
+      policy_.Grow(max_size);
+      hash_index_.Reserve(max_size);
+    }
+  }
+
+  // Returns whether the cache is still over the capacity it was resized
+  // to.
+  bool IsShrinking() const { return weight_ > max_weight_; }
+
+  // Caches value under key, as the most-recently-used item, evicting as
+  // many items as needed to make room. If key is already cached its value
+  // is updated in place, in the same node, and key is only looked up (so
+  // may be a string_view, like for Get()); a Key is only constructed from
+  // it when inserting. The entry doesn't expire, even if it had a time to
+  // live before.
+  //
+  // Returns false, and caches nothing, if the entry weighs too much. Any
+  // value already cached under key is then erased, since it is stale.
+  template <typename K>
+  bool Put(K&& key, Value value) {
+    return PutWithExpiry(std::forward<K>(key), std::move(value), kNoExpiry);
+  }
+
+  // Like Put(), but the entry expires once ttl has passed (rounded up to
+  // the millisecond).
+  template <typename K, typename Rep, typename Period>
+  bool Put(K&& key, Value value, chrono::duration<Rep, Period> ttl) {
+    uint64_t expiry = NowTicks() + chrono::ceil<chrono::milliseconds>(ttl).count();
+    return PutWithExpiry(std::forward<K>(key), std::move(value), expiry);
+  }
+
+  // Like Put(), but marks the entry dirty: its value has yet to be written
+  // to the store behind the cache, so it is written back, if there is a
+  // WriteBackQueue, when evicted or expired (but not when erased). Put(),
+  // Upsert() and MultiPut() mark the entry clean again.
+  template <typename K>
+  bool PutDirty(K&& key, Value value) {
+    return PutWithExpiry(std::forward<K>(key), std::move(value), kNoExpiry, true);
+  }
+
+  // Returns whether key is cached, and dirty.
+  template <typename K>
+  bool IsDirty(const K& key) const {
+    Index index = Find(key, Hash()(key));
+    return index != kNullIndex && !IsExpired(index) && IsDirtyAt(index);
+  }
+
+  // Like Put(), but returns the value previously cached under key, or
+  // nullopt if there wasn't one.
+  template <typename K>
+  optional<Value> Upsert(K&& key, Value value) {
+    ScopedLatency latency(record_latencies_ ? &stats_.put_latency_ : nullptr);
+    ContinueShrink();
+    size_t hash = Hash()(key);
+    if (miss_ratio_curve_) {
+      miss_ratio_curve_->RecordPut(hash);
+    }
+    Index index = FindLive(key, hash);
+    if (index != kNullIndex) {
+      Node& node = policy_.At(index);
+      size_t old_weight = Weigh(get<0>(node.contents_), get<1>(node.contents_));
+      optional<Value> previous = std::move(get<1>(node.contents_));
+      if (Update(index, std::move(value), old_weight)) {
+        SetExpiry(index, kNoExpiry);
+      }
+      return previous;
+    }
+
+    Insert(Key(std::forward<K>(key)), std::move(value), hash);
+    return nullopt;
+  }
+
+  // Removes key from the cache. Returns false if it wasn't cached.
+  template <typename K>
+  bool Erase(const K& key) {
+    Index index = FindLive(key, Hash()(key));
+    if (index == kNullIndex) {
+      return false;
+    }
+
+    Remove(index, RemovalCause::kErased);
+    return true;
+  }
+
+  // Returns a pointer to the cached value, or nullptr if key isn't cached.
+  // The pointer is only valid until the next call that modifies the cache.
+  template <typename K>
+  Value* Get(const K& key) {
+    ScopedLatency latency(record_latencies_ ? &stats_.get_latency_ : nullptr);
+    ContinueShrink();
+    policy_.RecordAccess(key);
+    size_t hash = Hash()(key);
+    if (miss_ratio_curve_) {
+      miss_ratio_curve_->RecordGet(hash);
+    }
+    Index index = FindLive(key, hash);
+    if (index != kNullIndex) {
+      ++stats_.hits_;
+      policy_.Touch(index);
+      return &get<1>(policy_.At(index).contents_);
+    }
+
+    ++stats_.misses_;
+    return nullptr;
+  }
+
+  // Returns a pointer to the cached value, as Get() does, or if key isn't
+  // cached, caches loader(key) and returns a pointer to that. If loader
+  // throws, nothing is cached. Returns nullptr if the loaded value weighs
+  // too much to cache. For concurrent callers, see
+  // ShardedCache::GetOrLoad(), which also runs loader once per miss.
+  template <typename K, typename Loader>
+  Value* GetOrLoad(const K& key, Loader&& loader) {
+    if (Value* value = Get(key)) {
+      return value;
+    }
+
+    Key owned_key(key);
+    Value value = loader(static_cast<const Key&>(owned_key));
+    if (!Put(std::move(owned_key), std::move(value))) {
+      return nullptr;
+    }
+    return Peek(key);
+  }
+
+  // What GetAsync() returns, to be co_awaited.
+  template <typename Loader>
+  class GetAwaiter {
+  public:
+    // A hit doesn't suspend.
+    bool await_ready() const noexcept { return value_.has_value(); }
+
+    // Joins the key's load, or starts it. Doesn't suspend if the loader
+    // finished without suspending.
+    bool await_suspend(coroutine_handle<> awaiter) {
+      auto [it, inserted] = cache_->async_loads_.try_emplace(*key_);
+      if (inserted) {
+        it->second = make_shared<AsyncLoad<Value>>();
+        load_ = it->second;
+        RunLoad(cache_, *key_, std::move(loader_), load_);
+        if (load_->IsDone()) {
+          return false;
+        }
+      } else {
+        load_ = it->second;
+      }
+      load_->AddWaiter(awaiter);
+      return true;
+    }
+
+    Value await_resume() { return value_ ? *std::move(value_) : load_->Result(); }
+
+  private:
+    friend class LRUCache;
+
+    GetAwaiter(LRUCache* cache, Loader&& loader) : cache_(cache), loader_(std::move(loader)) {}
+
+    LRUCache* cache_;
+    Loader loader_;
+    // The value, on a hit. Else the key, then its load.
+    optional<Value> value_;
+    optional<Key> key_;
+    shared_ptr<AsyncLoad<Value>> load_;
+  };
+
+  // Looks key up for a coroutine, to be co_awaited at once, as in
+  // co_await cache.GetAsync(key, loader), which returns a copy of the
+  // value. A hit is a Get(), and completes without suspending or
+  // allocating. A miss suspends the caller until loader(key), which must
+  // return an awaitable of a Value (a Task<Value>, say), has been awaited
+  // and its value cached. Concurrent misses on the key share one load; if
+  // it throws, nothing is cached, and every awaiter gets the exception.
+  //
+  // Awaiters are resumed inline, in the order they missed, by whoever
+  // resumes the loader once it's done (an event loop, say). Not
+  // thread-safe, like the rest of LRUCache: the cache's coroutines must all
+  // run on one thread, and it must outlive its loads.
+  template <typename K, typename Loader>
+  GetAwaiter<Loader> GetAsync(const K& key, Loader loader) {
+    GetAwaiter<Loader> awaiter(this, std::move(loader));
+    if (Value* value = Get(key)) {
+      awaiter.value_.emplace(*value);
+    } else {
+      awaiter.key_.emplace(key);
+    }
+    return awaiter;
+  }
+
+  // Returns a pointer to the cached value, like Get(), but without
+  // counting the lookup or promoting the entry.
+  template <typename K>
+  Value* Peek(const K& key) {
+    Index index = FindLive(key, Hash()(key));
+    return index != kNullIndex ? &get<1>(policy_.At(index).contents_) : nullptr;
+  }
+
+  // Looks up every key in keys, as if by Get(), writing a pointer to each
+  // value (or nullptr on a miss) to the same position in values. All of a
+  // batch's keys are hashed, and where they go in the index prefetched,
+  // then all are looked up, and their nodes prefetched, before any node is
+  // read or promoted, so the batch's cache misses overlap instead of being
+  // paid one after another. If promote is false, hits are left
+  // where they are in the policy's order. Returns the number of hits.
+  template <typename K>
+  size_t MultiGet(span<const K> keys, span<Value*> values, bool promote = true) {
+    assert(keys.size() == values.size());
+    ContinueShrink();
+    size_t num_hits = 0;
+    array<size_t, kMaxBatchSize> hashes;
+    array<Index, kMaxBatchSize> indices;
+
+    for (size_t begin = 0; begin < keys.size(); begin += kMaxBatchSize) {
+      size_t end = min(keys.size(), begin + kMaxBatchSize);
+      PrefetchIndex(keys.subspan(begin, end - begin), hashes);
+
+      // Resolve all keys to slab indices, prefetching each node.
+      for (size_t i = begin; i < end; ++i) {
+        policy_.RecordAccess(keys[i]);
+        if (miss_ratio_curve_) {
+          miss_ratio_curve_->RecordGet(hashes[i - begin]);
+        }
+        indices[i - begin] = Find(keys[i], hashes[i - begin]);
+        if (indices[i - begin] != kNullIndex) {
+          // Promoting writes the node, so prefetch it for writing.
+          __builtin_prefetch(&policy_.At(indices[i - begin]), 1);
+        }
+      }
+
+      // Read out the values, and prefetch the neighbors that promoting
+      // each node will have to relink. Removing an expired entry makes
+      // the lookups stale (the key may be repeated later in the batch),
+      // so from then on look each key up again. The whole batch is
+      // checked for expiry at one time, so a repeated key hits or misses
+      // every time; should an earlier copy still have hit the slot
+      // removed, it is made a miss, so the slot isn't promoted once free.
+      uint64_t membership_version = membership_version_;
+      uint64_t now = timer_wheel_ ? NowTicks() : 0;
+      for (size_t i = begin; i < end; ++i) {
+        Index& index = indices[i - begin];
+        if (index != kNullIndex && membership_version != membership_version_) {
+          index = Find(keys[i], hashes[i - begin]);
+        }
+        if (index != kNullIndex && IsExpired(index, now)) {
+          Remove(index, RemovalCause::kExpired);
+          for (size_t j = begin; j < i; ++j) {
+            if (indices[j - begin] == index) {
+              indices[j - begin] = kNullIndex;
+              values[j] = nullptr;
+              --num_hits;
+            }
+          }
+          index = kNullIndex;
+        }
+        if (index == kNullIndex) {
+          values[i] = nullptr;
+          continue;
+        }
+        Node& node = policy_.At(index);
+        values[i] = &get<1>(node.contents_);
+        ++num_hits;
+        if (promote) {
+          if (node.prev_ != kNullIndex) {
+            __builtin_prefetch(&policy_.At(node.prev_), 1);
+          }
+          if (node.next_ != kNullIndex) {
+            __builtin_prefetch(&policy_.At(node.next_), 1);
+          }
+        }
+      }
+
+      // Promote in key order, so the list ends up as a loop of Get()s
+      // would leave it.
+      if (promote) {
+        for (size_t i = begin; i < end; ++i) {
+          if (indices[i - begin] != kNullIndex) {
+            policy_.Touch(indices[i - begin]);
+          }
+        }
+      }
+    }
+
+    stats_.hits_ += num_hits;
+    stats_.misses_ += keys.size() - num_hits;
+    return num_hits;
+  }
+
+  // Puts every key/value pair, as if by a loop of Put(), moving from keys
+  // and values. A batch's keys are all looked up first, as by MultiGet(),
+  // prefetching the nodes of those already cached, then the batch is
+  // applied in order.
+  void MultiPut(span<Key> keys, span<Value> values) {
+    assert(keys.size() == values.size());
+    array<size_t, kMaxBatchSize> hashes;
+    array<Index, kMaxBatchSize> indices;
+
+    for (size_t begin = 0; begin < keys.size(); begin += kMaxBatchSize) {
+      size_t end = min(keys.size(), begin + kMaxBatchSize);
+      ContinueShrink();
+      PrefetchIndex(span<const Key>(keys.subspan(begin, end - begin)), hashes);
 
-  void Put(string id, int value);
-  int Get(string id);
+      for (size_t i = begin; i < end; ++i) {
+        indices[i - begin] = Find(keys[i], hashes[i - begin]);
+        if (indices[i - begin] != kNullIndex) {
+          __builtin_prefetch(&policy_.At(indices[i - begin]), 1);
+        }
+      }
 
-  int GetPositionInListForTesting(string id);
+      // The lookups above stay valid until an entry is added or removed,
+      // which may evict one of the batch's keys or add a key repeated later
+      // in the batch. From then on, Put() looks each key up again; the
+      // first pass has already pulled its group of the index into cache.
+      uint64_t membership_version = membership_version_;
+      for (size_t i = begin; i < end; ++i) {
+        Index index = indices[i - begin];
+        if (membership_version != membership_version_) {
+          Put(std::move(keys[i]), std::move(values[i]));
+          continue;
+        }
+        if (miss_ratio_curve_) {
+          miss_ratio_curve_->RecordPut(hashes[i - begin]);
+        }
+        if (index != kNullIndex) {
+          Node& node = policy_.At(index);
+          size_t old_weight = Weigh(get<0>(node.contents_), get<1>(node.contents_));
+          if (Update(index, std::move(values[i]), old_weight)) {
+            SetExpiry(index, kNoExpiry);
+          }
+        } else {
+          Insert(std::move(keys[i]), std::move(values[i]), hashes[i - begin]);
+        }
+      }
+    }
+  }
+
+  // Removes expired entries, up to max_work of them (or of the timers
+  // they are tracked by, see TimerWheel::Advance()), so the time spent
+  // is bounded. Call it periodically, entries that are looked up expire
+  // without it. Returns the number of entries removed.
+  size_t Tick(size_t max_work = kDefaultTickWork) {
+    ContinueShrink();
+    if (!timer_wheel_) {
+      return 0;
+    }
+
+    size_t num_expired = 0;
+    timer_wheel_->Advance(NowTicks(), max_work, [this, &num_expired](TimerWheel::Id index) {
+      Remove(index, RemovalCause::kExpired);
+      ++num_expired;
+    });
+    return num_expired;
+  }
+
+  // Returns a snapshot of the cache's counters, and its size and weight
+  // now.
+  CacheStats GetStats() const {
+    CacheStats stats = stats_;
+    stats.size_ = Size();
+    stats.weight_ = weight_;
+    return stats;
+  }
+
+  // Returns the bytes the cache takes, by component (see MemoryUsage):
+  // the slab's nodes and the hash index, whether used or free, each
+  // entry's key and value, with what they own on the heap (see
+  // HeapBytes()), and everything else as metadata. Walks every entry, so
+  // is for reports, not for every call. Doesn't count what a Weigher or
+  // EvictionListener owns, or a WriteBackQueue, which may be shared.
+  MemoryUsage GetMemoryUsage() const {
+    MemoryUsage usage;
+    usage.num_entries_ = Size();
+    usage.metadata_bytes_ += sizeof(*this);
+    policy_.AddMemoryUsage(usage);
+    hash_index_.AddMemoryUsage(usage, usage.index_bytes_);
+    for (size_t list = 0; list < PolicyType::NumLists(); ++list) {
+      for (Index index = policy_.GetHead(list); index != kNullIndex; index = policy_.At(index).next_) {
+        // The key and value are in the node, counted by the policy.
+        const Contents& contents = policy_.At(index).contents_;
+        usage.node_bytes_ -= sizeof(Key) + sizeof(Value);
+        usage.key_bytes_ += sizeof(Key);
+        usage.value_bytes_ += sizeof(Value);
+        usage.AddBlock(usage.key_bytes_, HeapBytes(get<0>(contents)));
+        usage.AddBlock(usage.value_bytes_, HeapBytes(get<1>(contents)));
+      }
+    }
+    usage.AddBlock(usage.metadata_bytes_, (dirty_.capacity() + 7) / 8);
+    if (timer_wheel_) {
+      usage.AddBlock(usage.metadata_bytes_, sizeof(TimerWheel));
+      timer_wheel_->AddMemoryUsage(usage, usage.metadata_bytes_);
+    }
+    if (miss_ratio_curve_) {
+      usage.AddBlock(usage.metadata_bytes_, sizeof(MissRatioCurve));
+      miss_ratio_curve_->AddMemoryUsage(usage, usage.metadata_bytes_);
+    }
+    AddHashMap(usage, usage.metadata_bytes_, async_loads_);
+    return usage;
+  }
+
+  // Turns recording Get() and Put() latencies on or off. Off by default.
+  void SetRecordLatencies(bool record_latencies) {
+    record_latencies_ = record_latencies;
+  }
+
+  // Starts estimating the hit ratio the cache would have at other
+  // capacities, from the keys looked up and put from now on, see
+  // MissRatioCurve. Replaces any estimate so far. The estimate is of an
+  // LRU cache of a number of entries, whatever the policy and Weigher.
+  void EnableMissRatioCurve(double sampling_rate = MissRatioCurve::kDefaultSamplingRate,
+                            size_t max_samples = MissRatioCurve::kDefaultMaxSamples) {
+    miss_ratio_curve_ = make_unique<MissRatioCurve>(sampling_rate, max_samples);
+  }
+
+  // Returns the estimate, or nullptr if it isn't enabled.
+  const MissRatioCurve* GetMissRatioCurve() const { return miss_ratio_curve_.get(); }
+
+  // An entry as saved in a snapshot.
+  struct SnapshotEntry {
+    Key key_;
+    Value value_;
+    bool dirty_ = false;
+    // The policy's list it was on, if it was saved by a policy with as
+    // many lists as this one.
+    optional<size_t> list_;
+  };
+
+  // Saves the cache's entries to a snapshot file at path (see
+  // snapshot.hpp), with the policy's list each is on, in order from most
+  // to least recently used, so that LoadSnapshot() can put them back as
+  // they are: an SLRU cache's protected entries come back protected, say.
+  // The policy's other state (ghost keys, frequency counts, ARC's target)
+  // isn't saved, and starts afresh. Entries with a time to live aren't
+  // saved, since their clock doesn't carry over to a restart; dirty
+  // entries stay dirty. Key and Value need a SnapshotCodec. Returns false
+  // if the file can't be written.
+  //
+  // The entries are encoded into memory before anything is written, so a
+  // ShardedCache only holds each shard's lock while encoding its entries,
+  // and keeps serving during the write.
+  bool SaveSnapshot(const string& path) const {
+    string payload;
+    size_t num_entries = EncodeSnapshot(payload);
+    return WriteSnapshotFile(path, num_entries, payload);
+  }
+
+  // Appends the cache's entries to a snapshot payload, see SaveSnapshot().
+  // For a policy with several lists, its most valuable list (the highest
+  // numbered, such as SLRU's protected segment) goes first. Returns the
+  // number of entries encoded.
+  size_t EncodeSnapshot(string& payload) const {
+    SnapshotWriter writer(payload);
+    size_t num_entries = 0;
+    for (size_t list = PolicyType::NumLists(); list-- > 0;) {
+      for (Index index = policy_.GetHead(list); index != kNullIndex; index = policy_.At(index).next_) {
+        if (timer_wheel_ && timer_wheel_->IsScheduled(index)) {
+          continue;
+        }
+        const Node& node = policy_.At(index);
+        uint8_t flags = static_cast<uint8_t>((IsDirtyAt(index) ? kSnapshotDirty : 0) | list << kSnapshotListShift |
+                                             PolicyType::NumLists() << kSnapshotNumListsShift);
+        writer.Write(&flags, sizeof(flags));
+        SnapshotCodec<Key>::Encode(get<0>(node.contents_), writer);
+        SnapshotCodec<Value>::Encode(get<1>(node.contents_), writer);
+        ++num_entries;
+      }
+    }
+    return num_entries;
+  }
+
+  // Decodes every entry of a snapshot into entries, in order. Returns
+  // false if the payload doesn't hold the entries its header says.
+  static bool DecodeSnapshot(const MappedSnapshot& snapshot, vector<SnapshotEntry>& entries) {
+    SnapshotReader reader(snapshot.Payload(), snapshot.PayloadSize());
+    entries.clear();
+    entries.resize(snapshot.NumEntries());
+    for (SnapshotEntry& entry : entries) {
+      uint8_t flags;
+      if (!reader.Read(&flags, sizeof(flags)) ||
+          !SnapshotCodec<Key>::Decode(reader, entry.key_) ||
+          !SnapshotCodec<Value>::Decode(reader, entry.value_)) {
+        return false;
+      }
+      entry.dirty_ = flags & kSnapshotDirty;
+      size_t list = (flags >> kSnapshotListShift) & kSnapshotListMask;
+      if (((flags >> kSnapshotNumListsShift) & kSnapshotListMask) == PolicyType::NumLists() &&
+          list < PolicyType::NumLists()) {
+        entry.list_ = list;
+      }
+    }
+    return reader.AtEnd();
+  }
+
+  // Loads a snapshot saved by SaveSnapshot() into the cache, which must be
+  // empty. The file is mapped rather than read, and entries are linked in
+  // directly, without a Put()'s lookup and eviction. Each goes back on the
+  // list it was saved from if the policy that saved it had as many lists
+  // as this one, and is inserted as new otherwise. If the snapshot holds
+  // more than fits, the most recently used entries of the most valuable
+  // lists are loaded. Returns
+  // false, loading nothing, if the file is missing or isn't a valid
+  // snapshot.
+  bool LoadSnapshot(const string& path) {
+    MappedSnapshot snapshot;
+    vector<SnapshotEntry> entries;
+    if (Size() != 0 || !snapshot.Open(path) || !DecodeSnapshot(snapshot, entries)) {
+      return false;
+    }
+    LoadEntries(std::move(entries));
+    return true;
+  }
+
+  // Adds entries, which are from a snapshot, most recently used first, to
+  // the cache, which must be empty. Takes as many of the first entries as
+  // fit, and moves from them. Returns the number added.
+  size_t LoadEntries(vector<SnapshotEntry>&& entries) {
+    assert(Size() == 0);
+    size_t num_entries = 0;
+    size_t weight = 0;
+    for (; num_entries < entries.size(); ++num_entries) {
+      const SnapshotEntry& entry = entries[num_entries];
+      weight += Weigh(entry.key_, entry.value_);
+      if (weight > max_weight_) {
+        break;
+      }
+    }
+
+    // Link from the least recently used, so the most recent ends up at the
+    // head of its list.
+    for (size_t i = num_entries; i-- > 0;) {
+      SnapshotEntry& entry = entries[i];
+      size_t entry_weight = Weigh(entry.key_, entry.value_);
+      if (entry_weight > max_entry_weight_) {
+        continue;
+      }
+      size_t hash = Hash()(entry.key_);
+      assert(Find(entry.key_, hash) == kNullIndex);
+      if (policy_.IsFull()) {
+        policy_.Grow(max<size_t>(kMinSlabGrowth, policy_.Capacity() * 2));
+      }
+      Contents contents(std::move(entry.key_), std::move(entry.value_));
+      Index index = entry.list_ ? policy_.Restore(std::move(contents), *entry.list_)
+                                : policy_.Insert(std::move(contents));
+      hash_index_.Insert(hash, index);
+      weight_ += entry_weight;
+      SetDirty(index, entry.dirty_);
+    }
+    ++membership_version_;
+    return Size();
+  }
+
+  // Sets the listener told of every entry removed from now on.
+  void SetEvictionListener(EvictionListener listener) {
+    listener_ = std::move(listener);
+  }
+
+  // Turns on write-back: from now on, dirty entries that are evicted or
+  // expire are moved into queue. A queue may be shared by several caches
+  // (a ShardedCache's shards, say); null turns write-back off again.
+  void SetWriteBackQueue(shared_ptr<WriteBackQueue<Key, Value>> queue) {
+    write_back_queue_ = std::move(queue);
+  }
+
+  // Queues a copy of every dirty entry for write-back, and marks them
+  // clean, so they aren't lost when the cache is destroyed, say. Returns
+  // the number of entries queued. Needs a WriteBackQueue, and a copyable
+  // Key and Value.
+  size_t WriteBackDirty() {
+    assert(write_back_queue_);
+    size_t num_queued = 0;
+    for (Index index = 0; index < dirty_.size(); ++index) {
+      if (dirty_[index]) {
+        const Node& node = policy_.At(index);
+        write_back_queue_->Push(Key(get<0>(node.contents_)), Value(get<1>(node.contents_)));
+        dirty_[index] = false;
+        ++num_queued;
+      }
+    }
+    return num_queued;
+  }
+
+  // Replaces the clock that times to live are measured by.
+  void SetClockForTesting(function<Clock::time_point()> clock) {
+    clock_ = std::move(clock);
+  }
+
+  template <typename K>
+  int GetPositionInListForTesting(const K& key) {
+    int pos = 0;
+    Index index = policy_.GetHead();
+
+    while (index != kNullIndex) {
+      const Node& node = policy_.At(index);
+      if (Eq()(get<0>(node.contents_), key)) {
+        return pos;
+      }
+      index = node.next_;
+      ++pos;
+    }
+
+    return pos;
+  }
 
 private:
-  size_t max_size_;
-  LinkList lru_list_;
-  using HashMap = unordered_map<string, shared_ptr<LinkList::Node>>;
-  unordered_map<string, shared_ptr<LinkList::Node>> hash_map_;
+  using Index = typename PolicyType::Index;
+  using Node = typename PolicyType::Node;
+  static constexpr Index kNullIndex = PolicyType::List::kNullIndex;
+  static_assert(kNullIndex == SwissIndex::kNullIndex);
+
+  // MultiGet() and MultiPut() work through their keys this many at a time.
+  static constexpr size_t kMaxBatchSize = 64;
+
+  // A weighted cache's slab starts out with at least this many slots.
+  static constexpr size_t kMinSlabGrowth = 16;
+
+  // The most entries evicted per call while shrinking, see Resize().
+  static constexpr size_t kShrinkBatchSize = 16;
+
+  // Flags of an entry in a snapshot: whether it is dirty, then the list it
+  // was on and the number of lists its policy had, 3 bits each. Snapshots
+  // from before lists were saved have neither.
+  static constexpr uint8_t kSnapshotDirty = 1;
+  static constexpr int kSnapshotListShift = 1;
+  static constexpr int kSnapshotNumListsShift = 4;
+  static constexpr size_t kSnapshotListMask = 7;
+  static_assert(PolicyType::NumLists() <= kSnapshotListMask);
+
+  // The expiry of an entry with no time to live.
+  static constexpr uint64_t kNoExpiry = numeric_limits<uint64_t>::max();
+
+  // Awaits loader(key) for GetAsync(), caches the value, and ends load
+  // with it. Ends the key's load in async_loads_ first, so awaiters that
+  // look it up again find the value, or after an exception, load again.
+  template <typename Loader>
+  static DetachedTask RunLoad(LRUCache* cache, Key key, Loader loader, shared_ptr<AsyncLoad<Value>> load) {
+    optional<Value> value;
+    try {
+      value.emplace(co_await loader(static_cast<const Key&>(key)));
+    } catch (...) {
+      cache->async_loads_.erase(key);
+      load->SetException(current_exception());
+      co_return;
+    }
+    cache->Put(key, *value);
+    cache->async_loads_.erase(key);
+    load->SetValue(*std::move(value));
+  }
+
+  // Caches value under key, expiring at tick expiry, and dirty or not,
+  // see Put() and PutDirty().
+  template <typename K>
+  bool PutWithExpiry(K&& key, Value value, uint64_t expiry, bool dirty = false) {
+    ScopedLatency latency(record_latencies_ ? &stats_.put_latency_ : nullptr);
+    ContinueShrink();
+    size_t hash = Hash()(key);
+    if (miss_ratio_curve_) {
+      miss_ratio_curve_->RecordPut(hash);
+    }
+    Index index = FindLive(key, hash);
+    if (index != kNullIndex) {
+      Node& node = policy_.At(index);
+      size_t old_weight = Weigh(get<0>(node.contents_), get<1>(node.contents_));
+      if (!Update(index, std::move(value), old_weight)) {
+        return false;
+      }
+    } else {
+      index = Insert(Key(std::forward<K>(key)), std::move(value), hash);
+      if (index == kNullIndex) {
+        return false;
+      }
+    }
+
+    SetExpiry(index, expiry);
+    if (dirty) {
+      SetDirty(index, true);
+    }
+    return true;
+  }
+
+  // Returns the current time in timer wheel ticks, which are milliseconds.
+  uint64_t NowTicks() const {
+    return chrono::duration_cast<chrono::milliseconds>(clock_().time_since_epoch()).count();
+  }
+
+  // Sets the tick that the entry at index expires at. The timer wheel is
+  // only created once an entry is given a time to live.
+  void SetExpiry(Index index, uint64_t expiry) {
+    if (expiry == kNoExpiry) {
+      if (timer_wheel_) {
+        timer_wheel_->Cancel(index);
+      }
+      return;
+    }
+
+    if (!timer_wheel_) {
+      timer_wheel_ = make_unique<TimerWheel>(NowTicks());
+      timer_wheel_->Reserve(policy_.Capacity());
+    }
+    timer_wheel_->Schedule(index, expiry);
+  }
+
+  bool IsExpired(Index index) const {
+    return timer_wheel_ && IsExpired(index, NowTicks());
+  }
+
+  // Whether the entry at index has expired by tick now.
+  bool IsExpired(Index index, uint64_t now) const {
+    return timer_wheel_ && timer_wheel_->IsScheduled(index) && timer_wheel_->GetExpiry(index) <= now;
+  }
+
+  bool IsDirtyAt(Index index) const {
+    return index < dirty_.size() && dirty_[index];
+  }
+
+  // Marks the entry at index dirty or clean. The dirty bits are only
+  // allocated once an entry is put dirty.
+  void SetDirty(Index index, bool dirty) {
+    if (index >= dirty_.size()) {
+      if (!dirty) {
+        return;
+      }
+      dirty_.resize(policy_.Capacity());
+    }
+    dirty_[index] = dirty;
+  }
+
+  // Returns the slab index of key, whose hash is hash, or kNullIndex if
+  // it isn't cached.
+  template <typename K>
+  Index Find(const K& key, size_t hash) const {
+    return hash_index_.Find(hash, [this, &key](Index index) {
+      return Eq()(get<0>(policy_.At(index).contents_), key);
+    });
+  }
+
+  // Like Find(), but if the entry has expired removes it and returns
+  // kNullIndex.
+  template <typename K>
+  Index FindLive(const K& key, size_t hash) {
+    Index index = Find(key, hash);
+    if (index != kNullIndex && IsExpired(index)) {
+      Remove(index, RemovalCause::kExpired);
+      return kNullIndex;
+    }
+    return index;
+  }
+
+  // Hashes keys into hashes, prefetching where each will be looked up.
+  template <typename K>
+  void PrefetchIndex(span<const K> keys, array<size_t, kMaxBatchSize>& hashes) const {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      hashes[i] = Hash()(keys[i]);
+      hash_index_.Prefetch(hashes[i]);
+    }
+  }
+
+  // Returns the weight of an entry, 1 if the cache has no Weigher.
+  size_t Weigh(const Key& key, const Value& value) const {
+    return weigher_ ? weigher_(key, value) : 1;
+  }
+
+  // Overwrites the value of the cached node at index, marks it clean, and
+  // promotes it. The key and the node stay as they are. If the new value
+  // weighs too much the entry is erased instead, and returns false.
+  // old_weight is what the entry weighed, in case its value has already
+  // been moved out.
+  bool Update(Index index, Value&& value, size_t old_weight) {
+    Node& node = policy_.At(index);
+    size_t weight = Weigh(get<0>(node.contents_), value);
+    if (weight > max_entry_weight_) {
+      weight_ = weight_ - old_weight + Weigh(get<0>(node.contents_), get<1>(node.contents_));
+      Remove(index, RemovalCause::kErased);
+      return false;
+    }
+
+    get<1>(node.contents_) = std::move(value);
+    SetDirty(index, false);
+    ++stats_.updates_;
+    weight_ = weight_ - old_weight + weight;
+    policy_.RecordAccess(get<0>(node.contents_));
+    policy_.Touch(index);
+
+    // If the value got heavier, older entries may have to go. This one
+    // is at the head, and fits on its own, so it stays.
+    while (weight_ > weight_limit_) {
+      Evict(get<0>(node.contents_));
+    }
+    return true;
+  }
+
+  // Inserts key, which must not already be cached and hashes to hash,
+  // evicting items as needed to make room. Returns the new entry's index,
+  // or kNullIndex if it weighs too much.
+  Index Insert(Key&& key, Value&& value, size_t hash) {
+    size_t weight = Weigh(key, value);
+    if (weight > max_entry_weight_) {
+      return kNullIndex;
+    }
+    policy_.RecordAccess(key);
+
+    // Evict until the new entry fits.
+    while (weight_ + weight > weight_limit_) {
+      Evict(key);
+    }
+
+    // With a Weigher, the slab grows on demand.
+    if (policy_.IsFull()) {
+      policy_.Grow(max<size_t>(kMinSlabGrowth, policy_.Capacity() * 2));
+    }
+
+    // Insert contents with the policy, and index its slot by key.
+    Index index = policy_.Insert(Contents(std::move(key), std::move(value)));
+    assert(index != kNullIndex);
+    hash_index_.Insert(hash, index);
+    weight_ += weight;
+    ++stats_.inserts_;
+    ++membership_version_;
+    return index;
+  }
+
+  // Evicts the item the policy chooses to make room for key.
+  void Evict(const Key& key) {
+    Index index = policy_.ChooseVictim(key);
+    assert(index != kNullIndex);
+    Remove(index, RemovalCause::kEvicted);
+  }
+
+  // If the cache is over capacity after Resize(), evicts the next batch
+  // of entries, and lowers the weight puts have to stay within to what is
+  // left.
+  void ContinueShrink() {
+    if (weight_limit_ == max_weight_) {
+      return;
+    }
+    for (size_t i = 0; i < kShrinkBatchSize && weight_ > max_weight_; ++i) {
+      Index index = policy_.ChooseVictim();
+      assert(index != kNullIndex);
+      Remove(index, RemovalCause::kEvicted);
+    }
+    weight_limit_ = max(max_weight_, weight_);
+  }
+
+  // Removes the node at index from the index and the policy's lists,
+  // cancels its expiry, and tells the listener why. If it is dirty, and
+  // evicted or expired, it is moved to the write-back queue. Otherwise
+  // its value is reset, so whatever it holds is freed now rather than
+  // when the slot is reused, and its key is left to be reused.
+  void Remove(Index index, RemovalCause cause) {
+    Node& node = policy_.At(index);
+    Key& key = get<0>(node.contents_);
+    Value& value = get<1>(node.contents_);
+    bool indexed = hash_index_.Erase(Hash()(key), index);
+    assert(indexed);
+    weight_ -= Weigh(key, value);
+    // The policy may look at the key, so remove from it before the key
+    // is moved out.
+    policy_.Remove(index, cause == RemovalCause::kEvicted);
+    if (timer_wheel_) {
+      timer_wheel_->Cancel(index);
+    }
+    ++membership_version_;
+    if (cause == RemovalCause::kEvicted) {
+      ++stats_.evictions_;
+    } else if (cause == RemovalCause::kExpired) {
+      ++stats_.expirations_;
+    }
+
+    if (listener_) {
+      listener_(key, value, cause);
+    }
+    bool dirty = IsDirtyAt(index);
+    SetDirty(index, false);
+    if (dirty && write_back_queue_ && cause != RemovalCause::kErased) {
+      write_back_queue_->Push(std::move(key), std::move(value));
+    } else {
+      value = Value();
+    }
+  }
+
+  Weigher weigher_;
+  size_t max_weight_;
+  double max_entry_fraction_ = 1.0;
+  // Entries heavier than this are rejected.
+  size_t max_entry_weight_;
+  // What puts evict down to: max_weight_, or while shrinking after
+  // Resize(), the weight still left to evict from.
+  size_t weight_limit_;
+  size_t weight_ = 0;
+  // Bumped whenever an entry is added or removed.
+  uint64_t membership_version_ = 0;
+  PolicyType policy_;
+  // Maps keys to their slots in policy_'s slab.
+  SwissIndex hash_index_;
+  // Whether each slot's entry is dirty. Empty until one is put dirty.
+  vector<bool> dirty_;
+  EvictionListener listener_;
+  shared_ptr<WriteBackQueue<Key, Value>> write_back_queue_;
+  CacheStats stats_;
+  bool record_latencies_ = false;
+  // Tracks the entries that have a time to live, by slab index. Null
+  // until the first one is put.
+  unique_ptr<TimerWheel> timer_wheel_;
+  function<Clock::time_point()> clock_ = Clock::now;
+  // Null until EnableMissRatioCurve().
+  unique_ptr<MissRatioCurve> miss_ratio_curve_;
+  // The keys being loaded by GetAsync().
+  unordered_map<Key, shared_ptr<AsyncLoad<Value>>, Hash, Eq> async_loads_;
 };
 
 #endif /* lru_cache_hpp */
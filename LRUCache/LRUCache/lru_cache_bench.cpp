@@ -0,0 +1,602 @@
+//
+//  lru_cache_bench.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "lru_cache_bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "clock_cache.hpp"
+#include "concurrent_cache.hpp"
+#include "eviction_policy.hpp"
+#include "fixed_lru.hpp"
+#include "front_cache.hpp"
+#include "link_list.hpp"
+#include "lru_cache.hpp"
+#include "memory_usage.hpp"
+#include "sharded_lru_cache.hpp"
+#include "swiss_index.hpp"
+#include "trace.hpp"
+
+using namespace std;
+
+namespace {
+
+// Returns num_keys distinct keys, cheaper to build than GetRandomItems()
+// for the sizes we benchmark with.
+vector<string> GetBenchmarkKeys(int num_keys) {
+  vector<string> keys;
+  keys.reserve(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back("key" + to_string(i));
+  }
+  return keys;
+}
+
+// Runs body(thread_index) on num_threads threads, returns the wall time
+// in seconds from when they all start until they all finish.
+template <typename Body>
+double TimeThreads(int num_threads, Body body) {
+  vector<thread> threads;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back(body, t);
+  }
+  for (thread& thread : threads) {
+    thread.join();
+  }
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Prints the header for PrintTraceResult()'s lines.
+void PrintTraceHeader() {
+  cout << setw(24) << "trace" << setw(10) << "gen sec" << setw(10) << "Mops/sec" << setw(8) << "p50"
+       << setw(8) << "p99" << setw(8) << "p999" << setw(12) << "hit ratio" << endl;
+}
+
+// Prints what replaying a trace that took generate_seconds to generate
+// (or load) measured, latencies in ns.
+void PrintTraceResult(const string& name, double generate_seconds, const TraceResult& result) {
+  cout << setw(24) << name << fixed << setprecision(2) << setw(10) << generate_seconds
+       << setw(10) << result.OpsPerSecond() / 1e6
+       << setw(8) << result.latency_.Percentile(0.5) << setw(8) << result.latency_.Percentile(0.99)
+       << setw(8) << result.latency_.Percentile(0.999)
+       << setw(12) << setprecision(4) << result.HitRatio() << endl;
+}
+
+} // namespace
+
+// Throughput of a 90% Get / 10% Put mix, from 1 to 32 threads, for one
+// shard (equivalent to an LRUCache behind a global mutex) and for many.
+void LRU_CACHE_BENCH_SHARDED_SCALING() {
+  constexpr int kNumKeys = 200000;
+  constexpr int kMaxSize = kNumKeys / 2;
+  constexpr int kOpsPerThread = 200000;
+  vector<string> keys = GetBenchmarkKeys(kNumKeys);
+
+  cout << "Sharded LRUCache scaling, Mops/sec (90% Get, 10% Put)" << endl;
+  cout << setw(8) << "threads" << setw(12) << "1 shard" << setw(12) << "64 shards" << endl;
+  for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    cout << setw(8) << num_threads;
+    for (size_t num_shards : { 1, 64 }) {
+      ShardedLRUCache<string, int> cache(kMaxSize, num_shards);
+      for (int i = 0; i < kMaxSize; ++i) {
+        cache.Put(keys[i], i);
+      }
+
+      double seconds = TimeThreads(num_threads, [&cache, &keys](int t) {
+        minstd_rand rng(t + 1);
+        for (int i = 0; i < kOpsPerThread; ++i) {
+          const string& key = keys[rng() % keys.size()];
+          if (i % 10 == 0) {
+            cache.Put(key, i);
+          } else {
+            cache.Get(key);
+          }
+        }
+      });
+      double mops = num_threads * kOpsPerThread / seconds / 1e6;
+      cout << setw(12) << fixed << setprecision(2) << mops;
+    }
+    cout << endl;
+  }
+}
+
+// Lookups/sec for batches of 128 keys, resolved by a loop of Get()s and
+// by MultiGet(), on a cache too big to fit in the CPU caches.
+void LRU_CACHE_BENCH_MULTI_GET() {
+  constexpr int kMaxSize = 1 << 20;
+  constexpr int kNumKeys = kMaxSize + kMaxSize / 10;
+  constexpr int kBatchSize = 128;
+  constexpr int kNumBatches = 20000;
+  vector<string> keys = GetBenchmarkKeys(kNumKeys);
+  LRUCache<string, int> cache(kMaxSize);
+  for (int i = 0; i < kNumKeys; ++i) {
+    cache.Put(keys[i], i);
+  }
+
+  // Every batch is random keys, about 90% of them cached.
+  minstd_rand rng(1);
+  vector<string_view> batches;
+  batches.reserve(kNumBatches * kBatchSize);
+  for (int i = 0; i < kNumBatches * kBatchSize; ++i) {
+    batches.push_back(keys[rng() % keys.size()]);
+  }
+  vector<int*> values(kBatchSize);
+
+  cout << "MultiGet vs Get loop, Mlookups/sec (batches of " << kBatchSize << ")" << endl;
+  auto report = [](const char* name, chrono::steady_clock::time_point start, size_t num_hits) {
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << setw(20) << name << setw(10) << fixed << setprecision(2)
+         << kNumBatches * kBatchSize / seconds / 1e6 << " (" << num_hits << " hits)" << endl;
+  };
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  size_t num_hits = 0;
+  for (int b = 0; b < kNumBatches; ++b) {
+    for (int i = 0; i < kBatchSize; ++i) {
+      values[i] = cache.Get(batches[b * kBatchSize + i]);
+      num_hits += values[i] != nullptr;
+    }
+  }
+  report("Get loop", start, num_hits);
+
+  start = chrono::steady_clock::now();
+  num_hits = 0;
+  for (int b = 0; b < kNumBatches; ++b) {
+    span<const string_view> batch(&batches[b * kBatchSize], kBatchSize);
+    num_hits += cache.MultiGet(batch, span<int*>(values));
+  }
+  report("MultiGet", start, num_hits);
+
+  start = chrono::steady_clock::now();
+  num_hits = 0;
+  for (int b = 0; b < kNumBatches; ++b) {
+    span<const string_view> batch(&batches[b * kBatchSize], kBatchSize);
+    num_hits += cache.MultiGet(batch, span<int*>(values), false);
+  }
+  report("MultiGet, no promote", start, num_hits);
+}
+
+// Hit ratio and throughput of CLOCK against strict LRU, on a read-through
+// workload (Get(), then Put() on a miss) where 80% of lookups go to 10% of
+// the keys. CLOCK's Get() takes its shard's lock shared.
+void LRU_CACHE_BENCH_CLOCK_VS_LRU() {
+  constexpr int kNumKeys = 200000;
+  constexpr int kMaxSize = kNumKeys / 10;
+  constexpr int kTraceLength = 1 << 20;
+  constexpr int kOpsPerThread = 200000;
+  vector<string> keys = GetBenchmarkKeys(kNumKeys);
+  Trace trace = HotspotTrace(kNumKeys, kTraceLength, 80);
+
+  auto run = [&keys, &trace](auto& cache, int t, int num_ops) {
+    size_t num_hits = 0;
+    for (int i = 0; i < num_ops; ++i) {
+      const string& key = keys[trace[(t * 7919 + i) % trace.size()].key_];
+      if (cache.Get(key)) {
+        ++num_hits;
+      } else {
+        cache.Put(key, i);
+      }
+    }
+    return num_hits;
+  };
+
+  LRUCache<string, int> lru_cache(kMaxSize);
+  ClockCache<string, int> clock_cache(kMaxSize);
+  double lru_hit_ratio = double(run(lru_cache, 0, kTraceLength)) / kTraceLength;
+  double clock_hit_ratio = double(run(clock_cache, 0, kTraceLength)) / kTraceLength;
+  cout << "CLOCK vs LRU, hit ratio " << fixed << setprecision(4)
+       << lru_hit_ratio << " (LRU) " << clock_hit_ratio << " (CLOCK)" << endl;
+
+  cout << "CLOCK vs LRU, Mops/sec (16 shards)" << endl;
+  cout << setw(8) << "threads" << setw(12) << "LRU" << setw(12) << "CLOCK" << endl;
+  for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    ShardedLRUCache<string, int> sharded_lru_cache(kMaxSize);
+    ShardedClockCache<string, int> sharded_clock_cache(kMaxSize);
+    double lru_seconds = TimeThreads(num_threads, [&](int t) { run(sharded_lru_cache, t, kOpsPerThread); });
+    double clock_seconds = TimeThreads(num_threads, [&](int t) { run(sharded_clock_cache, t, kOpsPerThread); });
+    cout << setw(8) << num_threads << fixed << setprecision(2)
+         << setw(12) << num_threads * kOpsPerThread / lru_seconds / 1e6
+         << setw(12) << num_threads * kOpsPerThread / clock_seconds / 1e6 << endl;
+  }
+}
+
+// Read scaling of a 99% Get / 1% Put mix, from 1 to 32 threads, for
+// CLOCK behind 16 shared-locked shards and for ConcurrentCache, whose
+// Get() takes no lock at all.
+void LRU_CACHE_BENCH_CONCURRENT_READS() {
+  constexpr int kNumKeys = 200000;
+  constexpr int kMaxSize = kNumKeys / 2;
+  constexpr int kOpsPerThread = 500000;
+  vector<string> keys = GetBenchmarkKeys(kNumKeys);
+
+  auto run = [&keys](auto& cache, int t) {
+    minstd_rand rng(t + 1);
+    for (int i = 0; i < kOpsPerThread; ++i) {
+      const string& key = keys[rng() % keys.size()];
+      if (i % 100 == 0) {
+        cache.Put(key, i);
+      } else {
+        cache.Get(key);
+      }
+    }
+  };
+
+  cout << "Concurrent reads, Mops/sec (99% Get, 1% Put)" << endl;
+  cout << setw(8) << "threads" << setw(16) << "16-shard CLOCK" << setw(12) << "lock-free" << endl;
+  for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+    ShardedClockCache<string, int> sharded_clock_cache(kMaxSize);
+    ConcurrentCache<string, int> concurrent_cache(kMaxSize);
+    for (int i = 0; i < kMaxSize; ++i) {
+      sharded_clock_cache.Put(keys[i], i);
+      concurrent_cache.Put(keys[i], i);
+    }
+    double clock_seconds = TimeThreads(num_threads, [&](int t) { run(sharded_clock_cache, t); });
+    double concurrent_seconds = TimeThreads(num_threads, [&](int t) { run(concurrent_cache, t); });
+    cout << setw(8) << num_threads << fixed << setprecision(2)
+         << setw(16) << num_threads * kOpsPerThread / clock_seconds / 1e6
+         << setw(12) << num_threads * kOpsPerThread / concurrent_seconds / 1e6 << endl;
+  }
+}
+
+// Reads/sec of a few hot keys (Zipf(1.2) over 100000, 1 write in 1000),
+// from a 16-shard LRUCache, and from the same with a front cache of 64
+// entries per thread.
+void LRU_CACHE_BENCH_FRONT_CACHE() {
+  constexpr uint64_t kNumKeys = 100000;
+  constexpr size_t kMaxSize = kNumKeys / 2;
+  constexpr size_t kOpsPerThread = 1000000;
+  Trace trace = ZipfTrace(kNumKeys, kOpsPerThread, 1.2);
+
+  auto run = [&trace](auto& cache) {
+    for (size_t i = 0; i < trace.size(); ++i) {
+      if (i % 1000 == 0) {
+        cache.Put(trace[i].key_, i);
+      } else {
+        cache.Get(trace[i].key_);
+      }
+    }
+  };
+
+  cout << "Hot reads, Mops/sec (Zipf(1.2), 99.9% Get)" << endl;
+  cout << setw(8) << "threads" << setw(12) << "16 shards" << setw(12) << "+ front" << setw(12) << "front hits"
+       << endl;
+  for (int num_threads = 1; num_threads <= 16; num_threads *= 4) {
+    ShardedLRUCache<uint64_t, uint64_t> sharded_cache(kMaxSize, 16);
+    FrontCache<uint64_t, uint64_t> front_cache(kMaxSize, 16);
+    for (uint64_t key = 0; key < kMaxSize; ++key) {
+      sharded_cache.Put(key, key);
+      front_cache.Put(key, key);
+    }
+    double sharded_seconds = TimeThreads(num_threads, [&](int) { run(sharded_cache); });
+    double front_seconds = TimeThreads(num_threads, [&](int) { run(front_cache); });
+    double front_hits = double(front_cache.NumFrontHits()) / (num_threads * kOpsPerThread);
+    cout << setw(8) << num_threads << fixed << setprecision(2)
+         << setw(12) << num_threads * kOpsPerThread / sharded_seconds / 1e6
+         << setw(12) << num_threads * kOpsPerThread / front_seconds / 1e6
+         << setw(11) << front_hits * 100 << "%" << endl;
+  }
+}
+
+namespace {
+
+// Runs trace through a read-through LRUCache (Get(), then Put() on a miss)
+// with Policy, and prints its hit ratio and throughput.
+template <template <typename, typename, typename> class Policy>
+void RunPolicy(const char* name, int max_size, const Trace& trace) {
+  LRUCache<uint64_t, uint64_t, LRUCacheHash<uint64_t>, equal_to<>, Policy> cache(max_size);
+  TraceResult result = RunTrace(cache, trace, false);
+  cout << setw(12) << name << setw(12) << fixed << setprecision(4) << result.HitRatio()
+       << setw(12) << setprecision(2) << result.OpsPerSecond() / 1e6 << endl;
+}
+
+} // namespace
+
+// Hit ratio and throughput of each eviction policy, on the same traces:
+// Zipf-distributed lookups with periodic scans of cold keys mixed in, and
+// lookups where 80% go to 10% of the keys.
+void LRU_CACHE_BENCH_POLICIES() {
+  constexpr int kNumKeys = 100000;
+  constexpr int kMaxSize = 5000;
+  constexpr int kTraceLength = 1 << 21;
+  Trace zipf_scan_trace = ZipfTrace(kNumKeys, kTraceLength, 0.9);
+  InterleaveScans(zipf_scan_trace, 100000, 40000, kNumKeys);
+  vector<pair<const char*, Trace>> traces;
+  traces.emplace_back("Zipf(0.9) with scans", std::move(zipf_scan_trace));
+  traces.emplace_back("80% hotspot", HotspotTrace(kNumKeys, kTraceLength, 80));
+
+  for (const auto& [trace_name, trace] : traces) {
+    cout << "Eviction policies, " << trace_name << endl;
+    cout << setw(12) << "policy" << setw(12) << "hit ratio" << setw(12) << "Mops/sec" << endl;
+    RunPolicy<LRUPolicy>("LRU", kMaxSize, trace);
+    RunPolicy<SLRUPolicy>("SLRU", kMaxSize, trace);
+    RunPolicy<TwoQPolicy>("2Q", kMaxSize, trace);
+    RunPolicy<ARCPolicy>("ARC", kMaxSize, trace);
+    RunPolicy<WTinyLFUPolicy>("W-TinyLFU", kMaxSize, trace);
+  }
+}
+
+// Lookups/sec of LRUCache's SwissIndex against the unordered_map it
+// replaced, indexing string keys at 10K, 1M and 10M entries, for lookups
+// that hit and that miss. Each maps "key<i>" to i, and lookups are in
+// random order.
+void LRU_CACHE_BENCH_HASH_INDEX() {
+  constexpr int kNumLookups = 1 << 21;
+  cout << "Hash index, Mlookups/sec" << endl;
+  cout << setw(10) << "entries" << setw(16) << "map hit" << setw(16) << "map miss"
+       << setw(16) << "swiss hit" << setw(16) << "swiss miss" << endl;
+  for (int num_keys : { 10000, 1000000, 10000000 }) {
+    vector<string> keys = GetBenchmarkKeys(num_keys);
+    minstd_rand rng(1);
+    vector<string_view> hits;
+    vector<string> misses;
+    hits.reserve(kNumLookups);
+    misses.reserve(kNumLookups);
+    for (int i = 0; i < kNumLookups; ++i) {
+      hits.push_back(keys[rng() % num_keys]);
+      misses.push_back("miss" + to_string(rng() % num_keys));
+    }
+
+    // Returns Mlookups/sec for find(key) over lookups, which must all hit
+    // or all miss.
+    auto time = [](const auto& lookups, auto find) {
+      size_t num_found = 0;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for (const auto& key : lookups) {
+        num_found += find(key);
+      }
+      double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      assert(num_found == 0 || num_found == lookups.size());
+      return lookups.size() / seconds / 1e6;
+    };
+    cout << setw(10) << num_keys << fixed << setprecision(2);
+
+    // One at a time, so the 10M entry case fits in memory.
+    {
+      unordered_map<string, uint32_t, LRUCacheHash<string>, equal_to<>> map;
+      map.reserve(num_keys);
+      for (int i = 0; i < num_keys; ++i) {
+        map.emplace(keys[i], i);
+      }
+      auto find = [&map](string_view key) { return map.find(key) != map.end(); };
+      cout << setw(16) << time(hits, find) << setw(16) << time(misses, find);
+    }
+    {
+      SwissIndex index;
+      index.Reserve(num_keys);
+      for (int i = 0; i < num_keys; ++i) {
+        index.Insert(LRUCacheHash<string>()(keys[i]), i);
+      }
+      auto find = [&index, &keys](string_view key) {
+        return index.Find(LRUCacheHash<string>()(key), [&keys, key](SwissIndex::Index i) {
+          return keys[i] == key;
+        }) != SwissIndex::kNullIndex;
+      };
+      cout << setw(16) << time(hits, find) << setw(16) << time(misses, find) << endl;
+    }
+  }
+}
+
+// Throughput, latency and hit ratio of an LRUCache of 1M entries on 10M
+// op traces over 10M keys, from each generator.
+void LRU_CACHE_BENCH_TRACES() {
+  constexpr uint64_t kNumKeys = 10000000;
+  constexpr size_t kNumOps = 10000000;
+  constexpr size_t kMaxSize = 1000000;
+  vector<pair<string, function<Trace()>>> generators = {
+    { "Zipf(0.99)", [] { return ZipfTrace(kNumKeys, kNumOps, 0.99); } },
+    { "Zipf(0.7)", [] { return ZipfTrace(kNumKeys, kNumOps, 0.7); } },
+    { "Zipf(0.99), 20% writes", [] {
+      Trace trace = ZipfTrace(kNumKeys, kNumOps, 0.99);
+      MixWrites(trace, 20);
+      return trace;
+    } },
+    { "Zipf(0.99) with scans", [] {
+      Trace trace = ZipfTrace(kNumKeys, kNumOps, 0.99);
+      InterleaveScans(trace, kMaxSize * 2, kMaxSize, kNumKeys);
+      return trace;
+    } },
+    { "80% hotspot", [] { return HotspotTrace(kNumKeys, kNumOps, 80); } },
+    { "scan loop", [] { return ScanTrace(kMaxSize + kMaxSize / 10, kNumOps); } },
+  };
+
+  cout << "Traces, LRUCache of " << kMaxSize << " entries, " << kNumOps << " ops, latency ns" << endl;
+  PrintTraceHeader();
+  for (const auto& [name, generate] : generators) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Trace trace = generate();
+    double generate_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    LRUCache<uint64_t, uint64_t> cache(kMaxSize);
+    PrintTraceResult(name, generate_seconds, RunTrace(cache, trace));
+  }
+}
+
+// The cost of estimating the miss ratio curve, at several sampling rates
+// (the best of 5 replays of a Zipf(0.99) trace each), and how close its
+// predictions at other sizes are to the hit ratios of caches that size.
+void LRU_CACHE_BENCH_MISS_RATIO_CURVE() {
+  constexpr uint64_t kNumKeys = 1000000;
+  constexpr size_t kNumOps = 10000000;
+  constexpr size_t kMaxSize = 100000;
+  Trace trace = ZipfTrace(kNumKeys, kNumOps, 0.99);
+
+  cout << "Miss ratio curve, Zipf(0.99) over " << kNumKeys << " keys, LRUCache of " << kMaxSize << " entries"
+       << endl;
+  cout << setw(12) << "sampling" << setw(12) << "Mops/sec" << setw(12) << "overhead" << endl;
+  // The rates take turns, so drifts in machine load hit them all alike.
+  constexpr double kSamplingRates[] = { 0, 0.001, 0.01, 0.1 };
+  double ops_per_second[size(kSamplingRates)] = {};
+  for (int round = 0; round < 5; ++round) {
+    for (size_t i = 0; i < size(kSamplingRates); ++i) {
+      LRUCache<uint64_t, uint64_t> cache(kMaxSize);
+      if (kSamplingRates[i] > 0) {
+        cache.EnableMissRatioCurve(kSamplingRates[i]);
+      }
+      ops_per_second[i] = max(ops_per_second[i], RunTrace(cache, trace, false).OpsPerSecond());
+    }
+  }
+  for (size_t i = 0; i < size(kSamplingRates); ++i) {
+    cout << setw(12) << (i > 0 ? to_string(kSamplingRates[i] * 100).substr(0, 4) + "%" : "off")
+         << fixed << setprecision(2) << setw(12) << ops_per_second[i] / 1e6
+         << setw(11) << (ops_per_second[0] / ops_per_second[i] - 1) * 100 << "%" << endl;
+  }
+
+  LRUCache<uint64_t, uint64_t> cache(kMaxSize);
+  cache.EnableMissRatioCurve();
+  RunTrace(cache, trace, false);
+  const MissRatioCurve* curve = cache.GetMissRatioCurve();
+  cout << "Predicted hit ratios, sampling " << setprecision(2) << curve->SamplingRate() * 100 << "% of keys"
+       << endl;
+  cout << setw(12) << "max size" << setw(12) << "predicted" << setw(12) << "actual" << endl;
+  for (size_t max_size : { 1000, 10000, 50000, 100000, 200000, 500000 }) {
+    LRUCache<uint64_t, uint64_t> sized(max_size);
+    double actual = RunTrace(sized, trace, false).HitRatio();
+    cout << setw(12) << max_size << setprecision(4) << setw(12) << curve->HitRatio(max_size) << setw(12) << actual
+         << endl;
+  }
+}
+
+namespace {
+
+// Replays a Zipf(0.9) trace over 4N keys through an LRUCache and a
+// FixedLRU of N entries (the best of 3 each), and prints their
+// throughput. Their hit ratios must match.
+template <size_t N>
+void RunFixedLRU() {
+  constexpr size_t kNumOps = 5000000;
+  Trace trace = ZipfTrace(4 * N, kNumOps, 0.9);
+  TraceResult lru_result, fixed_result;
+  for (int round = 0; round < 3; ++round) {
+    LRUCache<uint64_t, uint64_t> lru_cache(N);
+    TraceResult result = RunTrace(lru_cache, trace, false);
+    if (result.OpsPerSecond() > lru_result.OpsPerSecond()) {
+      lru_result = result;
+    }
+    FixedLRU<uint64_t, uint64_t, N> fixed_lru;
+    result = RunTrace(fixed_lru, trace, false);
+    if (result.OpsPerSecond() > fixed_result.OpsPerSecond()) {
+      fixed_result = result;
+    }
+  }
+  assert(lru_result.num_hits_ == fixed_result.num_hits_);
+  cout << setw(8) << N << fixed << setprecision(2) << setw(12) << lru_result.HitRatio() * 100 << "%"
+       << setw(12) << lru_result.OpsPerSecond() / 1e6 << setw(12) << fixed_result.OpsPerSecond() / 1e6
+       << setw(10) << sizeof(FixedLRU<uint64_t, uint64_t, N>) << endl;
+}
+
+} // namespace
+
+// LRUCache against FixedLRU, for small caches, read-through.
+void LRU_CACHE_BENCH_FIXED_LRU() {
+  cout << "Small caches, Mops/sec (Zipf(0.9) over 4x the size)" << endl;
+  cout << setw(8) << "size" << setw(13) << "hit ratio" << setw(12) << "LRUCache" << setw(12) << "FixedLRU"
+       << setw(10) << "bytes" << endl;
+  RunFixedLRU<16>();
+  RunFixedLRU<64>();
+  RunFixedLRU<256>();
+}
+
+namespace {
+
+// Prints usage's breakdown per entry, and what the heap grew by since
+// heap_bytes, per entry, where the allocator can be asked.
+void PrintMemoryUsage(const char* name, const MemoryUsage& usage, size_t heap_bytes) {
+  cout << name << ", " << usage.num_entries_ << " entries" << endl << usage.Report();
+  if (heap_bytes != 0) {
+    cout << setw(10) << "measured" << setw(26) << fixed << setprecision(1)
+         << double(HeapBytesInUse() - heap_bytes) / usage.num_entries_ << endl;
+  }
+}
+
+} // namespace
+
+// Bytes per entry of an LRUCache with string keys too long to be inline,
+// the same with SmallString keys that are, and the shared_ptr nodes of a
+// LinkList indexed by an unordered_map, as LRUCache used to be laid out.
+void LRU_CACHE_BENCH_MEMORY() {
+  constexpr int kNumItems = 1000000;
+  vector<string> keys;
+  keys.reserve(kNumItems);
+  for (int i = 0; i < kNumItems; ++i) {
+    keys.push_back("session:" + to_string(100000000000 + i));
+  }
+
+  {
+    size_t heap_bytes = HeapBytesInUse();
+    LRUCache<string, int> cache(kNumItems);
+    for (int i = 0; i < kNumItems; ++i) {
+      cache.Put(keys[i], i);
+    }
+    PrintMemoryUsage("LRUCache<string, int>", cache.GetMemoryUsage(), heap_bytes);
+  }
+  {
+    size_t heap_bytes = HeapBytesInUse();
+    LRUCache<SmallString<23>, int> cache(kNumItems);
+    for (int i = 0; i < kNumItems; ++i) {
+      cache.Put(keys[i], i);
+    }
+    PrintMemoryUsage("LRUCache<SmallString<23>, int>", cache.GetMemoryUsage(), heap_bytes);
+  }
+  {
+    size_t heap_bytes = HeapBytesInUse();
+    LinkList list;
+    unordered_map<string, shared_ptr<LinkList::Node>> index;
+    index.reserve(kNumItems);
+    for (int i = 0; i < kNumItems; ++i) {
+      list.PushHead(make_tuple(keys[i], i));
+      index.emplace(keys[i], list.GetHeadShared());
+    }
+    MemoryUsage usage = list.GetMemoryUsage();
+    AddHashMap(usage, usage.index_bytes_, index);
+    for (const auto& [key, node] : index) {
+      usage.AddBlock(usage.index_bytes_, HeapBytes(key));
+    }
+    PrintMemoryUsage("LinkList + unordered_map", usage, heap_bytes);
+  }
+}
+
+bool RUN_LRU_CACHE_TRACE_REPLAY(const string& path, size_t max_size) {
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  optional<Trace> trace = LoadTrace(path);
+  if (!trace) {
+    cerr << "Can't read trace " << path << endl;
+    return false;
+  }
+  double load_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  LRUCache<uint64_t, uint64_t> cache(max_size);
+  cout << "Replay, LRUCache of " << max_size << " entries, " << trace->size() << " ops, latency ns" << endl;
+  PrintTraceHeader();
+  PrintTraceResult(path, load_seconds, RunTrace(cache, *trace));
+  return true;
+}
+
+void RUN_LRU_CACHE_BENCHMARKS() {
+  LRU_CACHE_BENCH_SHARDED_SCALING();
+  LRU_CACHE_BENCH_MULTI_GET();
+  LRU_CACHE_BENCH_CLOCK_VS_LRU();
+  LRU_CACHE_BENCH_CONCURRENT_READS();
+  LRU_CACHE_BENCH_FRONT_CACHE();
+  LRU_CACHE_BENCH_POLICIES();
+  LRU_CACHE_BENCH_HASH_INDEX();
+  LRU_CACHE_BENCH_TRACES();
+  LRU_CACHE_BENCH_MISS_RATIO_CURVE();
+  LRU_CACHE_BENCH_FIXED_LRU();
+  LRU_CACHE_BENCH_MEMORY();
+}
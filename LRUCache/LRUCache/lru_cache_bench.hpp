@@ -0,0 +1,21 @@
+//
+//  lru_cache_bench.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef lru_cache_bench_hpp
+#define lru_cache_bench_hpp
+
+#include <cstddef>
+#include <string>
+
+extern void RUN_LRU_CACHE_BENCHMARKS();
+
+// Replays the trace recorded at path (see LoadTrace()) against an
+// LRUCache of max_size entries, and prints its throughput, latency and
+// hit ratio. Returns false if the trace can't be read.
+extern bool RUN_LRU_CACHE_TRACE_REPLAY(const std::string& path, size_t max_size);
+
+#endif /* lru_cache_bench_hpp */
@@ -7,49 +7,178 @@
 
 #include "lru_cache_test.hpp"
 #include "lru_cache.hpp"
+#include "link_list.hpp"
+#include "task.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
+namespace {
+
+// Counts every heap allocation made by the test binary, so tests can
+// assert that a code path doesn't allocate.
+size_t g_num_allocations = 0;
+
+// Runs coroutines on the calling thread, in simulated time: a coroutine
+// that awaits SleepFor(ticks) is resumed by Run() once its clock has
+// advanced that many ticks.
+class TestExecutor {
+public:
+  struct Sleep {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> sleeper) { executor_->sleepers_.emplace(wake_time_, sleeper); }
+    void await_resume() const noexcept {}
+
+    TestExecutor* executor_;
+    uint64_t wake_time_;
+  };
+
+  Sleep SleepFor(uint64_t ticks) { return { this, now_ + ticks }; }
+
+  // Resumes sleepers, earliest first, until there are none left.
+  void Run() {
+    while (!sleepers_.empty()) {
+      auto it = sleepers_.begin();
+      now_ = it->first;
+      coroutine_handle<> sleeper = it->second;
+      sleepers_.erase(it);
+      sleeper.resume();
+    }
+  }
+
+  uint64_t Now() const { return now_; }
+
+private:
+  uint64_t now_ = 0;
+  multimap<uint64_t, coroutine_handle<>> sleepers_;
+};
+
+// Loads key * 10, taking latency ticks, or throws for a negative key.
+Task<int> SlowLoad(TestExecutor& executor, int key, uint64_t latency, int& num_loads) {
+  ++num_loads;
+  co_await executor.SleepFor(latency);
+  if (key < 0) {
+    throw runtime_error("no such key");
+  }
+  co_return key * 10;
+}
+
+Task<int> ImmediateLoad(int key) {
+  co_return key * 10;
+}
+
+// Sleeps for delay ticks, then returns cache.GetAsync(key, loader).
+template <typename Loader>
+Task<int> GetAfter(TestExecutor& executor, uint64_t delay, LRUCache<int, int>& cache, int key, Loader loader) {
+  if (delay > 0) {
+    co_await executor.SleepFor(delay);
+  }
+  co_return co_await cache.GetAsync(key, std::move(loader));
+}
+
+bool Threw(Task<int>& task) {
+  try {
+    task.Result();
+  } catch (const runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+// The array forms call these, so are counted too; over-aligned types
+// (such as a ShardedCache's shards) get the aligned forms below. None
+// are inlined: inlined, GCC pairs the free() with the call to operator
+// new, and warns of a mismatch (-Wmismatched-new-delete).
+__attribute__((noinline)) void* operator new(size_t size) {
+  ++g_num_allocations;
+  if (void* p = malloc(size)) {
+    return p;
+  }
+  throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+__attribute__((noinline)) void* operator new(size_t size, align_val_t alignment) {
+  ++g_num_allocations;
+  // aligned_alloc() takes a multiple of the alignment.
+  size_t align = static_cast<size_t>(alignment);
+  if (void* p = aligned_alloc(align, (max<size_t>(size, 1) + align - 1) / align * align)) {
+    return p;
+  }
+  throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p, align_val_t) noexcept {
+  free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t, align_val_t) noexcept {
+  free(p);
+}
+
 void LRU_CACHE_TEST_TWO_ITEMS() {
   // Cache with a max of two items.
   int kMaxNumItems = 2;
-  LRUCache cache(kMaxNumItems);
+  LRUCache<string, int> cache(kMaxNumItems);
 
   // Insert.
   cache.Put("rose", 10);
 
   // Verify that a lookup of "rose" gives us a value of 10.
-  int value = cache.Get("rose");
-  assert(value == 10);
+  int* value = cache.Get("rose");
+  assert(value && *value == 10);
 
   // Insert one more, both values present.
   cache.Put("mars", 20);
   value = cache.Get("rose");
-  assert(value == 10);
+  assert(value && *value == 10);
   value = cache.Get("mars");
-  assert(value == 20);
+  assert(value && *value == 20);
 
   // Insert one more, values for "mars" and "zara" are now present
   // but not "rose," who should have been purged as the LRU item.
   cache.Put("zara", 30);
   value = cache.Get("mars");
-  assert(value == 20);
+  assert(value && *value == 20);
   value = cache.Get("zara");
-  assert(value == 30);
+  assert(value && *value == 30);
   value = cache.Get("rose");
-  assert(value == -1);
+  assert(!value);
 }
 
 void LRU_CACHE_TEST_MANY_ITEMS() {
   // Cache with a bunch of random items.
   int kMaxNumItems = 10000;
-  LRUCache cache(kMaxNumItems);
+  LRUCache<string, int> cache(kMaxNumItems);
   vector<LinkList::Node::Contents> many_items = LinkList::Node::GetRandomItems(kMaxNumItems);
 
   // Insert them all.
-  for (int i = 0; i < many_items.size(); ++i) {
+  for (size_t i = 0; i < many_items.size(); ++i) {
 //    cout << "item " << i << ": id " << get<0>(many_items[i]) << " value " << get<1>(many_items[i]) << endl;
     cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
   }
@@ -57,9 +186,10 @@ void LRU_CACHE_TEST_MANY_ITEMS() {
   for (int i = 0; i < kMaxNumItems/2; ++i) {
     // Get the list-position of a random node in the cache, that's not
     // already 0 (at the MRU position).
-    string id = get<0>(many_items[rand()%kMaxNumItems]);
+    string id;
     int pos = 0;
     while (pos == 0) {
+      id = get<0>(many_items[rand()%kMaxNumItems]);
       pos = cache.GetPositionInListForTesting(id);
     }
     assert(pos > 0);
@@ -71,7 +201,742 @@ void LRU_CACHE_TEST_MANY_ITEMS() {
   }
 }
 
+void LRU_CACHE_TEST_PUT_EXISTING() {
+  LRUCache<string, int> cache(2);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+
+  // Putting "rose" again updates its value in place and makes it the MRU
+  // item, without using up another slot.
+  int* rose = cache.Get("rose");
+  cache.Get("mars");
+  cache.Put("rose", 11);
+  assert(cache.Size() == 2);
+  assert(cache.Get("rose") == rose);
+  assert(*rose == 11);
+  assert(cache.GetPositionInListForTesting("rose") == 0);
+  assert(cache.GetPositionInListForTesting("mars") == 1);
+
+  // "mars" is now the LRU item, and is the one purged.
+  cache.Put("zara", 30);
+  assert(!cache.Get("mars"));
+  assert(*cache.Get("rose") == 11);
+  assert(*cache.Get("zara") == 30);
+}
+
+void LRU_CACHE_TEST_UPSERT() {
+  LRUCache<string, unique_ptr<string>> cache(2);
+
+  // Upserting a new key returns nothing.
+  assert(cache.Upsert("rose", make_unique<string>("red")) == nullopt);
+  assert(cache.Upsert("mars", make_unique<string>("red")) == nullopt);
+
+  // Upserting a cached key returns the previous value, moved out, and
+  // promotes the key.
+  string* red = cache.Get("rose")->get();
+  optional<unique_ptr<string>> previous = cache.Upsert("rose", make_unique<string>("pink"));
+  assert(previous && previous->get() == red);
+  assert(**cache.Get("rose") == "pink");
+  assert(cache.Size() == 2);
+
+  // "mars" is the LRU item, and is purged.
+  assert(cache.Upsert("zara", make_unique<string>("blue")) == nullopt);
+  assert(!cache.Get("mars"));
+
+  // Updating a long key allocates nothing, the cached key is kept as is.
+  LRUCache<string, int> counters(2);
+  string long_id(64, 'r');
+  counters.Put(long_id, 0);
+  size_t num_allocations = g_num_allocations;
+  for (int i = 1; i <= 10; ++i) {
+    assert(counters.Upsert(string_view(long_id), i) == i - 1);
+  }
+  assert(g_num_allocations == num_allocations);
+}
+
+void LRU_CACHE_TEST_NO_ALLOCATIONS() {
+  int kMaxNumItems = 1000;
+  LRUCache<string, int> cache(kMaxNumItems);
+  vector<LinkList::Node::Contents> many_items = LinkList::Node::GetRandomItems(kMaxNumItems * 3);
+
+  // Fill the cache.
+  for (int i = 0; i < kMaxNumItems; ++i) {
+    cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
+  }
+
+  // Once full, Put() recycles the evicted slot and Get() only relinks,
+  // neither of them should allocate.
+  size_t num_allocations = g_num_allocations;
+  for (size_t i = kMaxNumItems; i < many_items.size(); ++i) {
+    const string& id = get<0>(many_items[i]);
+    cache.Put(id, get<1>(many_items[i]));
+    assert(*cache.Get(id) == get<1>(many_items[i]));
+    assert(!cache.Get(get<0>(many_items[i - kMaxNumItems])));
+  }
+  assert(g_num_allocations == num_allocations);
+}
+
+void LRU_CACHE_TEST_SMALL_STRING_KEYS() {
+  constexpr int kMaxNumItems = 1000;
+  vector<string> ids;
+  for (int i = 0; i < kMaxNumItems * 2; ++i) {
+    ids.push_back("customer-" + to_string(1000000000 + i));
+  }
+
+  // Once full, caching a 20-char key copies it into the evicted slot,
+  // which allocates for a string (past its 15-char small string
+  // optimization) but not for a SmallString<23>, which holds it inline.
+  LRUCache<string, int> strings(kMaxNumItems);
+  LRUCache<SmallString<23>, int> small_strings(kMaxNumItems);
+  for (int i = 0; i < kMaxNumItems; ++i) {
+    strings.Put(string_view(ids[i]), i);
+    small_strings.Put(ids[i], i);
+  }
+  size_t num_allocations = g_num_allocations;
+  for (int i = kMaxNumItems; i < kMaxNumItems * 2; ++i) {
+    small_strings.Put(ids[i], i);
+    assert(*small_strings.Get(ids[i]) == i);
+  }
+  assert(g_num_allocations == num_allocations);
+  for (int i = kMaxNumItems; i < kMaxNumItems * 2; ++i) {
+    strings.Put(string_view(ids[i]), i);
+  }
+  assert(g_num_allocations == num_allocations + kMaxNumItems);
+}
+
+void LRU_CACHE_TEST_HETEROGENEOUS_LOOKUP() {
+  LRUCache<string, int> cache(2);
+  string long_id(64, 'r');
+  cache.Put(long_id, 10);
+
+  // Looking up by string_view or literal doesn't build a temporary
+  // string, even for a key too long for the small string optimization.
+  size_t num_allocations = g_num_allocations;
+  string_view long_id_view(long_id);
+  assert(*cache.Get(long_id_view) == 10);
+  assert(!cache.Get(string_view("mars")));
+  assert(!cache.Get("zara"));
+  assert(g_num_allocations == num_allocations);
+}
+
+void LRU_CACHE_TEST_MOVE_ONLY_VALUES() {
+  LRUCache<int, unique_ptr<string>> cache(2);
+  cache.Put(1, make_unique<string>("rose"));
+  cache.Put(2, make_unique<string>("mars"));
+
+  // Values are moved in, and Get() points at the cached value itself.
+  unique_ptr<string>* value = cache.Get(1);
+  assert(value && **value == "rose");
+  string* rose = value->get();
+  assert(cache.Get(1)->get() == rose);
+
+  // Evicting 2 destroys its value, replacing 1 moves in the new one.
+  cache.Put(3, make_unique<string>("zara"));
+  assert(!cache.Get(2));
+  cache.Put(1, make_unique<string>("rosa"));
+  assert(**cache.Get(1) == "rosa");
+  assert(**cache.Get(3) == "zara");
+  assert(cache.Size() == 2);
+}
+
+void LRU_CACHE_TEST_MULTI_GET() {
+  constexpr int kMaxNumItems = 100;
+  LRUCache<string, int> scalar_cache(kMaxNumItems);
+  LRUCache<string, int> batch_cache(kMaxNumItems);
+  vector<LinkList::Node::Contents> many_items = LinkList::Node::GetRandomItems(kMaxNumItems * 2);
+  for (int i = 0; i < kMaxNumItems; ++i) {
+    scalar_cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
+    batch_cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
+  }
+
+  // A batch bigger than one prefetch batch, with hits, misses and
+  // repeated keys.
+  vector<string_view> ids;
+  for (int i = 0; i < 300; ++i) {
+    ids.push_back(get<0>(many_items[rand() % many_items.size()]));
+  }
+
+  // MultiGet() finds the same values as a loop of Get()s, and leaves the
+  // LRU list in the same order.
+  vector<int*> values(ids.size());
+  size_t num_hits = batch_cache.MultiGet(span<const string_view>(ids), span<int*>(values));
+  size_t num_scalar_hits = 0;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    int* value = scalar_cache.Get(ids[i]);
+    assert((value == nullptr) == (values[i] == nullptr));
+    if (value) {
+      assert(*value == *values[i]);
+      ++num_scalar_hits;
+    }
+  }
+  assert(num_hits == num_scalar_hits);
+  for (const LinkList::Node::Contents& item : many_items) {
+    assert(batch_cache.GetPositionInListForTesting(get<0>(item)) ==
+           scalar_cache.GetPositionInListForTesting(get<0>(item)));
+  }
+
+  // Without promotion, the values are the same and the order unchanged.
+  vector<int> positions;
+  for (const LinkList::Node::Contents& item : many_items) {
+    positions.push_back(batch_cache.GetPositionInListForTesting(get<0>(item)));
+  }
+  vector<int*> unpromoted_values(ids.size());
+  batch_cache.MultiGet(span<const string_view>(ids), span<int*>(unpromoted_values), false);
+  assert(unpromoted_values == values);
+  for (size_t i = 0; i < many_items.size(); ++i) {
+    assert(batch_cache.GetPositionInListForTesting(get<0>(many_items[i])) == positions[i]);
+  }
+}
+
+void LRU_CACHE_TEST_MULTI_PUT() {
+  constexpr int kMaxNumItems = 100;
+  LRUCache<string, int> scalar_cache(kMaxNumItems);
+  LRUCache<string, int> batch_cache(kMaxNumItems);
+  vector<LinkList::Node::Contents> many_items = LinkList::Node::GetRandomItems(kMaxNumItems * 2);
+  for (int i = 0; i < kMaxNumItems / 2; ++i) {
+    scalar_cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
+    batch_cache.Put(get<0>(many_items[i]), get<1>(many_items[i]));
+  }
+
+  // A batch of updates, inserts that evict, and keys repeated within it.
+  vector<string> ids;
+  vector<int> values;
+  for (int i = 0; i < 300; ++i) {
+    ids.push_back(get<0>(many_items[rand() % many_items.size()]));
+    values.push_back(i);
+  }
+  for (size_t i = 0; i < ids.size(); ++i) {
+    scalar_cache.Put(ids[i], values[i]);
+  }
+  batch_cache.MultiPut(span<string>(ids), span<int>(values));
+
+  // Both caches hold the same values in the same order.
+  assert(batch_cache.Size() == scalar_cache.Size());
+  for (const LinkList::Node::Contents& item : many_items) {
+    const string& id = get<0>(item);
+    assert(batch_cache.GetPositionInListForTesting(id) == scalar_cache.GetPositionInListForTesting(id));
+    int* value = scalar_cache.Get(id);
+    int* batch_value = batch_cache.Get(id);
+    assert((value == nullptr) == (batch_value == nullptr));
+    assert(!value || *value == *batch_value);
+  }
+}
+
+void LRU_CACHE_TEST_WEIGHTED() {
+  // Entries weigh their key plus value length, at most 100 in all, and
+  // no entry may weigh more than half of that.
+  LRUCache<string, string> cache(100, [](const string& key, const string& value) {
+    return key.size() + value.size();
+  }, 0.5);
+  assert(cache.Size() == 0);
+  assert(cache.Weight() == 0);
+
+  // Three entries of 30 fit, a fourth evicts the LRU one.
+  assert(cache.Put("rose", string(26, 'r')));
+  assert(cache.Put("mars", string(26, 'm')));
+  assert(cache.Put("zara", string(26, 'z')));
+  assert(cache.Weight() == 90);
+  assert(cache.Put("luna", string(26, 'l')));
+  assert(cache.Size() == 3);
+  assert(cache.Weight() == 90);
+  assert(!cache.Get("rose"));
+
+  // A 50 entry needs 40 freed, so evicts the two LRU entries.
+  cache.Get("mars");
+  assert(cache.Put("vega", string(46, 'v')));
+  assert(cache.Size() == 2);
+  assert(cache.Weight() == 80);
+  assert(!cache.Get("zara"));
+  assert(!cache.Get("luna"));
+  assert(cache.Get("mars"));
+
+  // A 51 entry is rejected, and nothing is evicted.
+  assert(!cache.Put("nova", string(47, 'n')));
+  assert(!cache.Get("nova"));
+  assert(cache.Size() == 2);
+  assert(cache.Weight() == 80);
+
+  // Growing "mars" by 20 fills the cache, and promotes it, so another
+  // entry evicts "vega".
+  assert(cache.Put("mars", string(46, 'm')));
+  assert(cache.Size() == 2);
+  assert(cache.Weight() == 100);
+  assert(cache.Put("luna", string(6, 'l')));
+  assert(!cache.Get("vega"));
+  assert(cache.Size() == 2);
+  assert(cache.Weight() == 60);
+
+  // Growing "mars" past the entry limit erases it, rather than leave it
+  // stale.
+  assert(cache.Upsert("mars", string(60, 'm')) == string(46, 'm'));
+  assert(!cache.Get("mars"));
+  assert(cache.Size() == 1);
+  assert(cache.Weight() == 10);
+
+  // The slab grows as needed.
+  for (int i = 0; i < 20; ++i) {
+    assert(cache.Put(to_string(i), ""));
+  }
+  assert(cache.Size() == 21);
+  assert(cache.Weight() == 40);
+  assert(cache.Erase("0"));
+  assert(!cache.Erase("0"));
+  assert(cache.Size() == 20);
+  assert(cache.Weight() == 39);
+}
+
+void LRU_CACHE_TEST_EVICTED_VALUES_FREED() {
+  LRUCache<string, shared_ptr<int>> cache(2);
+  shared_ptr<int> rose = make_shared<int>(10);
+  weak_ptr<int> weak_rose = rose;
+  cache.Put("rose", std::move(rose));
+  cache.Put("mars", make_shared<int>(20));
+
+  // Evicting "rose" frees its value right away.
+  cache.Put("zara", make_shared<int>(30));
+  assert(weak_rose.expired());
+
+  // So does erasing.
+  weak_ptr<int> weak_mars = *cache.Get("mars");
+  assert(cache.Erase("mars"));
+  assert(weak_mars.expired());
+}
+
+void LRU_CACHE_TEST_TTL() {
+  LRUCache<string, int> cache(10);
+  chrono::steady_clock::time_point now;
+  cache.SetClockForTesting([&now]() { return now; });
+  cache.Put("rose", 10, chrono::milliseconds(100));
+  cache.Put("mars", 20, chrono::seconds(1));
+  cache.Put("zara", 30);
+
+  // Entries are live right up to their expiry.
+  now += chrono::milliseconds(99);
+  assert(*cache.Get("rose") == 10);
+  now += chrono::milliseconds(1);
+  assert(cache.Get("rose") == nullptr);
+  assert(cache.Size() == 2);
+
+  // Expired entries that aren't looked up are left to Tick().
+  now += chrono::seconds(1);
+  assert(cache.Size() == 2);
+  assert(cache.Tick() == 1);
+  assert(cache.Size() == 1);
+  assert(*cache.Get("zara") == 30);
+
+  // Putting without a time to live makes an entry permanent again.
+  cache.Put("rose", 11, chrono::milliseconds(100));
+  cache.Put("rose", 12);
+  now += chrono::hours(1);
+  assert(cache.Tick() == 0);
+  assert(*cache.Get("rose") == 12);
+
+  // MultiGet misses on expired entries, even when repeated.
+  cache.Put("mars", 21, chrono::milliseconds(1));
+  now += chrono::milliseconds(1);
+  vector<string_view> keys = {"mars", "rose", "mars"};
+  vector<int*> values(keys.size());
+  cache.MultiGet(span<const string_view>(keys), span<int*>(values));
+  assert(values[0] == nullptr && *values[1] == 12 && values[2] == nullptr);
+  assert(cache.Size() == 2);
+}
+
+void LRU_CACHE_TEST_MULTI_GET_EXPIRES_MID_BATCH() {
+  // A clock that ticks on every read, so with one of these times to live a
+  // repeated key's entry expires between its copies, if the batch reads
+  // the time for each.
+  constexpr int kMaxNumItems = 8;
+  for (int ttl = 1; ttl <= 8; ++ttl) {
+    LRUCache<int, int> cache(kMaxNumItems);
+    chrono::steady_clock::time_point now;
+    cache.SetClockForTesting([&now]() { return now += chrono::milliseconds(1); });
+    cache.Put(1, 10, chrono::milliseconds(ttl));
+    cache.Put(3, 30);
+
+    // Both copies of 1 hit, or both miss.
+    vector<int> keys = {1, 3, 1};
+    vector<int*> values(keys.size());
+    size_t num_hits = cache.MultiGet(span<const int>(keys), span<int*>(values));
+    assert((values[0] == nullptr) == (values[2] == nullptr));
+    assert(*values[1] == 30);
+    assert(num_hits == (values[0] ? 3 : 1));
+
+    // Every entry is still in the list, once.
+    for (int i = 0; i < 20; ++i) {
+      cache.Put(100 + i, i);
+    }
+    assert(cache.Size() == kMaxNumItems);
+    assert(cache.GetPositionInListForTesting(-1) == kMaxNumItems);
+  }
+}
+
+void LRU_CACHE_TEST_TTL_BOUNDED_TICK() {
+  LRUCache<int, int> cache(100);
+  chrono::steady_clock::time_point now;
+  cache.SetClockForTesting([&now]() { return now; });
+  for (int i = 0; i < 100; ++i) {
+    cache.Put(i, i, chrono::milliseconds(10 + i));
+  }
+
+  // Each Tick() expires no more than it is allowed to (some of its work
+  // may go to moving timers down the wheel instead).
+  now += chrono::seconds(1);
+  size_t num_expired = 0;
+  for (int i = 0; i < 100 && num_expired < 100; ++i) {
+    size_t n = cache.Tick(10);
+    assert(n <= 10);
+    num_expired += n;
+  }
+  assert(num_expired == 100);
+  assert(cache.Size() == 0);
+
+  // Slots of expired entries are reused, without their old timers.
+  cache.Put(1, 1);
+  now += chrono::hours(1);
+  assert(cache.Tick() == 0);
+  assert(*cache.Get(1) == 1);
+}
+
+void LRU_CACHE_TEST_EVICTION_LISTENER() {
+  LRUCache<string, int> cache(2);
+  chrono::steady_clock::time_point now;
+  cache.SetClockForTesting([&now]() { return now; });
+  vector<tuple<string, int, RemovalCause>> removed;
+  cache.SetEvictionListener([&removed](const string& key, const int& value, RemovalCause cause) {
+    removed.emplace_back(key, value, cause);
+  });
+
+  // Overwriting a value isn't a removal.
+  cache.Put("rose", 10);
+  cache.Put("rose", 11);
+  cache.Put("mars", 20, chrono::milliseconds(10));
+  assert(removed.empty());
+
+  cache.Put("zara", 30);
+  assert(removed.size() == 1);
+  assert(removed[0] == make_tuple(string("rose"), 11, RemovalCause::kEvicted));
+
+  now += chrono::milliseconds(10);
+  assert(cache.Tick() == 1);
+  assert(removed.size() == 2);
+  assert(removed[1] == make_tuple(string("mars"), 20, RemovalCause::kExpired));
+
+  assert(cache.Erase("zara"));
+  assert(removed.size() == 3);
+  assert(removed[2] == make_tuple(string("zara"), 30, RemovalCause::kErased));
+}
+
+void LRU_CACHE_TEST_WRITE_BACK() {
+  vector<pair<string, int>> written;
+  shared_ptr<WriteBackQueue<string, int>> queue = make_shared<WriteBackQueue<string, int>>(
+      [&written](span<pair<string, int>> batch) {
+        for (pair<string, int>& entry : batch) {
+          written.push_back(std::move(entry));
+        }
+      }, 16);
+  LRUCache<string, int> cache(2);
+  cache.SetWriteBackQueue(queue);
+
+  // Clean entries are dropped on eviction, dirty ones written back.
+  cache.Put("rose", 10);
+  cache.PutDirty("mars", 20);
+  assert(!cache.IsDirty("rose") && cache.IsDirty("mars"));
+  cache.Put("zara", 30);
+  cache.Put("lily", 40);
+  queue->Flush();
+  assert((written == vector<pair<string, int>>({{"mars", 20}})));
+
+  // Erased dirty entries aren't, nor ones overwritten clean.
+  cache.PutDirty("zara", 31);
+  assert(cache.Erase("zara"));
+  cache.PutDirty("lily", 41);
+  cache.Put("lily", 42);
+  assert(!cache.IsDirty("lily"));
+  cache.PutDirty("rose", 11);
+  cache.Put("mars", 21);
+  cache.Put("zara", 32);
+  queue->Flush();
+  assert((written == vector<pair<string, int>>({{"mars", 20}, {"rose", 11}})));
+
+  // WriteBackDirty() writes back what is still cached, and leaves it clean.
+  cache.PutDirty("mars", 22);
+  assert(cache.WriteBackDirty() == 1);
+  assert(!cache.IsDirty("mars"));
+  assert(*cache.Get("mars") == 22);
+  assert(cache.WriteBackDirty() == 0);
+  queue->Flush();
+  assert(written.size() == 3 && written[2] == make_pair(string("mars"), 22));
+}
+
+void LRU_CACHE_TEST_STATS() {
+  LRUCache<string, int> cache(2);
+  chrono::steady_clock::time_point now;
+  cache.SetClockForTesting([&now]() { return now; });
+  cache.Put("rose", 10);
+  cache.Put("rose", 11);
+  cache.Upsert("mars", 20);
+  cache.Put("zara", 30, chrono::milliseconds(1));
+  assert(cache.Get("rose") == nullptr);
+  assert(*cache.Get("mars") == 20);
+  now += chrono::milliseconds(1);
+  assert(cache.Get("zara") == nullptr);
+  vector<string_view> keys = {"mars", "lily"};
+  vector<int*> values(keys.size());
+  cache.MultiGet(span<const string_view>(keys), span<int*>(values));
+
+  CacheStats stats = cache.GetStats();
+  assert(stats.hits_ == 2 && stats.misses_ == 3);
+  assert(stats.inserts_ == 3 && stats.updates_ == 1);
+  assert(stats.evictions_ == 1 && stats.expirations_ == 1);
+  assert(stats.size_ == 1 && stats.weight_ == 1);
+
+  // Latencies are only recorded when asked for.
+  assert(stats.get_latency_.Count() == 0 && stats.put_latency_.Count() == 0);
+  cache.SetRecordLatencies(true);
+  cache.Get("mars");
+  cache.Put("lily", 40);
+  stats = cache.GetStats();
+  assert(stats.get_latency_.Count() == 1 && stats.put_latency_.Count() == 1);
+}
+
+void LRU_CACHE_TEST_SNAPSHOT() {
+  string path = "/tmp/lru_cache_test_snapshot";
+  LRUCache<string, int> cache(4);
+  chrono::steady_clock::time_point now;
+  cache.SetClockForTesting([&now]() { return now; });
+  cache.Put("rose", 10);
+  cache.PutDirty("mars", 20);
+  cache.Put("zara", 30, chrono::hours(1));
+  cache.Put("lily", 40);
+  cache.Get("rose");
+  assert(cache.SaveSnapshot(path));
+
+  // The loaded cache has the same entries in the same order, other than
+  // those with a time to live, and the same dirty ones.
+  LRUCache<string, int> loaded(4);
+  assert(loaded.LoadSnapshot(path));
+  assert(loaded.Size() == 3);
+  assert(loaded.GetPositionInListForTesting("rose") == 0);
+  assert(loaded.GetPositionInListForTesting("lily") == 1);
+  assert(loaded.GetPositionInListForTesting("mars") == 2);
+  assert(loaded.Get("zara") == nullptr);
+  assert(loaded.IsDirty("mars") && !loaded.IsDirty("rose"));
+  assert(*loaded.Get("lily") == 40);
+
+  // Only into an empty cache.
+  assert(!loaded.LoadSnapshot(path));
+
+  // A smaller cache gets the most recently used entries.
+  LRUCache<string, int> small(2);
+  assert(small.LoadSnapshot(path));
+  assert(small.Size() == 2);
+  assert(small.Get("mars") == nullptr);
+  assert(*small.Get("rose") == 10);
+
+  // So does a weighted one.
+  LRUCache<string, int> weighted(5, [](const string& key, const int&) { return key.size(); });
+  assert(weighted.LoadSnapshot(path));
+  assert(weighted.Size() == 1 && weighted.Weight() == 4);
+  assert(*weighted.Get("rose") == 10);
+
+  // Other policies load, too, inserting the entries as new.
+  LRUCache<string, int, LRUCacheHash<string>, equal_to<>, SLRUPolicy> slru(4);
+  assert(slru.LoadSnapshot(path));
+  assert(slru.Size() == 3);
+  remove(path.c_str());
+  assert(!slru.LoadSnapshot(path));
+
+  // Entries go back on the lists they were saved from: protected ones
+  // survive a scan after the restart, as they would have before it.
+  LRUCache<string, int, LRUCacheHash<string>, equal_to<>, SLRUPolicy> saved(4);
+  for (const char* key : { "rose", "mars", "zara", "lily" }) {
+    saved.Put(key, 10);
+  }
+  saved.Get("rose");
+  saved.Get("mars");
+  assert(saved.SaveSnapshot(path));
+  LRUCache<string, int, LRUCacheHash<string>, equal_to<>, SLRUPolicy> restored(4);
+  assert(restored.LoadSnapshot(path));
+  for (const char* key : { "kiwi", "fig", "lime", "pear" }) {
+    restored.Put(key, 20);
+  }
+  assert(restored.Peek("rose") && restored.Peek("mars"));
+  assert(!restored.Peek("zara") && !restored.Peek("lily"));
+  remove(path.c_str());
+}
+
+void LRU_CACHE_TEST_GET_OR_LOAD() {
+  LRUCache<string, int> cache(2);
+  int num_loads = 0;
+  auto loader = [&num_loads](const string& key) {
+    ++num_loads;
+    return int(key.size());
+  };
+  assert(*cache.GetOrLoad("rose", loader) == 4);
+  assert(*cache.GetOrLoad(string_view("rose"), loader) == 4);
+  assert(num_loads == 1);
+
+  // A loader that throws caches nothing.
+  bool thrown = false;
+  try {
+    cache.GetOrLoad("mars", [](const string&) -> int { throw runtime_error("no mars"); });
+  } catch (const runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert(cache.Size() == 1);
+  assert(*cache.GetOrLoad("mars", loader) == 4);
+  assert(num_loads == 2);
+}
+
+void LRU_CACHE_TEST_RESIZE() {
+  LRUCache<int, int> cache(100);
+  for (int i = 0; i < 100; ++i) {
+    cache.Put(i, i);
+  }
+
+  // Shrinking evicts nothing at once, then a batch of 16 LRU entries
+  // per call, until the cache fits.
+  cache.Resize(20);
+  assert(cache.MaxSize() == 20);
+  assert(cache.Size() == 100);
+  assert(cache.IsShrinking());
+  assert(*cache.Get(99) == 99);
+  assert(cache.Size() == 84);
+  assert(!cache.Peek(15) && *cache.Peek(16) == 16);
+
+  // A put meanwhile evicts one more, to add no weight.
+  assert(cache.Put(1000, 1000));
+  assert(cache.Size() == 68);
+  assert(!cache.Peek(32));
+  size_t num_calls = 2;
+  while (cache.IsShrinking()) {
+    cache.Tick();
+    ++num_calls;
+  }
+  assert(num_calls == 5);
+  assert(cache.Size() == 20);
+  assert(cache.Peek(99) && cache.Peek(1000) && cache.Peek(81) && !cache.Peek(80));
+  assert(cache.GetStats().evictions_ == 81);
+
+  // Growing makes room at once, without evicting.
+  cache.Resize(300);
+  for (int i = 0; i < 280; ++i) {
+    cache.Put(2000 + i, i);
+  }
+  assert(cache.Size() == 300);
+  assert(cache.GetStats().evictions_ == 81);
+  assert(cache.Put(3000, 0));
+  assert(cache.Size() == 300);
+  assert(!cache.Peek(81));
+
+  // So does a weighted cache, by weight.
+  LRUCache<int, string> weighted(100, [](int, const string& value) { return value.size(); }, 0.5);
+  for (int i = 0; i < 10; ++i) {
+    weighted.Put(i, string(10, 'x'));
+  }
+  weighted.Resize(30);
+  assert(weighted.Weight() == 100);
+  assert(!weighted.Put(10, string(20, 'y')));
+  assert(weighted.Weight() == 30);
+  assert(weighted.Put(10, string(15, 'y')));
+  assert(weighted.Weight() == 25 && weighted.Size() == 2);
+  assert(!weighted.IsShrinking());
+}
+
+void LRU_CACHE_TEST_GET_ASYNC_HIT() {
+  TestExecutor executor;
+  LRUCache<int, int> cache(10);
+  int num_loads = 0;
+  auto loader = [&executor, &num_loads](const int& key) { return SlowLoad(executor, key, 10, num_loads); };
+  cache.Put(1, 100);
+
+  // A hit completes in the caller, without suspending or allocating.
+  Task<int> task = GetAfter(executor, 0, cache, 1, loader);
+  size_t num_allocations = g_num_allocations;
+  task.Start();
+  assert(g_num_allocations == num_allocations);
+  assert(task.IsDone() && task.Result() == 100);
+  assert(num_loads == 0);
+  assert(cache.GetStats().hits_ == 1);
+}
+
+void LRU_CACHE_TEST_GET_ASYNC_SHARED_LOAD() {
+  TestExecutor executor;
+  LRUCache<int, int> cache(10);
+  int num_loads = 0;
+  auto loader = [&executor, &num_loads](const int& key) { return SlowLoad(executor, key, 10, num_loads); };
+
+  // 1 misses at 0, and loads until 10, which a second miss at 5 waits for
+  // too. 2 loads on its own, until 15. By 20, 1 is cached.
+  vector<Task<int>> tasks;
+  tasks.push_back(GetAfter(executor, 0, cache, 1, loader));
+  tasks.push_back(GetAfter(executor, 5, cache, 1, loader));
+  tasks.push_back(GetAfter(executor, 5, cache, 2, loader));
+  tasks.push_back(GetAfter(executor, 20, cache, 1, loader));
+  for (Task<int>& task : tasks) {
+    task.Start();
+    assert(!task.IsDone());
+  }
+  executor.Run();
+  assert(executor.Now() == 20);
+  assert(tasks[0].Result() == 10 && tasks[1].Result() == 10);
+  assert(tasks[2].Result() == 20 && tasks[3].Result() == 10);
+  assert(num_loads == 2);
+  assert(cache.GetStats().hits_ == 1 && cache.GetStats().misses_ == 3);
+  assert(*cache.Peek(1) == 10 && *cache.Peek(2) == 20);
+
+  // A loader that doesn't suspend doesn't suspend the caller either.
+  Task<int> task = GetAfter(executor, 0, cache, 3, [](const int& key) { return ImmediateLoad(key); });
+  task.Start();
+  assert(task.IsDone() && task.Result() == 30);
+  assert(*cache.Peek(3) == 30);
+}
+
+void LRU_CACHE_TEST_GET_ASYNC_EXCEPTION() {
+  TestExecutor executor;
+  LRUCache<int, int> cache(10);
+  int num_loads = 0;
+  auto loader = [&executor, &num_loads](const int& key) { return SlowLoad(executor, key, 10, num_loads); };
+
+  // Both awaiters of the load get its exception, and nothing is cached,
+  // so the next miss loads again.
+  vector<Task<int>> tasks;
+  tasks.push_back(GetAfter(executor, 0, cache, -1, loader));
+  tasks.push_back(GetAfter(executor, 5, cache, -1, loader));
+  tasks.push_back(GetAfter(executor, 20, cache, -1, loader));
+  for (Task<int>& task : tasks) {
+    task.Start();
+  }
+  executor.Run();
+  assert(Threw(tasks[0]) && Threw(tasks[1]) && Threw(tasks[2]));
+  assert(num_loads == 2);
+  assert(cache.Size() == 0);
+}
+
 void RUN_LRU_CACHE_TESTS() {
   LRU_CACHE_TEST_TWO_ITEMS();
   LRU_CACHE_TEST_MANY_ITEMS();
+  LRU_CACHE_TEST_PUT_EXISTING();
+  LRU_CACHE_TEST_UPSERT();
+  LRU_CACHE_TEST_NO_ALLOCATIONS();
+  LRU_CACHE_TEST_SMALL_STRING_KEYS();
+  LRU_CACHE_TEST_HETEROGENEOUS_LOOKUP();
+  LRU_CACHE_TEST_MOVE_ONLY_VALUES();
+  LRU_CACHE_TEST_MULTI_GET();
+  LRU_CACHE_TEST_MULTI_PUT();
+  LRU_CACHE_TEST_WEIGHTED();
+  LRU_CACHE_TEST_EVICTED_VALUES_FREED();
+  LRU_CACHE_TEST_TTL();
+  LRU_CACHE_TEST_MULTI_GET_EXPIRES_MID_BATCH();
+  LRU_CACHE_TEST_TTL_BOUNDED_TICK();
+  LRU_CACHE_TEST_EVICTION_LISTENER();
+  LRU_CACHE_TEST_WRITE_BACK();
+  LRU_CACHE_TEST_STATS();
+  LRU_CACHE_TEST_SNAPSHOT();
+  LRU_CACHE_TEST_GET_OR_LOAD();
+  LRU_CACHE_TEST_GET_ASYNC_HIT();
+  LRU_CACHE_TEST_GET_ASYNC_SHARED_LOAD();
+  LRU_CACHE_TEST_GET_ASYNC_EXCEPTION();
+  LRU_CACHE_TEST_RESIZE();
 }
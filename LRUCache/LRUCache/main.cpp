@@ -6,12 +6,68 @@
 //
 
 #include <iostream>
+#include <string>
 
+#include "cache_stats_test.hpp"
+#include "clock_cache_test.hpp"
+#include "concurrent_cache_test.hpp"
+#include "epoch_test.hpp"
+#include "eviction_policy_test.hpp"
+#include "fixed_lru_test.hpp"
+#include "frequency_sketch_test.hpp"
+#include "front_cache_test.hpp"
 #include "link_list_test.hpp"
+#include "lru_cache_bench.hpp"
 #include "lru_cache_test.hpp"
+#include "memory_usage_test.hpp"
+#include "miss_ratio_curve_test.hpp"
+#include "segment_log_test.hpp"
+#include "sharded_lru_cache_test.hpp"
+#include "slab_list_test.hpp"
+#include "small_string_test.hpp"
+#include "snapshot_test.hpp"
+#include "swiss_index_test.hpp"
+#include "task_test.hpp"
+#include "tiered_cache_test.hpp"
+#include "timer_wheel_test.hpp"
+#include "trace_test.hpp"
+#include "write_back_queue_test.hpp"
 
 int main(int argc, const char * argv[]) {
   RUN_LINK_LIST_TESTS();
+  RUN_SLAB_LIST_TESTS();
+  RUN_SMALL_STRING_TESTS();
+  RUN_SWISS_INDEX_TESTS();
+  RUN_TASK_TESTS();
+  RUN_TIMER_WHEEL_TESTS();
+  RUN_WRITE_BACK_QUEUE_TESTS();
+  RUN_FREQUENCY_SKETCH_TESTS();
+  RUN_CACHE_STATS_TESTS();
+  RUN_SNAPSHOT_TESTS();
+  RUN_EPOCH_TESTS();
+  RUN_TRACE_TESTS();
+  RUN_MISS_RATIO_CURVE_TESTS();
+  RUN_MEMORY_USAGE_TESTS();
   RUN_LRU_CACHE_TESTS();
+  RUN_FIXED_LRU_TESTS();
+  RUN_EVICTION_POLICY_TESTS();
+  RUN_SHARDED_LRU_CACHE_TESTS();
+  RUN_CLOCK_CACHE_TESTS();
+  RUN_CONCURRENT_CACHE_TESTS();
+  RUN_FRONT_CACHE_TESTS();
+  RUN_SEGMENT_LOG_TESTS();
+  RUN_TIERED_CACHE_TESTS();
+
+  // Benchmarks are slow, only run them when asked to.
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    RUN_LRU_CACHE_BENCHMARKS();
+  }
+  // --replay <trace file> [<cache size>]
+  if (argc > 2 && std::string(argv[1]) == "--replay") {
+    size_t max_size = argc > 3 ? std::stoul(argv[3]) : 100000;
+    if (!RUN_LRU_CACHE_TRACE_REPLAY(argv[2], max_size)) {
+      return 1;
+    }
+  }
   return 0;
 }
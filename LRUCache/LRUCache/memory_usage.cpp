@@ -0,0 +1,96 @@
+//
+//  memory_usage.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "memory_usage.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+
+size_t RoundUp(size_t bytes, size_t multiple) {
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+void MemoryUsage::AddBlock(size_t& component, size_t bytes) {
+  if (bytes > 0) {
+    component += bytes;
+    overhead_bytes_ += AllocationOverhead(bytes);
+  }
+}
+
+size_t MemoryUsage::TotalBytes() const {
+  return index_bytes_ + node_bytes_ + key_bytes_ + value_bytes_ + metadata_bytes_ + overhead_bytes_;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+  num_entries_ += other.num_entries_;
+  index_bytes_ += other.index_bytes_;
+  node_bytes_ += other.node_bytes_;
+  key_bytes_ += other.key_bytes_;
+  value_bytes_ += other.value_bytes_;
+  metadata_bytes_ += other.metadata_bytes_;
+  overhead_bytes_ += other.overhead_bytes_;
+  return *this;
+}
+
+string MemoryUsage::Report() const {
+  ostringstream report;
+  report << setw(10) << "" << setw(14) << "bytes" << setw(12) << "per entry" << endl;
+  auto row = [this, &report](const char* name, size_t bytes) {
+    double per_entry = num_entries_ ? double(bytes) / num_entries_ : 0;
+    report << setw(10) << name << setw(14) << bytes << setw(12) << fixed << setprecision(1) << per_entry << endl;
+  };
+  row("index", index_bytes_);
+  row("nodes", node_bytes_);
+  row("keys", key_bytes_);
+  row("values", value_bytes_);
+  row("metadata", metadata_bytes_);
+  row("allocator", overhead_bytes_);
+  row("total", TotalBytes());
+  return report.str();
+}
+
+size_t AllocationOverhead(size_t bytes) {
+#if defined(__APPLE__)
+  // Tiny blocks are rounded up to 16 bytes, small ones to 512, and large
+  // ones to pages, with no header.
+  size_t quantum = bytes <= 1008 ? 16 : bytes <= 127 * 1024 ? 512 : 4096;
+  return RoundUp(max<size_t>(bytes, 1), quantum) - bytes;
+#else
+  // glibc: a size word before each block, rounded up to 16 bytes, 32 at
+  // least. Blocks of 128 KB or more are mmap()ed, in whole pages, with two
+  // words before them.
+  if (bytes >= 128 * 1024) {
+    return RoundUp(bytes + 2 * sizeof(size_t), 4096) - bytes;
+  }
+  return max<size_t>(RoundUp(bytes + sizeof(size_t), 16), 32) - bytes;
+#endif
+}
+
+size_t HeapBytesInUse() {
+#if defined(__APPLE__)
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  return stats.size_in_use;
+#elif defined(__GLIBC__)
+  // Blocks from the heap, and mmap()ed ones.
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,96 @@
+//
+//  memory_usage.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef memory_usage_hpp
+#define memory_usage_hpp
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "small_string.hpp"
+
+using namespace std;
+
+// The bytes a cache (or list) takes, by what they are spent on, so layouts
+// can be compared per entry (see LRUCache::GetMemoryUsage()). Counts the
+// heap blocks it owns, and the object itself. The allocator's overhead on
+// each block (headers, rounding up) is estimated by AllocationOverhead(),
+// and can be checked against HeapBytesInUse().
+struct MemoryUsage {
+  size_t num_entries_ = 0;
+  // The hash index, used slots or not.
+  size_t index_bytes_ = 0;
+  // Nodes: links and other per-entry bookkeeping, and free slots.
+  size_t node_bytes_ = 0;
+  // Keys and values, in the nodes and what they own on the heap.
+  size_t key_bytes_ = 0;
+  size_t value_bytes_ = 0;
+  // Everything else: the object, policy state, expiry, dirty bits...
+  size_t metadata_bytes_ = 0;
+  // What the allocator spends beyond the bytes asked for.
+  size_t overhead_bytes_ = 0;
+
+  // Adds a heap block of bytes to component (one of the above), and its
+  // allocator overhead. Nothing, if bytes is 0.
+  void AddBlock(size_t& component, size_t bytes);
+
+  size_t TotalBytes() const;
+  double BytesPerEntry() const { return num_entries_ ? double(TotalBytes()) / num_entries_ : 0; }
+
+  MemoryUsage& operator+=(const MemoryUsage& other);
+
+  // Returns a table of the bytes spent on each component, in all and per
+  // entry.
+  string Report() const;
+};
+
+// Returns an estimate of what the allocator spends on a block of bytes
+// beyond them, from how the platform's malloc lays blocks out.
+size_t AllocationOverhead(size_t bytes);
+
+// Returns the bytes allocated on the heap, overhead included, as the
+// allocator counts them, or 0 where it can't be asked. What building
+// something costs is the difference before and after, on one thread.
+size_t HeapBytesInUse();
+
+// Returns the bytes value owns on the heap, in one block, beyond its
+// sizeof. Types that own heap memory should overload it.
+template <typename T>
+size_t HeapBytes(const T&) {
+  return 0;
+}
+
+// Short strings are inline, in the string itself.
+inline size_t HeapBytes(const string& s) {
+  const char* p = s.data();
+  bool is_inline = p >= reinterpret_cast<const char*>(&s) && p < reinterpret_cast<const char*>(&s + 1);
+  return is_inline ? 0 : s.capacity() + 1;
+}
+
+template <size_t kInlineSize>
+size_t HeapBytes(const SmallString<kInlineSize>& s) {
+  return s.IsInline() ? 0 : s.size();
+}
+
+template <typename T>
+size_t HeapBytes(const vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+// Adds an unordered_map's bucket array and nodes to component, each node
+// being taken to hold a link, the entry and its cached hash, as in
+// libstdc++ and libc++. What its keys and values own isn't included.
+template <typename HashMap>
+void AddHashMap(MemoryUsage& usage, size_t& component, const HashMap& map) {
+  usage.AddBlock(component, map.bucket_count() * sizeof(void*));
+  for (size_t i = 0; i < map.size(); ++i) {
+    usage.AddBlock(component, sizeof(void*) + sizeof(typename HashMap::value_type) + sizeof(size_t));
+  }
+}
+
+#endif /* memory_usage_hpp */
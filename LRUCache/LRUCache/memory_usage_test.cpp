@@ -0,0 +1,150 @@
+//
+//  memory_usage_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "memory_usage_test.hpp"
+#include "memory_usage.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "link_list.hpp"
+#include "lru_cache.hpp"
+#include "sharded_lru_cache.hpp"
+#include "small_string.hpp"
+
+using namespace std;
+
+namespace {
+
+// Returns 40-char keys, too long to be inline in a string.
+vector<string> GetLongKeys(int num_keys) {
+  vector<string> keys;
+  for (int i = 0; i < num_keys; ++i) {
+    keys.push_back(string(32, 'k') + to_string(10000000 + i));
+  }
+  return keys;
+}
+
+// The bytes a copy of a 40-char key takes, which may have less capacity
+// than the key built by appending.
+size_t KeyBytes() {
+  return sizeof(string) + HeapBytes(string(40, 'k'));
+}
+
+// Checks that estimated is within 5% of the heap bytes measured since
+// heap_bytes, where the allocator can be asked.
+void CheckMeasured(size_t estimated, size_t heap_bytes) {
+  if (heap_bytes != 0) {
+    double measured = double(HeapBytesInUse() - heap_bytes);
+    assert(fabs(estimated - measured) < 0.05 * measured);
+  }
+}
+
+} // namespace
+
+void MEMORY_USAGE_TEST_HEAP_BYTES() {
+  assert(HeapBytes(42) == 0);
+  assert(HeapBytes(string("rose")) == 0);
+  string long_string(100, 'r');
+  assert(HeapBytes(long_string) == long_string.capacity() + 1);
+  assert(HeapBytes(SmallString<>("rose")) == 0);
+  assert(HeapBytes(SmallString<>(long_string)) == 100);
+  assert(HeapBytes(vector<int>(10)) == 10 * sizeof(int));
+
+  // Every platform rounds blocks up to 16 bytes, at least.
+  for (size_t bytes : { 1, 24, 100, 1000, 100000, 1000000 }) {
+    assert((bytes + AllocationOverhead(bytes)) % 16 == 0);
+  }
+
+  MemoryUsage usage;
+  usage.num_entries_ = 2;
+  usage.AddBlock(usage.key_bytes_, 0);
+  assert(usage.TotalBytes() == 0);
+  usage.AddBlock(usage.key_bytes_, 100);
+  assert(usage.key_bytes_ == 100 && usage.overhead_bytes_ == AllocationOverhead(100));
+  assert(usage.BytesPerEntry() == usage.TotalBytes() / 2.0);
+  assert(usage.Report().find("total") != string::npos);
+}
+
+void MEMORY_USAGE_TEST_LRU_CACHE() {
+  constexpr int kMaxSize = 1000;
+  vector<string> keys = GetLongKeys(kMaxSize);
+
+  // Empty, the slab and index are all there is.
+  size_t heap_bytes = HeapBytesInUse();
+  auto cache = make_unique<LRUCache<string, int>>(kMaxSize);
+  MemoryUsage empty = cache->GetMemoryUsage();
+  assert(empty.num_entries_ == 0 && empty.key_bytes_ == 0 && empty.value_bytes_ == 0);
+  assert(empty.node_bytes_ >= kMaxSize * (sizeof(string) + sizeof(int)));
+  assert(empty.index_bytes_ >= kMaxSize * 8);
+  CheckMeasured(empty.TotalBytes(), heap_bytes);
+
+  // Full, the keys are counted out of the nodes, with their heap.
+  for (int i = 0; i < kMaxSize; ++i) {
+    cache->Put(keys[i], i);
+  }
+  MemoryUsage full = cache->GetMemoryUsage();
+  assert(full.num_entries_ == kMaxSize);
+  assert(full.index_bytes_ == empty.index_bytes_);
+  assert(full.node_bytes_ + kMaxSize * (sizeof(string) + sizeof(int)) == empty.node_bytes_);
+  assert(full.key_bytes_ == kMaxSize * KeyBytes());
+  assert(full.value_bytes_ == kMaxSize * sizeof(int));
+  CheckMeasured(full.TotalBytes(), heap_bytes);
+
+  // Policies count their own state.
+  LRUCache<string, int, LRUCacheHash<string>, equal_to<>, WTinyLFUPolicy> tiny_lfu(kMaxSize);
+  assert(tiny_lfu.GetMemoryUsage().metadata_bytes_ >= empty.metadata_bytes_ + kMaxSize * 8);
+}
+
+void MEMORY_USAGE_TEST_SHARDED() {
+  // Half full, so no shard evicts, however the keys spread.
+  constexpr int kMaxSize = 1000;
+  constexpr int kNumItems = kMaxSize / 2;
+  vector<string> keys = GetLongKeys(kNumItems);
+  size_t heap_bytes = HeapBytesInUse();
+  auto cache = make_unique<ShardedLRUCache<string, int>>(kMaxSize, 4);
+  for (int i = 0; i < kNumItems; ++i) {
+    cache->Put(keys[i], i);
+  }
+  MemoryUsage usage = cache->GetMemoryUsage();
+  assert(usage.num_entries_ == kNumItems);
+  assert(usage.key_bytes_ == kNumItems * KeyBytes());
+  CheckMeasured(usage.TotalBytes(), heap_bytes);
+}
+
+void MEMORY_USAGE_TEST_LINK_LIST() {
+  constexpr int kNumItems = 1000;
+  vector<string> keys = GetLongKeys(kNumItems);
+  size_t heap_bytes = HeapBytesInUse();
+  auto list = make_unique<LinkList>();
+  for (int i = 0; i < kNumItems; ++i) {
+    list->PushHead(make_tuple(keys[i], i));
+  }
+  MemoryUsage usage = list->GetMemoryUsage();
+  assert(usage.num_entries_ == kNumItems);
+  assert(usage.index_bytes_ == 0);
+  assert(usage.key_bytes_ == kNumItems * KeyBytes());
+  CheckMeasured(usage.TotalBytes(), heap_bytes);
+
+  // Popping frees every node, but for what the allocator keeps cached.
+  list->Clear();
+  assert(list->GetMemoryUsage().num_entries_ == 0);
+  list.reset();
+  if (heap_bytes != 0) {
+    assert(HeapBytesInUse() < heap_bytes + 0.05 * usage.TotalBytes());
+  }
+}
+
+void RUN_MEMORY_USAGE_TESTS() {
+  MEMORY_USAGE_TEST_HEAP_BYTES();
+  MEMORY_USAGE_TEST_LRU_CACHE();
+  MEMORY_USAGE_TEST_SHARDED();
+  MEMORY_USAGE_TEST_LINK_LIST();
+}
@@ -0,0 +1,13 @@
+//
+//  memory_usage_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef memory_usage_test_hpp
+#define memory_usage_test_hpp
+
+extern void RUN_MEMORY_USAGE_TESTS();
+
+#endif /* memory_usage_test_hpp */
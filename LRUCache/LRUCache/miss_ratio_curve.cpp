@@ -0,0 +1,166 @@
+//
+//  miss_ratio_curve.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "miss_ratio_curve.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Reference times run to this many per sample before being compacted, so
+// compacting is amortized over at least max_samples references.
+constexpr size_t kTimesPerSample = 2;
+constexpr size_t kMinTimes = 64;
+
+} // namespace
+
+MissRatioCurve::MissRatioCurve(double sampling_rate, size_t max_samples)
+    : max_samples_(max<size_t>(max_samples, 1)),
+      tree_(max(kMinTimes, max_samples_ * kTimesPerSample) + 1),
+      histogram_(kNumBuckets) {
+  assert(sampling_rate > 0 && sampling_rate <= 1);
+  // 2^64 * rate - 1, saturating at the top.
+  double threshold = ldexp(sampling_rate, 64);
+  threshold_ = threshold >= 0x1p64 ? numeric_limits<uint64_t>::max() : uint64_t(max(threshold, 1.0)) - 1;
+  sampling_rate_ = ldexp(double(threshold_) + 1, -64);
+  last_reference_.reserve(max_samples_ + 1);
+}
+
+MissRatioCurve::~MissRatioCurve() {
+}
+
+double MissRatioCurve::HitRatio(size_t capacity) const {
+  if (num_sampled_lookups_ == 0 || capacity == 0) {
+    return 0;
+  }
+
+  // A lookup hits if fewer than capacity other keys were referenced since.
+  double num_hits = num_expected_lookups_ - num_sampled_lookups_;
+  for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+    double start = BucketStart(bucket);
+    double end = bucket + 1 < kNumBuckets ? BucketStart(bucket + 1) : ldexp(1, 64);
+    if (end <= capacity) {
+      num_hits += histogram_[bucket];
+    } else {
+      if (start < capacity) {
+        num_hits += histogram_[bucket] * (capacity - start) / (end - start);
+      }
+      break;
+    }
+  }
+  return clamp(num_hits / num_expected_lookups_, 0.0, 1.0);
+}
+
+void MissRatioCurve::AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+  AddHashMap(usage, component, last_reference_);
+  // A priority_queue doesn't tell its capacity.
+  usage.AddBlock(component, samples_by_hash_.size() * sizeof(uint64_t));
+  usage.AddBlock(component, tree_.capacity() * sizeof(uint32_t));
+  usage.AddBlock(component, histogram_.capacity() * sizeof(double));
+}
+
+int MissRatioCurve::BucketOf(uint64_t distance) {
+  if (distance < (1 << kSubBucketBits)) {
+    return int(distance);
+  }
+  // The power of 2, then the next kSubBucketBits bits below it.
+  int exponent = bit_width(distance) - 1;
+  int sub_bucket = int(distance >> (exponent - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+  return ((exponent - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket;
+}
+
+double MissRatioCurve::BucketStart(int bucket) {
+  if (bucket < (1 << kSubBucketBits)) {
+    return bucket;
+  }
+  int exponent = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+  int sub_bucket = bucket & ((1 << kSubBucketBits) - 1);
+  return ldexp((1 << kSubBucketBits) + sub_bucket, exponent - kSubBucketBits);
+}
+
+void MissRatioCurve::Sample(uint64_t h, bool is_lookup) {
+  if (now_ + 1 == tree_.size()) {
+    CompactTimes();
+  }
+
+  auto [it, inserted] = last_reference_.try_emplace(h, 0);
+  if (inserted) {
+    samples_by_hash_.push(h);
+    num_sampled_lookups_ += is_lookup;
+  } else {
+    // Every key referenced since is marked at a later time than this one.
+    size_t distance = last_reference_.size() - CountUpTo(it->second);
+    AddAt(it->second, -1);
+    if (is_lookup) {
+      double scaled = min(distance / sampling_rate_, 0x1p63);
+      histogram_[BucketOf(uint64_t(scaled))] += 1;
+      num_sampled_lookups_ += 1;
+    }
+  }
+  it->second = uint32_t(now_);
+  AddAt(now_++, 1);
+
+  if (last_reference_.size() > max_samples_) {
+    DropSamples();
+  }
+}
+
+void MissRatioCurve::DropSamples() {
+  double old_rate = sampling_rate_;
+  while (last_reference_.size() > max_samples_) {
+    uint64_t h = samples_by_hash_.top();
+    samples_by_hash_.pop();
+    threshold_ = h - 1;
+    auto it = last_reference_.find(h);
+    AddAt(it->second, -1);
+    last_reference_.erase(it);
+  }
+
+  // The lookups counted so far were sampled at the old rate: scale them
+  // to what the new one would have sampled.
+  sampling_rate_ = ldexp(double(threshold_) + 1, -64);
+  double scale = sampling_rate_ / old_rate;
+  for (double& count : histogram_) {
+    count *= scale;
+  }
+  num_sampled_lookups_ *= scale;
+  num_expected_lookups_ *= scale;
+}
+
+void MissRatioCurve::CompactTimes() {
+  vector<pair<uint32_t, uint64_t>> keys_by_time;
+  keys_by_time.reserve(last_reference_.size());
+  for (const auto& [h, time] : last_reference_) {
+    keys_by_time.emplace_back(time, h);
+  }
+  sort(keys_by_time.begin(), keys_by_time.end());
+
+  fill(tree_.begin(), tree_.end(), 0);
+  now_ = 0;
+  for (const auto& [time, h] : keys_by_time) {
+    last_reference_[h] = uint32_t(now_);
+    AddAt(now_++, 1);
+  }
+}
+
+void MissRatioCurve::AddAt(size_t time, int delta) {
+  for (size_t i = time + 1; i < tree_.size(); i += i & -i) {
+    tree_[i] += delta;
+  }
+}
+
+size_t MissRatioCurve::CountUpTo(size_t time) const {
+  size_t count = 0;
+  for (size_t i = time + 1; i > 0; i &= i - 1) {
+    count += tree_[i];
+  }
+  return count;
+}
@@ -0,0 +1,149 @@
+//
+//  miss_ratio_curve.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef miss_ratio_curve_hpp
+#define miss_ratio_curve_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_usage.hpp"
+
+using namespace std;
+
+// Estimates, online, the hit ratio an LRU cache would have at any
+// capacity, from the keys looked up and put (see
+// LRUCache::EnableMissRatioCurve()). Keys are given by their hash.
+//
+// Uses SHARDS (Waldspurger et al.): only keys whose mixed hash falls
+// under a threshold are sampled, a fixed fraction of the key space, so
+// the sampled keys' references are a scaled-down copy of the whole
+// trace. For each sampled lookup, the number of distinct sampled keys
+// referenced since the key's last reference (its reuse distance), divided
+// by the sampling rate, estimates its reuse distance in the full trace,
+// and an LRU cache of capacity c hits exactly the lookups at a distance
+// below c. Distances are counted with a Fenwick tree over the times of
+// each sampled key's last reference, and kept in a log-linear histogram
+// (16 buckets per power of 2).
+//
+// At most max_samples keys are tracked: past that, the threshold is
+// lowered to drop the highest-hashed ones, and the histogram is rescaled
+// to the lower rate (fixed-size SHARDS). So memory stays at about 64 bytes
+// per sample, whatever the number of keys, and the rate adapts down to
+// what it can afford. Unsampled references cost a hash mix and a compare;
+// sampled ones a hash map lookup and two O(log max_samples) tree walks.
+class MissRatioCurve {
+public:
+  static constexpr double kDefaultSamplingRate = 0.01;
+  static constexpr size_t kDefaultMaxSamples = 8192;
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+  // Samples sampling_rate (0 to 1) of the keys, until more than
+  // max_samples have been seen.
+  MissRatioCurve(double sampling_rate = kDefaultSamplingRate, size_t max_samples = kDefaultMaxSamples);
+  virtual ~MissRatioCurve();
+
+  // Counts a lookup of the key with hash, hit or miss.
+  void RecordGet(uint64_t hash) {
+    ++num_lookups_;
+    num_expected_lookups_ += sampling_rate_;
+    uint64_t h = Mix(hash);
+    if (h <= threshold_) {
+      Sample(h, true);
+    }
+  }
+
+  // Records a put of the key with hash: it is now the most recently used,
+  // but a put isn't a lookup, so doesn't count towards the hit ratio.
+  void RecordPut(uint64_t hash) {
+    uint64_t h = Mix(hash);
+    if (h <= threshold_) {
+      Sample(h, false);
+    }
+  }
+
+  // Returns the predicted hit ratio of an LRU cache of capacity entries
+  // over the lookups recorded, 0 if there were none. Interpolates within
+  // the histogram's buckets. A few hot keys being sampled, or not, skews
+  // the number of lookups sampled, and they are mostly at short
+  // distances: so the difference from the number expected is made up at
+  // distance 0 (SHARDS_adj).
+  double HitRatio(size_t capacity) const;
+  double MissRatio(size_t capacity) const { return 1 - HitRatio(capacity); }
+
+  // Returns the number of lookups recorded, sampled or not.
+  uint64_t NumLookups() const { return num_lookups_; }
+
+  // Returns the number of keys being tracked.
+  size_t NumSamples() const { return last_reference_.size(); }
+
+  // Returns the fraction of keys sampled, less than the rate asked for
+  // once more than max_samples keys have been seen.
+  double SamplingRate() const { return sampling_rate_; }
+
+  // Adds the samples, the tree and the histogram to component of usage.
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const;
+
+private:
+  // Spreads hash over all 64 bits (SplitMix64's finalizer, after an
+  // increment so 0 doesn't stay 0), since sampling compares it to a
+  // threshold, and hashes like std::hash<int> are the identity.
+  static uint64_t Mix(uint64_t hash) {
+    hash += 0x9e3779b97f4a7c15;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+    return hash ^ (hash >> 31);
+  }
+
+  static int BucketOf(uint64_t distance);
+  // Returns the least distance that goes in bucket.
+  static double BucketStart(int bucket);
+
+  // Records a reference to the sampled key with mixed hash h.
+  void Sample(uint64_t h, bool is_lookup);
+
+  // Drops the highest-hashed keys until at most max_samples_ are left,
+  // lowering the threshold below them.
+  void DropSamples();
+
+  // Renumbers the keys' last reference times from 0, in order, when they
+  // have run out.
+  void CompactTimes();
+
+  // Fenwick tree operations over reference times: adds delta at time,
+  // and returns the number of keys last referenced at or before time.
+  void AddAt(size_t time, int delta);
+  size_t CountUpTo(size_t time) const;
+
+  size_t max_samples_;
+  // Keys whose mixed hash is at most this are sampled, which is
+  // sampling_rate_ of them.
+  uint64_t threshold_;
+  double sampling_rate_;
+  // Each sampled key's time of last reference.
+  unordered_map<uint64_t, uint32_t> last_reference_;
+  // The sampled keys' mixed hashes, highest on top, to drop.
+  priority_queue<uint64_t> samples_by_hash_;
+  // 1 at each key's last reference time, as a Fenwick tree (1-based).
+  vector<uint32_t> tree_;
+  // The time the next reference gets.
+  size_t now_ = 0;
+  // Sampled lookups by estimated reuse distance, and all of them, with
+  // those of keys seen for the first time, which miss at any capacity.
+  // Then the number of lookups expected to have been sampled. Scaled down
+  // with the rate.
+  vector<double> histogram_;
+  double num_sampled_lookups_ = 0;
+  double num_expected_lookups_ = 0;
+  uint64_t num_lookups_ = 0;
+};
+
+#endif /* miss_ratio_curve_hpp */
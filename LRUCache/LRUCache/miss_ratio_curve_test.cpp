@@ -0,0 +1,111 @@
+//
+//  miss_ratio_curve_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "miss_ratio_curve_test.hpp"
+#include "miss_ratio_curve.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <initializer_list>
+
+#include "lru_cache.hpp"
+#include "sharded_lru_cache.hpp"
+#include "trace.hpp"
+
+using namespace std;
+
+namespace {
+
+// Returns the hit ratio of an LRU cache of max_size over trace.
+double ActualHitRatio(const Trace& trace, size_t max_size) {
+  LRUCache<uint64_t, uint64_t> cache(max_size);
+  return RunTrace(cache, trace, false).HitRatio();
+}
+
+// Replays trace through a cache with a miss ratio curve sampling_rate
+// and max_samples, and checks its estimates at capacities against the
+// hit ratios of LRU caches that size, to within error.
+void CheckEstimates(const Trace& trace, double sampling_rate, size_t max_samples,
+                    initializer_list<size_t> capacities, double error) {
+  LRUCache<uint64_t, uint64_t> cache(1);
+  cache.EnableMissRatioCurve(sampling_rate, max_samples);
+  TraceResult result = RunTrace(cache, trace, false);
+  const MissRatioCurve* curve = cache.GetMissRatioCurve();
+  assert(curve->NumLookups() == result.num_lookups_);
+  assert(curve->NumSamples() <= max_samples);
+  for (size_t capacity : capacities) {
+    assert(fabs(curve->HitRatio(capacity) - ActualHitRatio(trace, capacity)) < error);
+  }
+}
+
+} // namespace
+
+void MISS_RATIO_CURVE_TEST_EXACT() {
+  // Looping over 10 keys, every lookup but the first 10 is at a distance
+  // of 9: it hits in a cache of 10, but not of 9.
+  MissRatioCurve curve(1.0);
+  assert(curve.SamplingRate() == 1.0);
+  assert(curve.HitRatio(10) == 0);
+  for (uint64_t i = 0; i < 100; ++i) {
+    curve.RecordGet(i % 10);
+  }
+  assert(curve.NumLookups() == 100);
+  assert(curve.NumSamples() == 10);
+  assert(curve.HitRatio(9) == 0);
+  assert(fabs(curve.HitRatio(10) - 0.9) < 1e-9);
+  assert(fabs(curve.HitRatio(1000) - 0.9) < 1e-9);
+  assert(fabs(curve.MissRatio(10) - 0.1) < 1e-9);
+
+  // A put makes a key the most recent, but isn't a lookup.
+  MissRatioCurve puts(1.0);
+  puts.RecordPut(42);
+  puts.RecordGet(42);
+  assert(puts.NumLookups() == 1);
+  assert(puts.HitRatio(1) == 1);
+  assert(puts.HitRatio(0) == 0);
+}
+
+void MISS_RATIO_CURVE_TEST_MATCHES_LRU() {
+  // Sampling every key, the estimate is exact, up to interpolating within
+  // buckets past 16.
+  Trace trace = ZipfTrace(1000, 100000, 0.9);
+  MixWrites(trace, 10);
+  CheckEstimates(trace, 1.0, 1000, { 1, 5, 16, 50, 100, 500 }, 0.01);
+}
+
+void MISS_RATIO_CURVE_TEST_SAMPLED() {
+  // 1% of 100000 keys is enough to be within a few percent.
+  Trace trace = ZipfTrace(100000, 1000000, 0.9);
+  CheckEstimates(trace, 0.01, MissRatioCurve::kDefaultMaxSamples, { 1000, 10000, 50000 }, 0.03);
+
+  // As is tracking at most 1000 keys, asked to sample all of them: the
+  // rate drops to about 1%.
+  LRUCache<uint64_t, uint64_t> cache(1);
+  cache.EnableMissRatioCurve(1.0, 1000);
+  RunTrace(cache, trace, false);
+  double rate = cache.GetMissRatioCurve()->SamplingRate();
+  assert(rate > 0.005 && rate < 0.02);
+  CheckEstimates(trace, 1.0, 1000, { 1000, 10000, 50000 }, 0.03);
+}
+
+void MISS_RATIO_CURVE_TEST_SHARDED() {
+  Trace trace = ZipfTrace(10000, 200000, 0.9);
+  ShardedLRUCache<uint64_t, uint64_t> cache(100, 4);
+  assert(cache.PredictHitRatio(1000) == 0);
+  cache.EnableMissRatioCurve(0.1);
+  RunTrace(cache, trace, false);
+  for (size_t max_size : { 500, 2000 }) {
+    assert(fabs(cache.PredictHitRatio(max_size) - ActualHitRatio(trace, max_size)) < 0.03);
+  }
+}
+
+void RUN_MISS_RATIO_CURVE_TESTS() {
+  MISS_RATIO_CURVE_TEST_EXACT();
+  MISS_RATIO_CURVE_TEST_MATCHES_LRU();
+  MISS_RATIO_CURVE_TEST_SAMPLED();
+  MISS_RATIO_CURVE_TEST_SHARDED();
+}
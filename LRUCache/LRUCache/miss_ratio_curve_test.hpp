@@ -0,0 +1,13 @@
+//
+//  miss_ratio_curve_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef miss_ratio_curve_test_hpp
+#define miss_ratio_curve_test_hpp
+
+extern void RUN_MISS_RATIO_CURVE_TESTS();
+
+#endif /* miss_ratio_curve_test_hpp */
@@ -0,0 +1,343 @@
+//
+//  segment_log.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "segment_log.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <limits>
+#include <unistd.h>
+
+#include "snapshot.hpp"
+
+namespace {
+
+constexpr char kSegmentPrefix[] = "segment-";
+constexpr char kSegmentSuffix[] = ".log";
+
+} // namespace
+
+struct SegmentLog::Segment {
+  Segment(uint32_t id, string path, int fd) : id_(id), path_(std::move(path)), fd_(fd) {}
+  ~Segment() { close(fd_); }
+
+  uint32_t id_;
+  string path_;
+  int fd_;
+  // Bytes appended, including those still in the write buffer, and
+  // those written out.
+  uint64_t size_ = 0;
+  uint64_t flushed_size_ = 0;
+  // Bytes of records still in the index.
+  uint64_t live_bytes_ = 0;
+  // The locations_ slots of every record appended to it, so dropping it
+  // doesn't scan them all. A slot may since have been freed, or reused
+  // for another segment's record.
+  vector<SwissIndex::Index> slots_;
+  bool sealed_ = false;
+};
+
+SegmentLog::SegmentLog(const string& directory, uint64_t max_bytes, size_t segment_bytes,
+                       bool background_compaction)
+    : directory_(directory), max_bytes_(max_bytes), segment_bytes_(segment_bytes) {
+  // Offsets within a segment are 32-bit.
+  assert(segment_bytes_ <= numeric_limits<uint32_t>::max());
+  filesystem::create_directories(directory_);
+  for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directory_)) {
+    string name = entry.path().filename().string();
+    if (name.starts_with(kSegmentPrefix) && name.ends_with(kSegmentSuffix)) {
+      filesystem::remove(entry.path());
+    }
+  }
+  if (background_compaction) {
+    compaction_thread_ = thread([this]() { CompactionLoop(); });
+  }
+}
+
+SegmentLog::~SegmentLog() {
+  {
+    lock_guard<mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  compaction_wanted_.notify_one();
+  if (compaction_thread_.joinable()) {
+    compaction_thread_.join();
+  }
+  for (const auto& [id, segment] : segments_) {
+    unlink(segment->path_.c_str());
+  }
+}
+
+bool SegmentLog::Append(uint64_t hash, string_view key, string_view value) {
+  RecordHeader header = {};
+  header.hash_ = hash;
+  header.key_size_ = static_cast<uint32_t>(key.size());
+  header.value_size_ = static_cast<uint32_t>(value.size());
+  string record;
+  record.reserve(sizeof(header) + key.size() + value.size());
+  record.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  record.append(key);
+  record.append(value);
+  header.checksum_ = SnapshotChecksum(record.data() + sizeof(header), key.size() + value.size());
+  memcpy(record.data() + offsetof(RecordHeader, checksum_), &header.checksum_, sizeof(header.checksum_));
+
+  lock_guard<mutex> lock(mutex_);
+  return AppendLocked(hash, record);
+}
+
+optional<string> SegmentLog::Lookup(uint64_t hash, string_view key, bool erase) {
+  string record;
+  shared_ptr<Segment> segment;
+  Location location;
+  {
+    lock_guard<mutex> lock(mutex_);
+    SwissIndex::Index slot = FindLocked(hash);
+    if (slot == SwissIndex::kNullIndex) {
+      return nullopt;
+    }
+    location = locations_[slot];
+    segment = segments_.at(location.segment_);
+    if (location.offset_ >= segment->flushed_size_) {
+      // Still in the write buffer.
+      record.assign(write_buffer_, location.offset_ - segment->flushed_size_, location.size_);
+      segment = nullptr;
+    }
+    if (erase) {
+      EraseLocked(slot);
+    }
+  }
+
+  // The segment's file stays open while we hold it, even if it is
+  // compacted or dropped meanwhile.
+  if (segment) {
+    record.resize(location.size_);
+    if (pread(segment->fd_, record.data(), location.size_, location.offset_) != ssize_t(location.size_)) {
+      return nullopt;
+    }
+  }
+
+  RecordHeader header;
+  memcpy(&header, record.data(), sizeof(header));
+  string_view contents(record.data() + sizeof(header), record.size() - sizeof(header));
+  if (header.hash_ != hash || sizeof(header) + header.key_size_ + header.value_size_ != record.size() ||
+      header.checksum_ != SnapshotChecksum(contents.data(), contents.size()) ||
+      contents.substr(0, header.key_size_) != key) {
+    return nullopt;
+  }
+  return string(contents.substr(header.key_size_));
+}
+
+bool SegmentLog::Erase(uint64_t hash) {
+  lock_guard<mutex> lock(mutex_);
+  SwissIndex::Index slot = FindLocked(hash);
+  if (slot == SwissIndex::kNullIndex) {
+    return false;
+  }
+  EraseLocked(slot);
+  return true;
+}
+
+size_t SegmentLog::Compact() {
+  unique_lock<mutex> lock(mutex_);
+  size_t num_compacted = 0;
+  while (shared_ptr<Segment> segment = PickCompactionLocked()) {
+    CompactSegment(segment, lock);
+    ++num_compacted;
+  }
+  return num_compacted;
+}
+
+size_t SegmentLog::Size() const {
+  lock_guard<mutex> lock(mutex_);
+  return index_.Size();
+}
+
+uint64_t SegmentLog::Bytes() const {
+  lock_guard<mutex> lock(mutex_);
+  return bytes_;
+}
+
+size_t SegmentLog::NumSegments() const {
+  lock_guard<mutex> lock(mutex_);
+  return segments_.size();
+}
+
+SwissIndex::Index SegmentLog::FindLocked(uint64_t hash) const {
+  return index_.Find(hash, [this, hash](SwissIndex::Index slot) { return locations_[slot].hash_ == hash; });
+}
+
+void SegmentLog::EraseLocked(SwissIndex::Index slot) {
+  Location& location = locations_[slot];
+  Segment& segment = *segments_.at(location.segment_);
+  segment.live_bytes_ -= location.size_;
+  bool erased = index_.Erase(location.hash_, slot);
+  assert(erased);
+  location = Location();
+  free_locations_.push_back(slot);
+
+  if (segment.sealed_ && segment.live_bytes_ < segment.size_ * kCompactionThreshold) {
+    compaction_wanted_.notify_one();
+  }
+}
+
+bool SegmentLog::AppendLocked(uint64_t hash, string_view record) {
+  if (record.size() > segment_bytes_) {
+    return false;
+  }
+  if (segments_.empty() || segments_.rbegin()->second->size_ + record.size() > segment_bytes_) {
+    if (!StartSegmentLocked()) {
+      return false;
+    }
+  }
+  SwissIndex::Index slot = FindLocked(hash);
+  if (slot != SwissIndex::kNullIndex) {
+    EraseLocked(slot);
+  }
+
+  Segment& segment = *segments_.rbegin()->second;
+  Location location;
+  location.hash_ = hash;
+  location.segment_ = segment.id_;
+  location.offset_ = static_cast<uint32_t>(segment.size_);
+  location.size_ = static_cast<uint32_t>(record.size());
+  write_buffer_.append(record);
+  segment.size_ += record.size();
+  segment.live_bytes_ += record.size();
+  bytes_ += record.size();
+
+  if (free_locations_.empty()) {
+    slot = static_cast<SwissIndex::Index>(locations_.size());
+    locations_.push_back(location);
+  } else {
+    slot = free_locations_.back();
+    free_locations_.pop_back();
+    locations_[slot] = location;
+  }
+  index_.Insert(hash, slot);
+  segment.slots_.push_back(slot);
+
+  bool ok = write_buffer_.size() < kWriteBufferBytes || FlushLocked();
+  EnforceMaxBytesLocked();
+  return ok;
+}
+
+bool SegmentLog::FlushLocked() {
+  Segment& segment = *segments_.rbegin()->second;
+  const char* data = write_buffer_.data();
+  size_t size = write_buffer_.size();
+  while (size > 0) {
+    ssize_t written = pwrite(segment.fd_, data, size, segment.flushed_size_);
+    if (written < 0) {
+      // Keep what wasn't written, to retry with the next flush.
+      write_buffer_.erase(0, write_buffer_.size() - size);
+      return false;
+    }
+    data += written;
+    size -= written;
+    segment.flushed_size_ += written;
+  }
+  write_buffer_.clear();
+  return true;
+}
+
+bool SegmentLog::StartSegmentLocked() {
+  if (!segments_.empty()) {
+    if (!FlushLocked()) {
+      return false;
+    }
+    segments_.rbegin()->second->sealed_ = true;
+    compaction_wanted_.notify_one();
+  }
+
+  uint32_t id = next_segment_id_++;
+  string path = directory_ + "/" + kSegmentPrefix + to_string(id) + kSegmentSuffix;
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  segments_.emplace(id, make_shared<Segment>(id, path, fd));
+  return true;
+}
+
+void SegmentLog::EnforceMaxBytesLocked() {
+  while (bytes_ > max_bytes_ && segments_.size() > 1) {
+    DropSegmentLocked(segments_.begin()->first);
+  }
+}
+
+void SegmentLog::DropSegmentLocked(uint32_t id) {
+  shared_ptr<Segment> segment = segments_.at(id);
+  assert(segment->sealed_);
+  for (SwissIndex::Index slot : segment->slots_) {
+    if (segment->live_bytes_ == 0) {
+      break;
+    }
+    if (locations_[slot].size_ != 0 && locations_[slot].segment_ == id) {
+      EraseLocked(slot);
+    }
+  }
+  bytes_ -= segment->size_;
+  unlink(segment->path_.c_str());
+  segments_.erase(id);
+}
+
+shared_ptr<SegmentLog::Segment> SegmentLog::PickCompactionLocked() const {
+  shared_ptr<Segment> best;
+  for (const auto& [id, segment] : segments_) {
+    if (segment->sealed_ && segment->live_bytes_ < segment->size_ * kCompactionThreshold &&
+        (!best || segment->live_bytes_ * best->size_ < best->live_bytes_ * segment->size_)) {
+      best = segment;
+    }
+  }
+  return best;
+}
+
+void SegmentLog::CompactSegment(const shared_ptr<Segment>& segment, unique_lock<mutex>& lock) {
+  // A sealed segment doesn't change, so it can be read without the lock.
+  lock.unlock();
+  string contents(segment->size_, '\0');
+  bool read = pread(segment->fd_, contents.data(), contents.size(), 0) == ssize_t(contents.size());
+  lock.lock();
+  if (!segments_.count(segment->id_)) {
+    // Dropped meanwhile.
+    return;
+  }
+
+  // Copy forward the records the index still points at. Reading the
+  // segment failing just drops them early.
+  for (size_t offset = 0; read && offset + sizeof(RecordHeader) <= contents.size();) {
+    RecordHeader header;
+    memcpy(&header, contents.data() + offset, sizeof(header));
+    size_t size = sizeof(header) + header.key_size_ + header.value_size_;
+    SwissIndex::Index slot = FindLocked(header.hash_);
+    if (slot != SwissIndex::kNullIndex && locations_[slot].segment_ == segment->id_ &&
+        locations_[slot].offset_ == offset) {
+      AppendLocked(header.hash_, string_view(contents.data() + offset, size));
+    }
+    offset += size;
+  }
+  if (segments_.count(segment->id_)) {
+    DropSegmentLocked(segment->id_);
+  }
+}
+
+void SegmentLog::CompactionLoop() {
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    shared_ptr<Segment> segment;
+    compaction_wanted_.wait(lock, [this, &segment]() {
+      return stopping_ || (segment = PickCompactionLocked()) != nullptr;
+    });
+    if (stopping_) {
+      return;
+    }
+    CompactSegment(segment, lock);
+  }
+}
@@ -0,0 +1,160 @@
+//
+//  segment_log.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef segment_log_hpp
+#define segment_log_hpp
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "swiss_index.hpp"
+
+using namespace std;
+
+// A log-structured store of records on local disk, the second tier of a
+// TieredCache. Records (a key's hash, its key and its value, as bytes)
+// are appended to the active segment file, through a write buffer; once a
+// segment is full it is sealed, and a new one started. What is kept in
+// memory per record is its location, a SwissIndex over a slab of 24-byte
+// Locations keyed by the 64-bit hash, and its 4-byte slot in that slab,
+// listed by its segment so dropping the segment needn't scan the slab.
+// The slot stays listed, dead or not, until the segment is dropped. A
+// lookup is one pread() of the whole record, whose key is checked against
+// the one looked up.
+//
+// Records are never updated in place. Appending a key again, or erasing
+// it, leaves its old record dead, and a background thread compacts
+// segments that are mostly dead, copying their live records to the head
+// of the log and deleting the file. When the log grows past max_bytes,
+// its oldest segment is dropped whole, records and all, like a FIFO cache.
+//
+// Two keys with the same 64-bit hash can't both be stored: appending one
+// replaces the other. For a cache that is just an early eviction.
+//
+// The directory belongs to the log: segment files left in it by an
+// earlier run are removed, and so are the log's own on destruction.
+// Thread-safe; lookups read from disk without holding the lock.
+class SegmentLog {
+public:
+  static constexpr size_t kDefaultSegmentBytes = 64 << 20;
+  static constexpr size_t kWriteBufferBytes = 1 << 20;
+  // Sealed segments with less than this fraction of their bytes live are
+  // compacted.
+  static constexpr double kCompactionThreshold = 0.5;
+
+  // A log in directory (created if missing) of at most about max_bytes,
+  // in segments of segment_bytes. If background_compaction is false, only
+  // Compact() compacts.
+  SegmentLog(const string& directory, uint64_t max_bytes, size_t segment_bytes = kDefaultSegmentBytes,
+             bool background_compaction = true);
+  virtual ~SegmentLog();
+
+  // Appends a record for key, whose hash is hash, with value. Replaces
+  // any earlier record for hash. Returns false if it can't be written.
+  bool Append(uint64_t hash, string_view key, string_view value);
+
+  // Returns the value of the record for key, whose hash is hash, or
+  // nullopt if there isn't one (or it can't be read back intact). If
+  // erase, the record is also removed, whether or not its key matched.
+  optional<string> Lookup(uint64_t hash, string_view key, bool erase = false);
+
+  // Removes the record for hash. Returns false if there isn't one.
+  bool Erase(uint64_t hash);
+
+  // Compacts every sealed segment that is mostly dead, as the background
+  // thread does. Returns the number of segments compacted.
+  size_t Compact();
+
+  // Returns the number of live records.
+  size_t Size() const;
+
+  // Returns the bytes the segments take on disk, live and dead.
+  uint64_t Bytes() const;
+
+  size_t NumSegments() const;
+
+private:
+  struct Segment;
+
+  // Where a record is. size_ is 0 for a free slot of locations_.
+  struct Location {
+    uint64_t hash_ = 0;
+    uint32_t segment_ = 0;
+    uint32_t offset_ = 0;
+    uint32_t size_ = 0;
+  };
+
+  // The header of each record, followed by key_size_ bytes of key and
+  // value_size_ of value. The checksum is of the key and value.
+  struct RecordHeader {
+    uint64_t hash_;
+    uint32_t key_size_;
+    uint32_t value_size_;
+    uint64_t checksum_;
+  };
+
+  // Returns locations_'s slot for hash, or SwissIndex::kNullIndex.
+  SwissIndex::Index FindLocked(uint64_t hash) const;
+
+  // Removes the location in slot, marking its record dead.
+  void EraseLocked(SwissIndex::Index slot);
+
+  // Appends a whole record (header and all) for hash, replacing any record
+  // for hash, sealing the active segment first if it is full.
+  bool AppendLocked(uint64_t hash, string_view record);
+
+  // Writes out the active segment's write buffer.
+  bool FlushLocked();
+
+  // Seals the active segment, if any, and opens a new one.
+  bool StartSegmentLocked();
+
+  // Drops the oldest segments until the log is within max_bytes_.
+  void EnforceMaxBytesLocked();
+
+  // Drops a segment, with all its records.
+  void DropSegmentLocked(uint32_t id);
+
+  // Returns a sealed segment worth compacting, or nullptr.
+  shared_ptr<Segment> PickCompactionLocked() const;
+
+  // Copies segment's live records to the head of the log, then drops it.
+  void CompactSegment(const shared_ptr<Segment>& segment, unique_lock<mutex>& lock);
+
+  // The background thread: compacts whenever a sealed segment is mostly
+  // dead, until the log is destroyed.
+  void CompactionLoop();
+
+  string directory_;
+  uint64_t max_bytes_;
+  size_t segment_bytes_;
+
+  mutable mutex mutex_;
+  // Every segment, by ID, the last one active.
+  map<uint32_t, shared_ptr<Segment>> segments_;
+  uint32_t next_segment_id_ = 0;
+  // The active segment's appended bytes not yet written out.
+  string write_buffer_;
+  uint64_t bytes_ = 0;
+  SwissIndex index_;
+  vector<Location> locations_;
+  vector<SwissIndex::Index> free_locations_;
+
+  bool stopping_ = false;
+  condition_variable compaction_wanted_;
+  thread compaction_thread_;
+};
+
+#endif /* segment_log_hpp */
@@ -0,0 +1,140 @@
+//
+//  segment_log_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "segment_log_test.hpp"
+#include "segment_log.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+constexpr char kDirectory[] = "/tmp/segment_log_test";
+
+} // namespace
+
+void SEGMENT_LOG_TEST_APPEND_LOOKUP() {
+  SegmentLog log(kDirectory, 1 << 20, 4096, false);
+  assert(log.Append(1, "rose", "red"));
+  assert(log.Append(2, "mars", "orange"));
+  assert(log.Size() == 2);
+
+  // Found while still in the write buffer, and only under its own key.
+  assert(log.Lookup(1, "rose") == "red");
+  assert(log.Lookup(1, "mars") == nullopt);
+  assert(log.Lookup(3, "zara") == nullopt);
+
+  // Appending the same hash again replaces the record.
+  assert(log.Append(1, "rose", "pink"));
+  assert(log.Size() == 2);
+  assert(log.Lookup(1, "rose") == "pink");
+
+  // Erasing, or looking up to erase.
+  assert(log.Erase(2));
+  assert(!log.Erase(2));
+  assert(log.Lookup(1, "rose", true) == "pink");
+  assert(log.Lookup(1, "rose") == nullopt);
+  assert(log.Size() == 0);
+
+  // Records in sealed segments are read back from disk.
+  string value(1000, 'x');
+  for (uint64_t i = 0; i < 20; ++i) {
+    assert(log.Append(i, "key" + to_string(i), value));
+  }
+  assert(log.NumSegments() > 1);
+  for (uint64_t i = 0; i < 20; ++i) {
+    assert(log.Lookup(i, "key" + to_string(i)) == value);
+  }
+}
+
+void SEGMENT_LOG_TEST_COMPACTION() {
+  SegmentLog log(kDirectory, 1 << 20, 4096, false);
+  string value(100, 'v');
+  for (uint64_t i = 0; i < 200; ++i) {
+    assert(log.Append(i, to_string(i), value));
+  }
+  uint64_t bytes = log.Bytes();
+  size_t num_segments = log.NumSegments();
+
+  // Erasing most records leaves their segments mostly dead.
+  for (uint64_t i = 0; i < 200; ++i) {
+    if (i % 4 != 0) {
+      assert(log.Erase(i));
+    }
+  }
+  assert(log.Bytes() == bytes);
+  assert(log.Compact() > 0);
+  assert(log.Bytes() < bytes / 2);
+  assert(log.NumSegments() < num_segments);
+  assert(log.Compact() == 0);
+
+  // The live records were copied forward.
+  assert(log.Size() == 50);
+  for (uint64_t i = 0; i < 200; i += 4) {
+    assert(log.Lookup(i, to_string(i)) == value);
+  }
+}
+
+void SEGMENT_LOG_TEST_BACKGROUND_COMPACTION() {
+  SegmentLog log(kDirectory, 1 << 20, 4096);
+  string value(100, 'v');
+  for (uint64_t i = 0; i < 1000; ++i) {
+    assert(log.Append(i % 10, to_string(i % 10), value + to_string(i)));
+  }
+
+  // Only the last value of each key is live; the thread reclaims the
+  // rest, eventually.
+  for (int i = 0; i < 1000 && log.NumSegments() > 2; ++i) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  assert(log.NumSegments() <= 2);
+  for (uint64_t i = 990; i < 1000; ++i) {
+    assert(log.Lookup(i % 10, to_string(i % 10)) == value + to_string(i));
+  }
+}
+
+void SEGMENT_LOG_TEST_MAX_BYTES() {
+  SegmentLog log(kDirectory, 8192, 4096, false);
+  string value(1000, 'x');
+  for (uint64_t i = 0; i < 100; ++i) {
+    assert(log.Append(i, to_string(i), value));
+  }
+
+  // The oldest segments were dropped, the newest records kept.
+  assert(log.Bytes() <= 8192);
+  assert(log.Size() < 10);
+  assert(log.Lookup(0, "0") == nullopt);
+  assert(log.Lookup(99, "99") == value);
+
+  // Records erased from the newest segments free slots that later ones
+  // reuse, which dropping the older segments must leave live.
+  for (uint64_t i = 90; i < 100; i += 2) {
+    log.Erase(i);
+  }
+  for (uint64_t i = 100; i < 120; ++i) {
+    assert(log.Append(i, to_string(i), value));
+  }
+  size_t num_found = 0;
+  for (uint64_t i = 0; i < 120; ++i) {
+    num_found += log.Lookup(i, to_string(i)) == value;
+  }
+  assert(num_found == log.Size());
+  assert(log.Lookup(119, "119") == value);
+}
+
+void RUN_SEGMENT_LOG_TESTS() {
+  SEGMENT_LOG_TEST_APPEND_LOOKUP();
+  SEGMENT_LOG_TEST_COMPACTION();
+  SEGMENT_LOG_TEST_BACKGROUND_COMPACTION();
+  SEGMENT_LOG_TEST_MAX_BYTES();
+  filesystem::remove_all(kDirectory);
+}
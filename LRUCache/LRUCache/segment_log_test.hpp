@@ -0,0 +1,13 @@
+//
+//  segment_log_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef segment_log_test_hpp
+#define segment_log_test_hpp
+
+extern void RUN_SEGMENT_LOG_TESTS();
+
+#endif /* segment_log_test_hpp */
@@ -0,0 +1,419 @@
+//
+//  sharded_lru_cache.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef sharded_lru_cache_hpp
+#define sharded_lru_cache_hpp
+
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "clock_cache.hpp"
+#include "lru_cache.hpp"
+#include "memory_usage.hpp"
+#include "miss_ratio_curve.hpp"
+
+using namespace std;
+
+// A thread-safe cache, split into independent shards that each have their
+// own lock and their own Cache (an LRUCache or ClockCache). A key always
+// maps to the same shard, so threads working on different keys rarely
+// contend. Recency is tracked per shard, so eviction is (approximately)
+// LRU within a shard rather than across the whole cache.
+//
+// If Cache::kConcurrentGet, Get() only takes its shard's lock shared, so
+// lookups in the same shard don't serialize.
+template <typename Cache>
+class ShardedCache {
+public:
+  using Key = typename Cache::KeyType;
+  using Value = typename Cache::ValueType;
+  using Hash = typename Cache::HashType;
+  using Eq = typename Cache::EqType;
+  // Named as LRUCache names them, for code that takes either (RunTrace()).
+  using KeyType = Key;
+  using ValueType = Value;
+
+  static constexpr size_t kDefaultNumShards = 16;
+
+  // max_size is split as evenly as possible across num_shards.
+  ShardedCache(size_t max_size, size_t num_shards = kDefaultNumShards) {
+    assert(num_shards > 0);
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+      // The first (max_size % num_shards) shards get one extra entry.
+      size_t shard_max_size = max_size / num_shards + (i < max_size % num_shards ? 1 : 0);
+      shards_.push_back(make_unique<Shard>(shard_max_size));
+    }
+  }
+
+  // Splits a weighted capacity (see LRUCache) as evenly as possible across
+  // num_shards. max_entry_fraction is of a shard's capacity.
+  template <typename Weigher>
+  ShardedCache(size_t max_weight, Weigher weigher, double max_entry_fraction,
+               size_t num_shards = kDefaultNumShards) {
+    assert(num_shards > 0);
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+      size_t shard_max_weight = max_weight / num_shards + (i < max_weight % num_shards ? 1 : 0);
+      shards_.push_back(make_unique<Shard>(shard_max_weight, weigher, max_entry_fraction));
+    }
+  }
+  virtual ~ShardedCache() {}
+
+  template <typename K>
+  auto Put(K&& key, Value value) {
+    Shard& shard = GetShard(key);
+    lock_guard<Mutex> lock(shard.mutex_);
+    return shard.cache_.Put(std::forward<K>(key), std::move(value));
+  }
+
+  // Caches key with a time to live, see LRUCache::Put().
+  template <typename K, typename Rep, typename Period>
+  bool Put(K&& key, Value value, chrono::duration<Rep, Period> ttl) {
+    Shard& shard = GetShard(key);
+    lock_guard<Mutex> lock(shard.mutex_);
+    return shard.cache_.Put(std::forward<K>(key), std::move(value), ttl);
+  }
+
+  // Caches key dirty, see LRUCache::PutDirty().
+  template <typename K>
+  bool PutDirty(K&& key, Value value) {
+    Shard& shard = GetShard(key);
+    lock_guard<Mutex> lock(shard.mutex_);
+    return shard.cache_.PutDirty(std::forward<K>(key), std::move(value));
+  }
+
+  template <typename K>
+  optional<Value> Upsert(K&& key, Value value) {
+    Shard& shard = GetShard(key);
+    lock_guard<Mutex> lock(shard.mutex_);
+    return shard.cache_.Upsert(std::forward<K>(key), std::move(value));
+  }
+
+  template <typename K>
+  bool Erase(const K& key) {
+    Shard& shard = GetShard(key);
+    lock_guard<Mutex> lock(shard.mutex_);
+    return shard.cache_.Erase(key);
+  }
+
+  // Returns a copy of the cached value, since a pointer into the shard
+  // isn't safe to use once its lock is released.
+  template <typename K>
+  optional<Value> Get(const K& key) {
+    Shard& shard = GetShard(key);
+    GetLock lock(shard.mutex_);
+    const Value* value = shard.cache_.Get(key);
+    if (!value) {
+      return nullopt;
+    }
+    return *value;
+  }
+
+  // Returns the value cached under key, or if there is none, caches and
+  // returns loader(key). Concurrent misses on the same key are coalesced:
+  // only the first caller runs loader, outside the shard's lock, and the
+  // others wait for its result. If loader throws, nothing is cached, and
+  // every caller waiting on it gets the exception. loader must not call
+  // GetOrLoad() for the same key, which would wait on itself.
+  template <typename K, typename Loader>
+  Value GetOrLoad(const K& key, Loader&& loader) {
+    return GetOrLoad(key, std::forward<Loader>(loader), [](Cache& cache, const Key& key, const Value& value) {
+      cache.Put(key, value);
+    });
+  }
+
+  // Like GetOrLoad(), but a loaded value is cached with a time to live.
+  template <typename K, typename Loader, typename Rep, typename Period>
+  Value GetOrLoad(const K& key, Loader&& loader, chrono::duration<Rep, Period> ttl) {
+    return GetOrLoad(key, std::forward<Loader>(loader), [ttl](Cache& cache, const Key& key, const Value& value) {
+      cache.Put(key, value, ttl);
+    });
+  }
+
+  // Changes the capacity, split across the shards as by the constructors,
+  // see LRUCache::Resize(). Each shard is resized under its own lock, and
+  // over-full shards evict as they are used.
+  void Resize(size_t max_size) {
+    size_t num_shards = shards_.size();
+    for (size_t i = 0; i < num_shards; ++i) {
+      size_t shard_max_size = max_size / num_shards + (i < max_size % num_shards ? 1 : 0);
+      lock_guard<Mutex> lock(shards_[i]->mutex_);
+      shards_[i]->cache_.Resize(shard_max_size);
+    }
+  }
+
+  // Removes expired entries from every shard, up to max_work_per_shard
+  // of them each, see LRUCache::Tick(). Returns the number removed.
+  size_t Tick(size_t max_work_per_shard = Cache::kDefaultTickWork) {
+    size_t num_expired = 0;
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      num_expired += shard->cache_.Tick(max_work_per_shard);
+    }
+    return num_expired;
+  }
+
+  // Sets every shard's eviction listener, see LRUCache. Shards call it
+  // under their own locks, so it may be called from several threads at
+  // once.
+  template <typename Listener>
+  void SetEvictionListener(const Listener& listener) {
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      shard->cache_.SetEvictionListener(listener);
+    }
+  }
+
+  // Has every shard write back to queue, see LRUCache::SetWriteBackQueue().
+  template <typename Queue>
+  void SetWriteBackQueue(const shared_ptr<Queue>& queue) {
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      shard->cache_.SetWriteBackQueue(queue);
+    }
+  }
+
+  // Queues every shard's dirty entries for write-back, see
+  // LRUCache::WriteBackDirty(). Returns the number queued.
+  size_t WriteBackDirty() {
+    size_t num_queued = 0;
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      num_queued += shard->cache_.WriteBackDirty();
+    }
+    return num_queued;
+  }
+
+  // Returns the sum of every shard's stats, see LRUCache::GetStats().
+  // Each shard counts under its own lock, so counting adds no contention;
+  // shards are snapshotted one at a time, so the sum isn't of one instant.
+  CacheStats GetStats() {
+    CacheStats stats;
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      stats += shard->cache_.GetStats();
+    }
+    return stats;
+  }
+
+  // Returns the sum of every shard's memory usage, see
+  // LRUCache::GetMemoryUsage(), with the shards themselves and their loads
+  // in progress as metadata. Each shard is walked under its lock.
+  MemoryUsage GetMemoryUsage() {
+    MemoryUsage usage;
+    usage.metadata_bytes_ += sizeof(*this);
+    usage.AddBlock(usage.metadata_bytes_, shards_.capacity() * sizeof(unique_ptr<Shard>));
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      usage += shard->cache_.GetMemoryUsage();
+      // The cache object is counted twice, as part of its shard.
+      usage.metadata_bytes_ -= sizeof(Cache);
+      usage.AddBlock(usage.metadata_bytes_, sizeof(Shard));
+      AddHashMap(usage, usage.metadata_bytes_, shard->loads_);
+    }
+    return usage;
+  }
+
+  // Turns recording latencies on or off in every shard.
+  void SetRecordLatencies(bool record_latencies) {
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      shard->cache_.SetRecordLatencies(record_latencies);
+    }
+  }
+
+  // Starts estimating the hit ratio at other capacities in every shard,
+  // see LRUCache::EnableMissRatioCurve(). max_samples is per shard.
+  void EnableMissRatioCurve(double sampling_rate = MissRatioCurve::kDefaultSamplingRate,
+                            size_t max_samples = MissRatioCurve::kDefaultMaxSamples) {
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      shard->cache_.EnableMissRatioCurve(sampling_rate, max_samples);
+    }
+  }
+
+  // Returns the hit ratio the cache would have, were it resized to
+  // max_size, as estimated by the shards' miss ratio curves at their
+  // share of it, weighted by their lookups. 0 if not enabled.
+  double PredictHitRatio(size_t max_size) {
+    double num_hits = 0;
+    uint64_t num_lookups = 0;
+    size_t num_shards = shards_.size();
+    for (size_t i = 0; i < num_shards; ++i) {
+      size_t shard_max_size = max_size / num_shards + (i < max_size % num_shards ? 1 : 0);
+      lock_guard<Mutex> lock(shards_[i]->mutex_);
+      if (const MissRatioCurve* curve = shards_[i]->cache_.GetMissRatioCurve()) {
+        num_hits += curve->HitRatio(shard_max_size) * curve->NumLookups();
+        num_lookups += curve->NumLookups();
+      }
+    }
+    return num_lookups ? num_hits / num_lookups : 0;
+  }
+
+  // Saves every shard's entries to a snapshot at path, see
+  // LRUCache::SaveSnapshot(). Shards are encoded one at a time, each under
+  // its own lock, and the file is written after all the locks are
+  // released, so the cache keeps serving throughout.
+  bool SaveSnapshot(const string& path) {
+    string payload;
+    size_t num_entries = 0;
+    for (unique_ptr<Shard>& shard : shards_) {
+      lock_guard<Mutex> lock(shard->mutex_);
+      num_entries += shard->cache_.EncodeSnapshot(payload);
+    }
+    return WriteSnapshotFile(path, num_entries, payload);
+  }
+
+  // Loads a snapshot into the cache, which must be empty, sending each
+  // entry to its shard. See LRUCache::LoadSnapshot().
+  bool LoadSnapshot(const string& path) {
+    MappedSnapshot snapshot;
+    vector<typename Cache::SnapshotEntry> entries;
+    if (!snapshot.Open(path) || !Cache::DecodeSnapshot(snapshot, entries)) {
+      return false;
+    }
+
+    // Each shard's entries keep their order in the snapshot.
+    vector<vector<typename Cache::SnapshotEntry>> shard_entries(shards_.size());
+    for (typename Cache::SnapshotEntry& entry : entries) {
+      shard_entries[GetShardIndex(entry.key_)].push_back(std::move(entry));
+    }
+    // Every shard is locked, in order, until all are loaded, so no Put()
+    // gets in between checking they are empty and loading them.
+    vector<unique_lock<Mutex>> locks;
+    locks.reserve(shards_.size());
+    for (unique_ptr<Shard>& shard : shards_) {
+      locks.emplace_back(shard->mutex_);
+      if (shard->cache_.Size() != 0) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i]->cache_.LoadEntries(std::move(shard_entries[i]));
+    }
+    return true;
+  }
+
+  size_t NumShards() const { return shards_.size(); }
+
+  // Returns the capacity of the shard that key maps to.
+  template <typename K>
+  size_t GetShardMaxSizeForTesting(const K& key) {
+    return GetShard(key).cache_.MaxSize();
+  }
+
+private:
+  using Mutex = conditional_t<Cache::kConcurrentGet, shared_mutex, mutex>;
+  using GetLock = conditional_t<Cache::kConcurrentGet, shared_lock<Mutex>, lock_guard<Mutex>>;
+
+  // A load in progress, see GetOrLoad(), whose result every caller that
+  // missed on the key shares.
+  struct Load {
+    Load() : future_(promise_.get_future()) {}
+
+    promise<Value> promise_;
+    shared_future<Value> future_;
+  };
+
+  // Aligned so that neighboring shards' locks don't share a cache line.
+  struct alignas(64) Shard {
+    template <typename... Args>
+    Shard(Args&&... args) : cache_(std::forward<Args>(args)...) {}
+
+    Mutex mutex_;
+    Cache cache_;
+    // The shard's keys being loaded.
+    unordered_map<Key, shared_ptr<Load>, Hash, Eq> loads_;
+  };
+
+  // GetOrLoad(), caching a loaded value with put(cache, key, value).
+  template <typename K, typename Loader, typename Put>
+  Value GetOrLoad(const K& key, Loader&& loader, const Put& put) {
+    if (optional<Value> value = Get(key)) {
+      return *std::move(value);
+    }
+
+    // Join the key's load if there is one, or start it. The key is looked
+    // up again first, in case a load finished since, with Peek(): the Get()
+    // above already counted the miss.
+    Shard& shard = GetShard(key);
+    shared_ptr<Load> load;
+    bool loading = false;
+    {
+      lock_guard<Mutex> lock(shard.mutex_);
+      if (const Value* value = shard.cache_.Peek(key)) {
+        return *value;
+      }
+      shared_ptr<Load>& shard_load = shard.loads_[Key(key)];
+      if (!shard_load) {
+        shard_load = make_shared<Load>();
+        loading = true;
+      }
+      load = shard_load;
+    }
+    if (!loading) {
+      return load->future_.get();
+    }
+
+    // Cache the value and end the load under one lock, so that later
+    // callers either find the value or join the load.
+    Key owned_key(key);
+    try {
+      Value value = loader(owned_key);
+      {
+        lock_guard<Mutex> lock(shard.mutex_);
+        put(shard.cache_, owned_key, value);
+        shard.loads_.erase(owned_key);
+      }
+      load->promise_.set_value(value);
+      return value;
+    } catch (...) {
+      {
+        lock_guard<Mutex> lock(shard.mutex_);
+        shard.loads_.erase(owned_key);
+      }
+      load->promise_.set_exception(current_exception());
+      throw;
+    }
+  }
+
+  template <typename K>
+  Shard& GetShard(const K& key) {
+    return *shards_[GetShardIndex(key)];
+  }
+
+  template <typename K>
+  size_t GetShardIndex(const K& key) const {
+    // Mix the hash, std::hash of an integer being the integer, and pick
+    // the shard from the high bits. The shard's own index mixes it another
+    // way, so keys in one shard still spread over its index.
+    uint64_t h = Hash()(key) * 0x9E3779B97F4A7C15ull;
+    return (h >> 32) % shards_.size();
+  }
+
+  vector<unique_ptr<Shard>> shards_;
+};
+
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>,
+          template <typename, typename, typename> class Policy = LRUPolicy>
+using ShardedLRUCache = ShardedCache<LRUCache<Key, Value, Hash, Eq, Policy>>;
+
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>>
+using ShardedClockCache = ShardedCache<ClockCache<Key, Value, Hash, Eq>>;
+
+#endif /* sharded_lru_cache_hpp */
@@ -0,0 +1,275 @@
+//
+//  sharded_lru_cache_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "sharded_lru_cache_test.hpp"
+#include "sharded_lru_cache.hpp"
+#include "link_list.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+void SHARDED_LRU_CACHE_TEST_CAPACITY_SPLIT() {
+  // 10 entries over 4 shards, two shards get 3 entries and two get 2.
+  ShardedLRUCache<string, int> cache(10, 4);
+  assert(cache.NumShards() == 4);
+
+  vector<LinkList::Node::Contents> items = LinkList::Node::GetRandomItems(100);
+  for (const LinkList::Node::Contents& item : items) {
+    size_t shard_max_size = cache.GetShardMaxSizeForTesting(get<0>(item));
+    assert(shard_max_size == 2 || shard_max_size == 3);
+  }
+
+  // Insert everything, no more than the total capacity is retained.
+  for (const LinkList::Node::Contents& item : items) {
+    cache.Put(get<0>(item), get<1>(item));
+  }
+  int num_cached = 0;
+  for (const LinkList::Node::Contents& item : items) {
+    if (cache.Get(get<0>(item))) {
+      ++num_cached;
+    }
+  }
+  assert(num_cached > 0);
+  assert(num_cached <= 10);
+}
+
+void SHARDED_LRU_CACHE_TEST_SINGLE_SHARD() {
+  // With one shard, behaves exactly like an LRUCache.
+  ShardedLRUCache<string, int> cache(2, 1);
+  cache.Put("rose", 10);
+  cache.Put("mars", 20);
+  assert(cache.Get("rose") == 10);
+  cache.Put("zara", 30);
+  assert(cache.Get("mars") == nullopt);
+  assert(cache.Get("rose") == 10);
+  assert(cache.Get("zara") == 30);
+}
+
+void SHARDED_LRU_CACHE_TEST_TINY_LFU() {
+  // Each shard has its own policy.
+  ShardedLRUCache<int, int, LRUCacheHash<int>, equal_to<>, WTinyLFUPolicy> cache(200, 2);
+  for (int n = 0; n < 4; ++n) {
+    for (int i = 0; i < 150; ++i) {
+      cache.Put(i, i);
+    }
+  }
+  for (int i = 1000; i < 2000; ++i) {
+    cache.Put(i, i);
+  }
+  int num_hits = 0;
+  for (int i = 0; i < 150; ++i) {
+    num_hits += cache.Get(i) == i;
+  }
+  assert(num_hits > 140);
+}
+
+void SHARDED_LRU_CACHE_TEST_CONCURRENT() {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumItems = 2000;
+  constexpr int kNumOps = 20000;
+  ShardedLRUCache<string, int> cache(kNumItems / 2, 8);
+  vector<LinkList::Node::Contents> items = LinkList::Node::GetRandomItems(kNumItems);
+
+  // Every thread puts and gets the same items, a Get() must either miss
+  // or return the one value ever stored for that id.
+  vector<thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&cache, &items, t]() {
+      unsigned int seed = t;
+      for (int i = 0; i < kNumOps; ++i) {
+        const LinkList::Node::Contents& item = items[rand_r(&seed) % items.size()];
+        if (i % 4 == 0) {
+          cache.Put(get<0>(item), get<1>(item));
+        } else {
+          optional<int> value = cache.Get(get<0>(item));
+          assert(!value || value == get<1>(item));
+        }
+      }
+    });
+  }
+  for (thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void SHARDED_LRU_CACHE_TEST_WEIGHTED() {
+  // A budget of 40 bytes over 2 shards, values weigh their length.
+  ShardedLRUCache<string, string> cache(40, [](const string&, const string& value) {
+    return value.size();
+  }, 1.0, 2);
+  assert(cache.GetShardMaxSizeForTesting("rose") == 20);
+
+  // Too heavy for a shard.
+  assert(!cache.Put("rose", string(21, 'r')));
+  assert(cache.Get("rose") == nullopt);
+  assert(cache.Put("rose", string(20, 'r')));
+  assert(cache.Get("rose") == string(20, 'r'));
+}
+
+void SHARDED_LRU_CACHE_TEST_WRITE_BACK() {
+  // Every shard writes back to the same queue.
+  int sum = 0;
+  shared_ptr<WriteBackQueue<int, int>> queue = make_shared<WriteBackQueue<int, int>>(
+      [&sum](span<pair<int, int>> batch) {
+        for (const pair<int, int>& entry : batch) {
+          sum += entry.second;
+        }
+      }, 8);
+  ShardedLRUCache<int, int> cache(100, 4);
+  cache.SetWriteBackQueue(queue);
+  for (int i = 0; i < 1000; ++i) {
+    cache.PutDirty(i, 1);
+  }
+
+  // Once flushed, the evicted entries have all been written back.
+  queue->Flush();
+  assert(sum == 900);
+  assert(cache.WriteBackDirty() == 100);
+  queue->Flush();
+  assert(sum == 1000);
+}
+
+void SHARDED_LRU_CACHE_TEST_STATS() {
+  ShardedLRUCache<int, int> cache(100, 4);
+  cache.SetRecordLatencies(true);
+  for (int i = 0; i < 200; ++i) {
+    cache.Put(i, i);
+  }
+  for (int i = 0; i < 200; ++i) {
+    cache.Get(i);
+  }
+
+  // Summed over the shards.
+  CacheStats stats = cache.GetStats();
+  assert(stats.inserts_ == 200);
+  assert(stats.evictions_ == 100);
+  assert(stats.hits_ == 100 && stats.misses_ == 100);
+  assert(stats.size_ == 100);
+  assert(stats.get_latency_.Count() == 200 && stats.put_latency_.Count() == 200);
+
+  // A GetOrLoad() miss is counted once, and isn't taken for a reuse by
+  // the miss ratio curve.
+  ShardedLRUCache<int, int> loaded(100, 4);
+  loaded.SetRecordLatencies(true);
+  loaded.EnableMissRatioCurve(1.0);
+  assert(loaded.GetOrLoad(1, [](int key) { return 10; }) == 10);
+  stats = loaded.GetStats();
+  assert(stats.hits_ == 0 && stats.misses_ == 1);
+  assert(stats.get_latency_.Count() == 1);
+  assert(loaded.PredictHitRatio(100) == 0);
+}
+
+void SHARDED_LRU_CACHE_TEST_SNAPSHOT() {
+  string path = "/tmp/sharded_lru_cache_test_snapshot";
+  ShardedLRUCache<int, int> cache(100, 4);
+  for (int i = 0; i < 100; ++i) {
+    cache.Put(i, i * 10);
+  }
+  assert(cache.SaveSnapshot(path));
+
+  // Loads into a cache sharded differently.
+  ShardedLRUCache<int, int> loaded(200, 3);
+  assert(loaded.LoadSnapshot(path));
+  for (int i = 0; i < 100; ++i) {
+    assert(cache.Get(i) == loaded.Get(i));
+  }
+  assert(!loaded.LoadSnapshot(path));
+  remove(path.c_str());
+}
+
+void SHARDED_LRU_CACHE_TEST_GET_OR_LOAD() {
+  constexpr int kNumThreads = 16;
+  ShardedLRUCache<string, int> cache(100, 4);
+  atomic<int> num_loads = 0;
+
+  // Threads that miss on the same key at once share one load, held up
+  // long enough for all of them to miss.
+  vector<thread> threads;
+  atomic<int> sum = 0;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&cache, &num_loads, &sum]() {
+      sum += cache.GetOrLoad("rose", [&num_loads](const string& key) {
+        ++num_loads;
+        this_thread::sleep_for(chrono::milliseconds(50));
+        return 10;
+      });
+    });
+  }
+  for (thread& thread : threads) {
+    thread.join();
+  }
+  assert(num_loads == 1);
+  assert(sum == 10 * kNumThreads);
+  assert(cache.Get("rose") == 10);
+
+  // A failed load reaches every caller waiting on it, and isn't cached.
+  threads.clear();
+  atomic<int> num_failures = 0;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&cache, &num_loads, &num_failures]() {
+      try {
+        cache.GetOrLoad("mars", [&num_loads](const string& key) -> int {
+          ++num_loads;
+          this_thread::sleep_for(chrono::milliseconds(50));
+          throw runtime_error("no mars");
+        });
+      } catch (const runtime_error&) {
+        ++num_failures;
+      }
+    });
+  }
+  for (thread& thread : threads) {
+    thread.join();
+  }
+  assert(num_failures == kNumThreads);
+  assert(num_loads < kNumThreads);
+  assert(cache.Get("mars") == nullopt);
+  assert(cache.GetOrLoad("mars", [](const string& key) { return 20; }, chrono::hours(1)) == 20);
+  assert(cache.Get("mars") == 20);
+}
+
+void SHARDED_LRU_CACHE_TEST_RESIZE() {
+  ShardedLRUCache<int, int> cache(400, 4);
+  for (int i = 0; i < 1000; ++i) {
+    cache.Put(i, i);
+  }
+  assert(cache.GetStats().size_ == 400);
+
+  // Split as by the constructor, and each shard evicts as it is used.
+  cache.Resize(10);
+  assert(cache.GetStats().size_ == 400);
+  for (int i = 0; i < 1000; ++i) {
+    size_t shard_max_size = cache.GetShardMaxSizeForTesting(i);
+    assert(shard_max_size == 2 || shard_max_size == 3);
+    cache.Get(i);
+  }
+  assert(cache.GetStats().size_ == 10);
+}
+
+void RUN_SHARDED_LRU_CACHE_TESTS() {
+  SHARDED_LRU_CACHE_TEST_CAPACITY_SPLIT();
+  SHARDED_LRU_CACHE_TEST_RESIZE();
+  SHARDED_LRU_CACHE_TEST_SINGLE_SHARD();
+  SHARDED_LRU_CACHE_TEST_TINY_LFU();
+  SHARDED_LRU_CACHE_TEST_CONCURRENT();
+  SHARDED_LRU_CACHE_TEST_WEIGHTED();
+  SHARDED_LRU_CACHE_TEST_WRITE_BACK();
+  SHARDED_LRU_CACHE_TEST_STATS();
+  SHARDED_LRU_CACHE_TEST_SNAPSHOT();
+  SHARDED_LRU_CACHE_TEST_GET_OR_LOAD();
+}
@@ -0,0 +1,13 @@
+//
+//  sharded_lru_cache_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef sharded_lru_cache_test_hpp
+#define sharded_lru_cache_test_hpp
+
+extern void RUN_SHARDED_LRU_CACHE_TESTS();
+
+#endif /* sharded_lru_cache_test_hpp */
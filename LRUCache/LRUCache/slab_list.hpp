@@ -0,0 +1,228 @@
+//
+//  slab_list.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef slab_list_hpp
+#define slab_list_hpp
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "memory_usage.hpp"
+
+using namespace std;
+
+// A doubly-linked list whose nodes live in one contiguous, preallocated
+// slab and link to each other by 32-bit index rather than by pointer.
+// Removed nodes go on a free list and are recycled by the next insert,
+// so once constructed the list itself never allocates, unless grown.
+//
+// The slab may be shared by up to kNumLists lists (the segments of a
+// segmented LRU, say). Nodes don't record which list they are on, so
+// operations on a linked node take the list it is on; they default to
+// list 0, for the common case of a single list.
+template <typename Contents, size_t kNumLists = 1>
+class SlabList {
+public:
+  using Index = uint32_t;
+  static constexpr Index kNullIndex = numeric_limits<Index>::max();
+
+  class Node {
+  public:
+    Contents contents_;
+    Index next_ = kNullIndex;
+    Index prev_ = kNullIndex;
+  };
+
+  // Preallocates capacity nodes, all of them initially free.
+  SlabList(size_t capacity) : nodes_(capacity) {
+    assert(capacity < kNullIndex);
+    Clear();
+  }
+  virtual ~SlabList() {}
+
+  bool IsEmpty() const { return size_ == 0; }
+  bool IsFull() const { return size_ == nodes_.size(); }
+  // Returns the number of nodes on all lists.
+  size_t Size() const { return size_; }
+  size_t Capacity() const { return nodes_.size(); }
+
+  // Returns the number of nodes on list.
+  size_t ListSize(size_t list) const { return ends_[list].size_; }
+
+  // Unlinks every node and returns it to the free list. Contents are left
+  // in place, to be overwritten (reusing their storage) on the next insert.
+  void Clear() {
+    ends_.fill(Ends());
+    size_ = 0;
+    free_ = nodes_.empty() ? kNullIndex : 0;
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      nodes_[i].prev_ = kNullIndex;
+      nodes_[i].next_ = i + 1 < nodes_.size() ? static_cast<Index>(i + 1) : kNullIndex;
+    }
+  }
+
+  // Adds free slots until there are capacity in all. Existing nodes keep
+  // their indices, though the slab may move (invalidating Node&s).
+  void Grow(size_t capacity) {
+    assert(capacity < kNullIndex);
+    size_t old_capacity = nodes_.size();
+    if (capacity <= old_capacity) {
+      return;
+    }
+
+    nodes_.resize(capacity);
+    for (size_t i = capacity; i-- > old_capacity;) {
+      nodes_[i].next_ = free_;
+      free_ = static_cast<Index>(i);
+    }
+  }
+
+  // Returns the index of list's head/tail, or kNullIndex if it is empty.
+  Index GetHead(size_t list = 0) const { return ends_[list].head_; }
+  Index GetTail(size_t list = 0) const { return ends_[list].tail_; }
+
+  Node& At(Index index) { return nodes_[index]; }
+  const Node& At(Index index) const { return nodes_[index]; }
+
+  // Inserts at the head of list, in a recycled slot. Returns the slot's
+  // index, or kNullIndex if the slab is full.
+  Index PushHead(Contents contents, size_t list = 0) {
+    Index index = TakeFree();
+    if (index == kNullIndex) {
+      return kNullIndex;
+    }
+
+    Node& node = nodes_[index];
+    node.contents_ = std::move(contents);
+    LinkHead(index, list);
+    return index;
+  }
+
+  // Removes from the tail of list, the slot is returned to the free list.
+  optional<Contents> PopTail(size_t list = 0) {
+    Index index = ends_[list].tail_;
+    if (index == kNullIndex) {
+      // List is empty.
+      assert(ends_[list].head_ == kNullIndex);
+      return nullopt;
+    }
+
+    optional<Contents> contents = std::move(nodes_[index].contents_);
+    Remove(index, list);
+    return contents;
+  }
+
+  // Unlinks the node at index from list and returns its slot to the free
+  // list.
+  void Remove(Index index, size_t list = 0) {
+    Unlink(index, list);
+    nodes_[index].next_ = free_;
+    free_ = index;
+    --size_;
+  }
+
+  // Moves node from its current position to the head of list.
+  void PromoteNodeHead(Index index, size_t list = 0) {
+    if (index == ends_[list].head_) {
+      // Nothing to do.
+      return;
+    }
+
+    Unlink(index, list);
+    LinkHead(index, list);
+  }
+
+  // Moves node from list from to the head of list to.
+  void MoveNodeHead(Index index, size_t from, size_t to) {
+    Unlink(index, from);
+    LinkHead(index, to);
+  }
+
+  // Adds the slab, free slots included, to component of usage.
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+    usage.AddBlock(component, nodes_.capacity() * sizeof(Node));
+  }
+
+  vector<Contents> WalkHeadToTail(size_t list = 0) const {
+    vector<Contents> v;
+    for (Index index = ends_[list].head_; index != kNullIndex; index = nodes_[index].next_) {
+      v.push_back(nodes_[index].contents_);
+    }
+    return v;
+  }
+
+  vector<Contents> WalkTailToHead(size_t list = 0) const {
+    vector<Contents> v;
+    for (Index index = ends_[list].tail_; index != kNullIndex; index = nodes_[index].prev_) {
+      v.push_back(nodes_[index].contents_);
+    }
+    return v;
+  }
+
+private:
+  // Pops a slot off the free list, or returns kNullIndex if there is none.
+  Index TakeFree() {
+    Index index = free_;
+    if (index != kNullIndex) {
+      free_ = nodes_[index].next_;
+      ++size_;
+    }
+    return index;
+  }
+
+  // Attaches an unlinked node at the head of list.
+  void LinkHead(Index index, size_t list) {
+    Ends& ends = ends_[list];
+    Node& node = nodes_[index];
+    node.prev_ = kNullIndex;
+    node.next_ = ends.head_;
+    if (ends.head_ != kNullIndex) {
+      nodes_[ends.head_].prev_ = index;
+    } else {
+      ends.tail_ = index;
+    }
+    ends.head_ = index;
+    ++ends.size_;
+  }
+
+  // Detaches a node linked on list, fixing up its neighbors and the
+  // list's ends.
+  void Unlink(Index index, size_t list) {
+    Ends& ends = ends_[list];
+    Node& node = nodes_[index];
+    if (node.prev_ != kNullIndex) {
+      nodes_[node.prev_].next_ = node.next_;
+    } else {
+      ends.head_ = node.next_;
+    }
+    if (node.next_ != kNullIndex) {
+      nodes_[node.next_].prev_ = node.prev_;
+    } else {
+      ends.tail_ = node.prev_;
+    }
+    node.next_ = node.prev_ = kNullIndex;
+    --ends.size_;
+  }
+
+  struct Ends {
+    Index head_ = kNullIndex;
+    Index tail_ = kNullIndex;
+    size_t size_ = 0;
+  };
+
+  vector<Node> nodes_;
+  array<Ends, kNumLists> ends_;
+  // Singly-linked (through next_) list of unused slots.
+  Index free_ = kNullIndex;
+  size_t size_ = 0;
+};
+
+#endif /* slab_list_hpp */
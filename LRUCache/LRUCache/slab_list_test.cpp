@@ -0,0 +1,155 @@
+//
+//  slab_list_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "slab_list_test.hpp"
+
+#include <string>
+#include <vector>
+
+#include "link_list.hpp"
+#include "slab_list.hpp"
+
+namespace {
+
+using List = SlabList<LinkList::Node::Contents>;
+
+using ContentsVector = vector<LinkList::Node::Contents>;
+
+} // namespace
+
+void SLAB_LIST_TEST_ONE_ITEM() {
+  List list(1);
+
+  // Empty list, no contents.
+  assert(list.IsEmpty());
+  assert(!list.IsFull());
+  assert(list.GetHead() == List::kNullIndex);
+  assert(list.GetTail() == List::kNullIndex);
+  assert(list.PopTail() == nullopt);
+
+  // Push a contents at the head, verify it's there and is the only contents.
+  LinkList::Node::Contents rose_node = make_tuple("rose", 10);
+  List::Index index = list.PushHead(rose_node);
+  assert(index != List::kNullIndex);
+  assert(list.IsFull());
+  assert(list.GetHead() == index);
+  assert(list.GetTail() == index);
+  assert(list.At(index).contents_ == rose_node);
+
+  // List is full, a second push fails.
+  assert(list.PushHead(make_tuple("mars", 20)) == List::kNullIndex);
+
+  // Pop the contents, list is empty again.
+  assert(list.PopTail() == rose_node);
+  assert(list.IsEmpty());
+  assert(list.GetHead() == List::kNullIndex);
+  assert(list.GetTail() == List::kNullIndex);
+}
+
+void SLAB_LIST_TEST_MULTIPLE_ITEMS() {
+  List list(3);
+  LinkList::Node::Contents rose_node = make_tuple("rose", 10);
+  LinkList::Node::Contents mars_node = make_tuple("mars", 20);
+  LinkList::Node::Contents zara_node = make_tuple("zara", 30);
+  ContentsVector vIncreasing = { rose_node, mars_node, zara_node };
+  ContentsVector vDecreasing = { zara_node, mars_node, rose_node };
+
+  // Push at the head, walking head to tail is reversed.
+  for (const LinkList::Node::Contents& contents : vIncreasing) {
+    list.PushHead(contents);
+  }
+  assert(list.Size() == 3);
+  assert(list.WalkHeadToTail() == vDecreasing);
+  assert(list.WalkTailToHead() == vIncreasing);
+
+  // Clear, the list is empty and all slots can be reused.
+  list.Clear();
+  assert(list.IsEmpty());
+  for (const LinkList::Node::Contents& contents : vDecreasing) {
+    assert(list.PushHead(contents) != List::kNullIndex);
+  }
+  assert(list.IsFull());
+  assert(list.WalkHeadToTail() == vIncreasing);
+}
+
+void SLAB_LIST_TEST_PROMOTE_AND_REMOVE() {
+  List list(3);
+  LinkList::Node::Contents rose_node = make_tuple("rose", 10);
+  LinkList::Node::Contents mars_node = make_tuple("mars", 20);
+  LinkList::Node::Contents zara_node = make_tuple("zara", 30);
+
+  // Zara is the head and Rose the tail.
+  List::Index rose = list.PushHead(rose_node);
+  List::Index mars = list.PushHead(mars_node);
+  List::Index zara = list.PushHead(zara_node);
+
+  // Promoting the head leaves the list unchanged.
+  list.PromoteNodeHead(zara);
+  ContentsVector expected = { zara_node, mars_node, rose_node };
+  assert(list.WalkHeadToTail() == expected);
+
+  // Promote the middle, then the tail.
+  list.PromoteNodeHead(mars);
+  expected = { mars_node, zara_node, rose_node };
+  assert(list.WalkHeadToTail() == expected);
+  list.PromoteNodeHead(rose);
+  expected = { rose_node, mars_node, zara_node };
+  assert(list.WalkHeadToTail() == expected);
+  expected = { zara_node, mars_node, rose_node };
+  assert(list.WalkTailToHead() == expected);
+
+  // Remove the middle node, its slot is the next one handed out.
+  list.Remove(mars);
+  expected = { rose_node, zara_node };
+  assert(list.WalkHeadToTail() == expected);
+  assert(list.WalkTailToHead() == ContentsVector({ zara_node, rose_node }));
+  assert(list.PushHead(mars_node) == mars);
+
+  // Pop the tail, its slot is the next one handed out.
+  assert(list.PopTail() == zara_node);
+  assert(list.GetTail() == rose);
+  assert(list.PushHead(zara_node) == zara);
+  expected = { zara_node, mars_node, rose_node };
+  assert(list.WalkHeadToTail() == expected);
+}
+
+void SLAB_LIST_TEST_MULTIPLE_LISTS() {
+  SlabList<LinkList::Node::Contents, 2> list(3);
+  LinkList::Node::Contents rose_node = make_tuple("rose", 10);
+  LinkList::Node::Contents mars_node = make_tuple("mars", 20);
+  LinkList::Node::Contents zara_node = make_tuple("zara", 30);
+
+  // Two lists share the slab.
+  list.PushHead(rose_node, 0);
+  List::Index mars = list.PushHead(mars_node, 1);
+  List::Index zara = list.PushHead(zara_node, 1);
+  assert(list.IsFull());
+  assert(list.ListSize(0) == 1 && list.ListSize(1) == 2);
+  assert(list.WalkHeadToTail(1) == ContentsVector({ zara_node, mars_node }));
+
+  // Move nodes between them.
+  list.MoveNodeHead(mars, 1, 0);
+  assert(list.WalkHeadToTail(0) == ContentsVector({ mars_node, rose_node }));
+  assert(list.GetHead(1) == zara && list.GetTail(1) == zara);
+  list.MoveNodeHead(zara, 1, 0);
+  assert(list.ListSize(1) == 0 && list.GetHead(1) == List::kNullIndex);
+  assert(list.ListSize(0) == 3);
+
+  // Removing from one frees a slot for the other.
+  list.Remove(mars, 0);
+  assert(list.PushHead(mars_node, 1) == mars);
+  assert(list.WalkTailToHead(0) == ContentsVector({ rose_node, zara_node }));
+  assert(list.PopTail(1) == mars_node);
+  assert(list.Size() == 2);
+}
+
+void RUN_SLAB_LIST_TESTS() {
+  SLAB_LIST_TEST_ONE_ITEM();
+  SLAB_LIST_TEST_MULTIPLE_ITEMS();
+  SLAB_LIST_TEST_PROMOTE_AND_REMOVE();
+  SLAB_LIST_TEST_MULTIPLE_LISTS();
+}
@@ -0,0 +1,13 @@
+//
+//  slab_list_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef slab_list_test_hpp
+#define slab_list_test_hpp
+
+extern void RUN_SLAB_LIST_TESTS();
+
+#endif /* slab_list_test_hpp */
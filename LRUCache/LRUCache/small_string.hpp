@@ -0,0 +1,114 @@
+//
+//  small_string.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef small_string_hpp
+#define small_string_hpp
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+using namespace std;
+
+// An immutable string for cache keys, which are mostly short identifiers:
+// strings of up to kInlineSize chars are stored inline, longer ones in a
+// heap buffer. It is the size of its inline buffer, rounded up to 8 bytes
+// (16 at least, to fit the heap pointer and 32-bit size): SmallString<15>, the
+// default, is 16 bytes where a std::string is 32, and holds as many chars
+// without allocating. SmallString<23> is 24 bytes, and holds 8 more.
+//
+// The last byte of the buffer tags it: an inline string's size, or
+// kHeapTag. Converts to string_view to be read; LRUCacheHash is
+// transparent over it, so a cache keyed by it can be looked up by string,
+// string_view or literal without building one.
+template <size_t kInlineSize = 15>
+class SmallString {
+public:
+  static_assert(kInlineSize < 128, "the inline size has to fit in the tag byte");
+
+  SmallString() { bytes_[kStorageSize - 1] = 0; }
+  explicit SmallString(string_view s) { Assign(s); }
+  SmallString(const SmallString& other) { Assign(other); }
+  SmallString(SmallString&& other) noexcept {
+    memcpy(bytes_, other.bytes_, kStorageSize);
+    other.bytes_[kStorageSize - 1] = 0;
+  }
+  SmallString& operator=(const SmallString& other) {
+    if (this != &other) {
+      Free();
+      Assign(other);
+    }
+    return *this;
+  }
+  SmallString& operator=(SmallString&& other) noexcept {
+    if (this != &other) {
+      Free();
+      memcpy(bytes_, other.bytes_, kStorageSize);
+      other.bytes_[kStorageSize - 1] = 0;
+    }
+    return *this;
+  }
+  // Not virtual, which would add a vtable pointer to every key.
+  ~SmallString() { Free(); }
+
+  const char* data() const { return IsInline() ? bytes_ : GetHeap().data_; }
+  size_t size() const { return IsInline() ? size_t(Tag()) : GetHeap().size_; }
+  bool empty() const { return size() == 0; }
+
+  // Returns whether the chars are in the object itself, not on the heap.
+  bool IsInline() const { return Tag() != kHeapTag; }
+
+  operator string_view() const { return string_view(data(), size()); }
+
+  friend bool operator==(const SmallString& a, string_view b) { return string_view(a) == b; }
+
+private:
+  // Held in the first 12 bytes of the buffer, clear of the tag.
+  struct Heap {
+    char* data_;
+    uint32_t size_;
+  };
+
+  static constexpr size_t kStorageSize = max<size_t>((kInlineSize + 1 + 7) / 8 * 8, 16);
+  static constexpr unsigned char kHeapTag = 0x80;
+
+  unsigned char Tag() const { return static_cast<unsigned char>(bytes_[kStorageSize - 1]); }
+
+  Heap GetHeap() const {
+    Heap heap;
+    memcpy(&heap, bytes_, offsetof(Heap, size_) + sizeof(heap.size_));
+    return heap;
+  }
+
+  // Copies s in, the string being empty.
+  void Assign(string_view s) {
+    if (s.size() < kStorageSize) {
+      memcpy(bytes_, s.data(), s.size());
+      bytes_[kStorageSize - 1] = static_cast<char>(s.size());
+      return;
+    }
+    assert(s.size() <= numeric_limits<uint32_t>::max());
+    Heap heap = { new char[s.size()], static_cast<uint32_t>(s.size()) };
+    memcpy(heap.data_, s.data(), s.size());
+    memcpy(bytes_, &heap, offsetof(Heap, size_) + sizeof(heap.size_));
+    bytes_[kStorageSize - 1] = static_cast<char>(kHeapTag);
+  }
+
+  void Free() {
+    if (!IsInline()) {
+      delete[] GetHeap().data_;
+    }
+  }
+
+  alignas(8) char bytes_[kStorageSize];
+};
+
+#endif /* small_string_hpp */
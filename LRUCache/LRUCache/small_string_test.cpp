@@ -0,0 +1,92 @@
+//
+//  small_string_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "small_string_test.hpp"
+#include "small_string.hpp"
+
+#include <cassert>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+#include "clock_cache.hpp"
+#include "lru_cache.hpp"
+
+using namespace std;
+
+void SMALL_STRING_TEST_INLINE_AND_HEAP() {
+  static_assert(sizeof(SmallString<>) == 16);
+  static_assert(sizeof(SmallString<7>) == 16);
+  static_assert(sizeof(SmallString<23>) == 24);
+
+  SmallString<> empty;
+  assert(empty.empty() && empty.IsInline() && empty == "");
+
+  // Up to 15 chars fit in 16 bytes, with the tag.
+  SmallString<> fifteen(string(15, 'r'));
+  assert(fifteen.IsInline() && fifteen.size() == 15 && fifteen == string(15, 'r'));
+  SmallString<> sixteen(string(16, 'r'));
+  assert(!sixteen.IsInline() && sixteen.size() == 16 && sixteen == string(16, 'r'));
+  assert(!(sixteen == string(15, 'r')));
+
+  SmallString<23> id("rose-0123456789-mars");
+  assert(id.IsInline() && string_view(id) == "rose-0123456789-mars");
+}
+
+void SMALL_STRING_TEST_COPY_AND_MOVE() {
+  for (const string& s : { string("rose"), string(40, 'm') }) {
+    SmallString<> original(s);
+    SmallString<> copy(original);
+    assert(copy == s && original == s);
+    assert(copy.data() != original.data());
+
+    SmallString<> moved(std::move(original));
+    assert(moved == s && original.empty());
+
+    SmallString<> assigned("zara");
+    assigned = copy;
+    assert(assigned == s);
+    assigned = std::move(moved);
+    assert(assigned == s && moved.empty());
+    SmallString<>& self = assigned;
+    assigned = self;
+    assert(assigned == s);
+  }
+}
+
+void SMALL_STRING_TEST_CACHE_KEYS() {
+  // Looked up by literal, string_view or string, without building keys.
+  LRUCache<SmallString<>, int> cache(2);
+  cache.Put("rose", 10);
+  cache.Put(string("mars"), 20);
+  assert(*cache.Get("rose") == 10);
+  assert(*cache.Get(string_view("mars")) == 20);
+  string long_id(40, 'z');
+  cache.Put(long_id, 30);
+  assert(!cache.Get("rose"));
+  assert(*cache.Get(long_id) == 30);
+
+  ClockCache<SmallString<>, int> clock_cache(2);
+  clock_cache.Put("rose", 10);
+  clock_cache.Put(long_id, 30);
+  assert(*clock_cache.Get("rose") == 10);
+  assert(*clock_cache.Get(string_view(long_id)) == 30);
+
+  // Snapshots encode them as they do strings.
+  string path = "/tmp/small_string_test_cache_keys";
+  assert(cache.SaveSnapshot(path));
+  LRUCache<SmallString<>, int> loaded(2);
+  assert(loaded.LoadSnapshot(path));
+  assert(*loaded.Get("mars") == 20 && *loaded.Get(long_id) == 30);
+  unlink(path.c_str());
+}
+
+void RUN_SMALL_STRING_TESTS() {
+  SMALL_STRING_TEST_INLINE_AND_HEAP();
+  SMALL_STRING_TEST_COPY_AND_MOVE();
+  SMALL_STRING_TEST_CACHE_KEYS();
+}
@@ -0,0 +1,13 @@
+//
+//  small_string_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef small_string_test_hpp
+#define small_string_test_hpp
+
+extern void RUN_SMALL_STRING_TESTS();
+
+#endif /* small_string_test_hpp */
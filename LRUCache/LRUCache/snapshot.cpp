@@ -0,0 +1,129 @@
+//
+//  snapshot.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "snapshot.hpp"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Writes all size bytes at data to fd, retrying short writes.
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+} // namespace
+
+uint64_t SnapshotChecksum(const char* data, size_t size) {
+  constexpr uint64_t kMultiplier = 0xff51afd7ed558ccd;
+  uint64_t h = 0x9E3779B97F4A7C15 ^ size;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    h = (h ^ word) * kMultiplier;
+    h ^= h >> 29;
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, size - i);
+    h = (h ^ word) * kMultiplier;
+    h ^= h >> 29;
+  }
+  return h ^ (h >> 32);
+}
+
+bool WriteSnapshotFile(const string& path, uint64_t num_entries, string_view payload) {
+  SnapshotHeader header = {};
+  memcpy(header.magic_, SnapshotHeader::kMagic, sizeof(header.magic_));
+  header.version_ = SnapshotHeader::kVersion;
+  header.header_size_ = sizeof(SnapshotHeader);
+  header.num_entries_ = num_entries;
+  header.payload_size_ = payload.size();
+  header.checksum_ = SnapshotChecksum(payload.data(), payload.size());
+
+  string temp_path = path + ".tmp";
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = WriteAll(fd, reinterpret_cast<const char*>(&header), sizeof(header)) &&
+            WriteAll(fd, payload.data(), payload.size()) &&
+            fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(temp_path.c_str(), path.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+MappedSnapshot::MappedSnapshot() {
+}
+
+MappedSnapshot::~MappedSnapshot() {
+  Close();
+}
+
+bool MappedSnapshot::Open(const string& path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(SnapshotHeader)) {
+    close(fd);
+    return false;
+  }
+  size_ = st.st_size;
+  data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    return false;
+  }
+  // The payload is read front to back, once.
+  madvise(data_, size_, MADV_SEQUENTIAL);
+
+  memcpy(&header_, data_, sizeof(header_));
+  payload_ = static_cast<const char*>(data_) + sizeof(header_);
+  // The checksum doesn't cover the header, so the entry count is only
+  // trusted as far as every entry taking a byte at least.
+  if (memcmp(header_.magic_, SnapshotHeader::kMagic, sizeof(header_.magic_)) != 0 ||
+      header_.version_ != SnapshotHeader::kVersion ||
+      header_.header_size_ != sizeof(SnapshotHeader) ||
+      header_.payload_size_ != size_ - sizeof(SnapshotHeader) ||
+      header_.num_entries_ > header_.payload_size_ ||
+      header_.checksum_ != SnapshotChecksum(payload_, header_.payload_size_)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedSnapshot::Close() {
+  if (data_) {
+    munmap(data_, size_);
+  }
+  header_ = {};
+  data_ = nullptr;
+  size_ = 0;
+  payload_ = nullptr;
+}
@@ -0,0 +1,175 @@
+//
+//  snapshot.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef snapshot_hpp
+#define snapshot_hpp
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "small_string.hpp"
+
+using namespace std;
+
+// Snapshot files, for warm restarts of a cache (see
+// LRUCache::SaveSnapshot()). A snapshot is a fixed header, then a payload
+// of entries encoded back to back by SnapshotCodec. The header holds a
+// magic number, a format version, the entry count, and a checksum of the
+// payload, so a truncated, corrupt or foreign file is rejected rather
+// than loaded. Every entry is encoded in one byte at least. Numbers are
+// in the machine's byte order: a snapshot is for restarting on the same
+// kind of machine, not for interchange.
+struct SnapshotHeader {
+  static constexpr char kMagic[8] = { 'L', 'R', 'U', 'S', 'N', 'A', 'P', '\0' };
+  static constexpr uint32_t kVersion = 1;
+
+  char magic_[8];
+  uint32_t version_;
+  uint32_t header_size_;
+  uint64_t num_entries_;
+  uint64_t payload_size_;
+  uint64_t checksum_;
+};
+
+// Returns a checksum of size bytes at data, a multiplicative hash taken a
+// word at a time. It catches corruption, it isn't cryptographic.
+uint64_t SnapshotChecksum(const char* data, size_t size);
+
+// Writes a snapshot of num_entries encoded in payload to path, atomically:
+// it is written to a temporary file, synced, then renamed over path.
+// Returns false if any of that fails.
+bool WriteSnapshotFile(const string& path, uint64_t num_entries, string_view payload);
+
+// A snapshot file mapped into memory, read-only.
+class MappedSnapshot {
+public:
+  MappedSnapshot();
+  virtual ~MappedSnapshot();
+  MappedSnapshot(const MappedSnapshot&) = delete;
+  MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+  // Maps the snapshot at path, and checks its header and checksum.
+  // Returns false if it can't be read or isn't a valid snapshot.
+  bool Open(const string& path);
+
+  uint64_t NumEntries() const { return header_.num_entries_; }
+  const char* Payload() const { return payload_; }
+  size_t PayloadSize() const { return header_.payload_size_; }
+
+private:
+  void Close();
+
+  SnapshotHeader header_ = {};
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  const char* payload_ = nullptr;
+};
+
+// Appends encoded entries to a snapshot's payload.
+class SnapshotWriter {
+public:
+  SnapshotWriter(string& payload) : payload_(payload) {}
+  virtual ~SnapshotWriter() {}
+
+  void Write(const void* data, size_t size) { payload_.append(static_cast<const char*>(data), size); }
+
+private:
+  string& payload_;
+};
+
+// Reads encoded entries back out of a snapshot's payload. Reads past the
+// end fail, rather than reading out of bounds.
+class SnapshotReader {
+public:
+  SnapshotReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+  virtual ~SnapshotReader() {}
+
+  bool Read(void* data, size_t size) {
+    if (size_t(end_ - pos_) < size) {
+      return false;
+    }
+    memcpy(data, pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  // Returns the next size bytes, without copying them, or nullptr if
+  // there aren't that many left.
+  const char* Skip(size_t size) {
+    if (size_t(end_ - pos_) < size) {
+      return nullptr;
+    }
+    const char* data = pos_;
+    pos_ += size;
+    return data;
+  }
+
+  bool AtEnd() const { return pos_ == end_; }
+
+private:
+  const char* pos_;
+  const char* end_;
+};
+
+// How a key or value type is encoded in snapshots. Trivially copyable
+// types are copied as bytes, strings are length-prefixed. Specialize it
+// for other types to snapshot caches of them.
+template <typename T, typename Enable = void>
+struct SnapshotCodec;
+
+template <typename T>
+struct SnapshotCodec<T, enable_if_t<is_trivially_copyable_v<T>>> {
+  static void Encode(const T& value, SnapshotWriter& writer) { writer.Write(&value, sizeof(T)); }
+  static bool Decode(SnapshotReader& reader, T& value) { return reader.Read(&value, sizeof(T)); }
+};
+
+template <>
+struct SnapshotCodec<string> {
+  static void Encode(const string& value, SnapshotWriter& writer) {
+    uint32_t size = static_cast<uint32_t>(value.size());
+    writer.Write(&size, sizeof(size));
+    writer.Write(value.data(), size);
+  }
+  static bool Decode(SnapshotReader& reader, string& value) {
+    uint32_t size;
+    if (!reader.Read(&size, sizeof(size))) {
+      return false;
+    }
+    const char* data = reader.Skip(size);
+    if (!data) {
+      return false;
+    }
+    value.assign(data, size);
+    return true;
+  }
+};
+
+template <size_t kInlineSize>
+struct SnapshotCodec<SmallString<kInlineSize>> {
+  static void Encode(const SmallString<kInlineSize>& value, SnapshotWriter& writer) {
+    uint32_t size = static_cast<uint32_t>(value.size());
+    writer.Write(&size, sizeof(size));
+    writer.Write(value.data(), size);
+  }
+  static bool Decode(SnapshotReader& reader, SmallString<kInlineSize>& value) {
+    uint32_t size;
+    if (!reader.Read(&size, sizeof(size))) {
+      return false;
+    }
+    const char* data = reader.Skip(size);
+    if (!data) {
+      return false;
+    }
+    value = SmallString<kInlineSize>(string_view(data, size));
+    return true;
+  }
+};
+
+#endif /* snapshot_hpp */
@@ -0,0 +1,97 @@
+//
+//  snapshot_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "snapshot_test.hpp"
+#include "snapshot.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+string ReadFile(const string& path) {
+  ifstream in(path, ios::binary);
+  return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+void WriteFile(const string& path, const string& contents) {
+  ofstream out(path, ios::binary | ios::trunc);
+  out << contents;
+}
+
+} // namespace
+
+void SNAPSHOT_TEST_ROUND_TRIP() {
+  string path = "/tmp/snapshot_test_round_trip";
+  string payload;
+  SnapshotWriter writer(payload);
+  SnapshotCodec<string>::Encode("rose", writer);
+  SnapshotCodec<int>::Encode(10, writer);
+  assert(WriteSnapshotFile(path, 1, payload));
+
+  MappedSnapshot snapshot;
+  assert(snapshot.Open(path));
+  assert(snapshot.NumEntries() == 1);
+  assert(string(snapshot.Payload(), snapshot.PayloadSize()) == payload);
+
+  SnapshotReader reader(snapshot.Payload(), snapshot.PayloadSize());
+  string key;
+  int value;
+  assert(SnapshotCodec<string>::Decode(reader, key) && key == "rose");
+  assert(SnapshotCodec<int>::Decode(reader, value) && value == 10);
+  assert(reader.AtEnd());
+  assert(!SnapshotCodec<int>::Decode(reader, value));
+  remove(path.c_str());
+}
+
+void SNAPSHOT_TEST_REJECTS_BAD_FILES() {
+  string path = "/tmp/snapshot_test_bad";
+  MappedSnapshot snapshot;
+  remove(path.c_str());
+  assert(!snapshot.Open(path));
+
+  assert(WriteSnapshotFile(path, 3, string(1000, 'x')));
+  string good = ReadFile(path);
+  assert(good.size() == sizeof(SnapshotHeader) + 1000);
+  assert(snapshot.Open(path));
+
+  // A flipped payload byte fails the checksum.
+  string bad = good;
+  bad[sizeof(SnapshotHeader) + 500] ^= 1;
+  WriteFile(path, bad);
+  assert(!snapshot.Open(path));
+
+  // So do truncation, a different version, and a foreign file.
+  WriteFile(path, good.substr(0, good.size() - 1));
+  assert(!snapshot.Open(path));
+  bad = good;
+  bad[offsetof(SnapshotHeader, version_)] += 1;
+  WriteFile(path, bad);
+  assert(!snapshot.Open(path));
+  // An entry count the payload can't hold isn't covered by the checksum,
+  // but is rejected before anything is decoded.
+  bad = good;
+  uint64_t num_entries = 1001;
+  memcpy(&bad[offsetof(SnapshotHeader, num_entries_)], &num_entries, sizeof(num_entries));
+  WriteFile(path, bad);
+  assert(!snapshot.Open(path));
+  WriteFile(path, "not a snapshot");
+  assert(!snapshot.Open(path));
+  remove(path.c_str());
+}
+
+void RUN_SNAPSHOT_TESTS() {
+  SNAPSHOT_TEST_ROUND_TRIP();
+  SNAPSHOT_TEST_REJECTS_BAD_FILES();
+}
@@ -0,0 +1,13 @@
+//
+//  snapshot_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef snapshot_test_hpp
+#define snapshot_test_hpp
+
+extern void RUN_SNAPSHOT_TESTS();
+
+#endif /* snapshot_test_hpp */
@@ -0,0 +1,138 @@
+//
+//  swiss_index.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "swiss_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+SwissIndex::SwissIndex() {
+}
+
+SwissIndex::~SwissIndex() {
+}
+
+void SwissIndex::Reserve(size_t num_entries) {
+  if (num_entries > MaxLoad(table_.capacity_)) {
+    Rehash(bit_ceil(max(kGroupWidth, num_entries + num_entries / 7 + 1)));
+  }
+}
+
+void SwissIndex::AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+  for (const Table* table : { &table_, &old_ }) {
+    usage.AddBlock(component, table->ctrl_.capacity());
+    usage.AddBlock(component, table->slots_.capacity() * sizeof(Slot));
+  }
+}
+
+void SwissIndex::Insert(uint64_t hash, Index index) {
+  MoveOldSlots(kRehashSlotsPerOp);
+  // Deleted slots count against the load, since they lengthen probes.
+  // If they are most of it, rehash to drop them, else grow. The old
+  // table's entries are on their way into the new one, so count too.
+  size_t capacity = table_.capacity_;
+  if (table_.size_ + old_.size_ + table_.num_deleted_ >= MaxLoad(capacity)) {
+    Rehash(Size() + 1 > MaxLoad(capacity) / 2 ? max(kGroupWidth, capacity * 2) : capacity);
+    MoveOldSlots(kRehashSlotsPerOp);
+  }
+  table_.Insert(Mix(hash), index);
+}
+
+bool SwissIndex::Erase(uint64_t hash, Index index) {
+  MoveOldSlots(kRehashSlotsPerOp);
+  uint32_t h = Mix(hash);
+  for (Table* table : { &table_, &old_ }) {
+    size_t i = table->FindSlot(h, index);
+    if (i != table->capacity_) {
+      table->EraseSlot(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SwissIndex::Rehash(size_t capacity) {
+  assert(has_single_bit(capacity) && capacity >= kGroupWidth);
+  MoveOldSlots(old_.capacity_);
+  old_ = Table(capacity);
+  swap(old_, table_);
+  num_moved_ = 0;
+}
+
+void SwissIndex::MoveOldSlots(size_t num_slots) {
+  if (!IsRehashing()) {
+    return;
+  }
+  size_t end = min(old_.capacity_, num_moved_ + num_slots);
+  for (; num_moved_ < end; ++num_moved_) {
+    if (old_.ctrl_[num_moved_] >= 0) {
+      const Slot& slot = old_.slots_[num_moved_];
+      table_.Insert(slot.hash_, slot.index_);
+      // A tombstone, so lookups in the old table still probe past it.
+      old_.SetCtrl(num_moved_, kDeleted);
+      --old_.size_;
+    }
+  }
+  if (num_moved_ == old_.capacity_) {
+    assert(old_.size_ == 0);
+    old_ = Table();
+  }
+}
+
+SwissIndex::Table::Table(size_t capacity)
+    : ctrl_(capacity + kGroupWidth, kEmpty), slots_(capacity), capacity_(capacity) {
+}
+
+size_t SwissIndex::Table::FindSlot(uint32_t h, Index index) const {
+  if (capacity_ == 0) {
+    return capacity_;
+  }
+
+  for (Probe probe(h, capacity_);; probe.Next()) {
+    const int8_t* group = &ctrl_[probe.pos_];
+    for (uint32_t mask = MatchByte(group, H2(h)); mask != 0; mask &= mask - 1) {
+      size_t i = probe.Offset(countr_zero(mask));
+      if (slots_[i].index_ == index) {
+        return i;
+      }
+    }
+    if (MatchByte(group, kEmpty) != 0) {
+      return capacity_;
+    }
+  }
+}
+
+void SwissIndex::Table::Insert(uint32_t h, Index index) {
+  for (Probe probe(h, capacity_);; probe.Next()) {
+    uint32_t mask = MatchFree(&ctrl_[probe.pos_]);
+    if (mask != 0) {
+      size_t i = probe.Offset(countr_zero(mask));
+      if (ctrl_[i] == kDeleted) {
+        --num_deleted_;
+      }
+      SetCtrl(i, H2(h));
+      slots_[i] = { h, index };
+      ++size_;
+      return;
+    }
+  }
+}
+
+void SwissIndex::Table::EraseSlot(size_t i) {
+  // If no probe can have passed over the slot while it was full (there
+  // is an empty slot within a group's width of it on both sides), it can
+  // go back to empty instead of becoming a tombstone.
+  uint32_t empty_before = MatchByte(&ctrl_[(i - kGroupWidth) & (capacity_ - 1)], kEmpty);
+  uint32_t empty_after = MatchByte(&ctrl_[i], kEmpty);
+  bool was_never_full = empty_before != 0 && empty_after != 0 &&
+                        countr_zero(empty_after) + countl_zero(uint16_t(empty_before)) < int(kGroupWidth);
+  SetCtrl(i, was_never_full ? kEmpty : kDeleted);
+  if (!was_never_full) {
+    ++num_deleted_;
+  }
+  --size_;
+}
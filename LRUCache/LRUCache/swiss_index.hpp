@@ -0,0 +1,233 @@
+//
+//  swiss_index.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef swiss_index_hpp
+#define swiss_index_hpp
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "memory_usage.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// An open-addressing hash index from keys to the slots that hold them in
+// some other storage (an LRUCache's slab), in the style of Abseil's Swiss
+// tables. Keys aren't stored, only a 32-bit hash of each and its slot
+// index, 8 bytes inline; Find() is given a predicate to check a candidate
+// slot's key. Each table slot also has a control byte, which holds 7 bits
+// of the hash, or marks the slot empty or deleted. Lookups compare a
+// group of 16 control bytes at once (with SSE2, where available), so they
+// usually touch one cache line of control bytes, one of slots, and then
+// only the storage slot whose key matches.
+//
+// Doesn't allocate once Reserve()d for the entries it holds. When it
+// does have to rehash, it does so incrementally: the old table is kept,
+// and looked up after the new one, while each Insert() and Erase() moves
+// kRehashSlotsPerOp of its slots across, so no single call pays for
+// rehashing the whole table.
+class SwissIndex {
+public:
+  using Index = uint32_t;
+  static constexpr Index kNullIndex = numeric_limits<Index>::max();
+  static constexpr size_t kGroupWidth = 16;
+  // Old table slots moved to the new one per Insert() or Erase(), while
+  // rehashing.
+  static constexpr size_t kRehashSlotsPerOp = 4 * kGroupWidth;
+
+  SwissIndex();
+  virtual ~SwissIndex();
+
+  size_t Size() const { return table_.size_ + old_.size_; }
+  size_t Capacity() const { return table_.capacity_; }
+
+  // Returns whether an old table is still being moved into a new one.
+  bool IsRehashing() const { return old_.capacity_ != 0; }
+
+  // Makes room for num_entries, so Insert() doesn't rehash until then.
+  void Reserve(size_t num_entries);
+
+  // Returns the index whose key hashes to hash and satisfies matches
+  // (called with candidate indices), or kNullIndex if there is none.
+  template <typename Matches>
+  Index Find(uint64_t hash, Matches matches) const {
+    uint32_t h = Mix(hash);
+    Index index = table_.Find(h, matches);
+    if (index == kNullIndex && IsRehashing()) {
+      index = old_.Find(h, matches);
+    }
+    return index;
+  }
+
+  // Adds index, whose key hashes to hash. The key must not already be in
+  // the index.
+  void Insert(uint64_t hash, Index index);
+
+  // Removes index, whose key hashes to hash. Returns false if it wasn't
+  // in the index.
+  bool Erase(uint64_t hash, Index index);
+
+  // Adds the tables, the old one too while rehashing, to component of
+  // usage.
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const;
+
+  // Prefetches where Find() for hash will start looking.
+  void Prefetch(uint64_t hash) const {
+    if (table_.capacity_ != 0) {
+      size_t pos = H1(Mix(hash)) & (table_.capacity_ - 1);
+      __builtin_prefetch(&table_.ctrl_[pos]);
+      __builtin_prefetch(&table_.slots_[pos]);
+    }
+  }
+
+private:
+  // Control bytes. Full slots' are 7 bits of the hash, so non-negative.
+  static constexpr int8_t kEmpty = -128;
+  static constexpr int8_t kDeleted = -2;
+
+  struct Slot {
+    uint32_t hash_;
+    Index index_;
+  };
+
+  // Walks the groups a hash probes, triangularly, which visits every group
+  // position of a power-of-2 table.
+  struct Probe {
+    Probe(uint32_t h, size_t capacity) : mask_(capacity - 1), pos_(H1(h) & mask_) {}
+    void Next() {
+      step_ += kGroupWidth;
+      pos_ = (pos_ + step_) & mask_;
+    }
+    // Returns the slot i places into the current group.
+    size_t Offset(size_t i) const { return (pos_ + i) & mask_; }
+
+    size_t mask_;
+    size_t pos_;
+    size_t step_ = 0;
+  };
+
+  // Scrambles a hash, std::hash of an integer being the integer, with
+  // MurmurHash3's 64-bit finalizer (fmix64), so its bits don't correlate
+  // with the multiplicative hash ShardedCache picks shards with.
+  static uint32_t Mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+    return static_cast<uint32_t>(hash);
+  }
+  static size_t H1(uint32_t h) { return h >> 7; }
+  static int8_t H2(uint32_t h) { return static_cast<int8_t>(h & 0x7F); }
+
+  // Returns a bit for each of the group's control bytes that is byte.
+  static uint32_t MatchByte(const int8_t* group, int8_t byte) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(byte))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= uint32_t(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Returns a bit for each of the group's empty or deleted slots, the
+  // control bytes with their high bit set.
+  static uint32_t MatchFree(const int8_t* group) {
+#ifdef __SSE2__
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= uint32_t(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Returns how many entries a table of capacity holds before rehashing.
+  static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+  // One open-addressing table, of a power of 2 slots (or none).
+  struct Table {
+    Table() {}
+    Table(size_t capacity);
+
+    template <typename Matches>
+    Index Find(uint32_t h, Matches matches) const {
+      if (capacity_ == 0) {
+        return kNullIndex;
+      }
+
+      for (Probe probe(h, capacity_);; probe.Next()) {
+        const int8_t* group = &ctrl_[probe.pos_];
+        for (uint32_t mask = MatchByte(group, H2(h)); mask != 0; mask &= mask - 1) {
+          const Slot& slot = slots_[probe.Offset(countr_zero(mask))];
+          if (slot.hash_ == h && matches(slot.index_)) {
+            return slot.index_;
+          }
+        }
+        // Probing stops at the first group with an empty slot, since an
+        // insert would have used it.
+        if (MatchByte(group, kEmpty) != 0) {
+          return kNullIndex;
+        }
+      }
+    }
+
+    // Returns the slot holding index, whose key's mixed hash is h, or
+    // capacity_ if there is none.
+    size_t FindSlot(uint32_t h, Index index) const;
+
+    // Puts an entry in the first free slot it probes. There must be one.
+    void Insert(uint32_t h, Index index);
+
+    // Empties slot i, which must be full.
+    void EraseSlot(size_t i);
+
+    // Sets slot i's control byte, and its mirror past the end.
+    void SetCtrl(size_t i, int8_t ctrl) {
+      ctrl_[i] = ctrl;
+      if (i < kGroupWidth) {
+        ctrl_[capacity_ + i] = ctrl;
+      }
+    }
+
+    // capacity_ + kGroupWidth control bytes, the last kGroupWidth
+    // mirroring the first, so a group can be loaded at any position.
+    vector<int8_t> ctrl_;
+    vector<Slot> slots_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    size_t num_deleted_ = 0;
+  };
+
+  // Starts rehashing into a new table of capacity, a power of 2, which
+  // drops tombstones. Finishes any rehash in progress first.
+  void Rehash(size_t capacity);
+
+  // Moves up to num_slots more of the old table's slots into the new one,
+  // and frees the old table once they all have been.
+  void MoveOldSlots(size_t num_slots);
+
+  Table table_;
+  // The table being rehashed from, and how many of its slots have been
+  // moved into table_ so far.
+  Table old_;
+  size_t num_moved_ = 0;
+};
+
+#endif /* swiss_index_hpp */
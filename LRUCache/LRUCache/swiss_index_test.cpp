@@ -0,0 +1,145 @@
+//
+//  swiss_index_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "swiss_index_test.hpp"
+#include "swiss_index.hpp"
+
+#include <cassert>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+void SWISS_INDEX_TEST_INSERT_FIND_ERASE() {
+  // The index maps keys to their slots in this storage.
+  vector<string> keys = { "rose", "mars", "zara" };
+  hash<string> hasher;
+  SwissIndex index;
+  auto find = [&](const string& key) {
+    return index.Find(hasher(key), [&](SwissIndex::Index i) { return keys[i] == key; });
+  };
+
+  assert(find("rose") == SwissIndex::kNullIndex);
+  for (SwissIndex::Index i = 0; i < keys.size(); ++i) {
+    index.Insert(hasher(keys[i]), i);
+  }
+  assert(index.Size() == 3);
+  assert(find("rose") == 0);
+  assert(find("mars") == 1);
+  assert(find("zara") == 2);
+  assert(find("luna") == SwissIndex::kNullIndex);
+
+  assert(index.Erase(hasher("mars"), 1));
+  assert(!index.Erase(hasher("mars"), 1));
+  assert(find("mars") == SwissIndex::kNullIndex);
+  assert(find("zara") == 2);
+  assert(index.Size() == 2);
+}
+
+void SWISS_INDEX_TEST_COLLISIONS() {
+  // Every key has the same hash, so all of them share a probe sequence
+  // (spanning several groups), and only the predicate tells them apart.
+  constexpr int kNumKeys = 100;
+  SwissIndex index;
+  for (SwissIndex::Index i = 0; i < kNumKeys; ++i) {
+    index.Insert(42, i);
+  }
+  for (SwissIndex::Index i = 0; i < kNumKeys; ++i) {
+    assert(index.Find(42, [i](SwissIndex::Index j) { return i == j; }) == i);
+  }
+
+  // Erasing from the middle of the sequence leaves the rest findable.
+  for (SwissIndex::Index i = 0; i < kNumKeys; i += 2) {
+    assert(index.Erase(42, i));
+  }
+  for (SwissIndex::Index i = 0; i < kNumKeys; ++i) {
+    SwissIndex::Index found = index.Find(42, [i](SwissIndex::Index j) { return i == j; });
+    assert(found == (i % 2 == 0 ? SwissIndex::kNullIndex : i));
+  }
+}
+
+void SWISS_INDEX_TEST_RANDOM() {
+  // Churn through many more keys than are ever in the index at once,
+  // checking against an unordered_map, and that erasing keeps the table
+  // from growing.
+  constexpr int kMaxSize = 1000;
+  SwissIndex index;
+  index.Reserve(kMaxSize);
+  size_t capacity = index.Capacity();
+  unordered_map<uint64_t, SwissIndex::Index> expected;
+  vector<uint64_t> keys;
+  minstd_rand rng(1);
+  for (int n = 0; n < 200000; ++n) {
+    if (expected.size() < kMaxSize && rng() % 2 == 0) {
+      uint64_t key = rng();
+      if (expected.count(key) == 0) {
+        index.Insert(key, n);
+        expected[key] = n;
+        keys.push_back(key);
+      }
+    } else if (!keys.empty()) {
+      size_t k = rng() % keys.size();
+      assert(index.Erase(keys[k], expected[keys[k]]));
+      expected.erase(keys[k]);
+      keys[k] = keys.back();
+      keys.pop_back();
+    }
+
+    uint64_t key = rng() % 2 == 0 && !keys.empty() ? keys[rng() % keys.size()] : rng();
+    SwissIndex::Index found = index.Find(key, [&](SwissIndex::Index i) {
+      return expected.count(key) != 0 && expected[key] == i;
+    });
+    assert(found == (expected.count(key) != 0 ? expected[key] : SwissIndex::kNullIndex));
+    assert(index.Size() == expected.size());
+  }
+  assert(index.Capacity() == capacity);
+}
+
+void SWISS_INDEX_TEST_INCREMENTAL_REHASH() {
+  // Without Reserve(), the index grows as it fills, moving entries to the
+  // new table a few groups per insert or erase. Every entry stays findable
+  // throughout, in whichever table it is in.
+  constexpr SwissIndex::Index kNumKeys = 5000;
+  SwissIndex index;
+  auto find = [&index](SwissIndex::Index key) {
+    return index.Find(key * 0x9e3779b97f4a7c15, [key](SwissIndex::Index i) { return i == key; });
+  };
+  size_t num_rehashing = 0;
+  for (SwissIndex::Index key = 0; key < kNumKeys; ++key) {
+    index.Insert(key * 0x9e3779b97f4a7c15, key);
+    num_rehashing += index.IsRehashing();
+    assert(index.Size() == key + 1);
+    for (SwissIndex::Index k = key % 7; k <= key; k += 97) {
+      assert(find(k) == k);
+    }
+  }
+  assert(num_rehashing > 0 && num_rehashing < kNumKeys);
+  assert(index.Capacity() >= kNumKeys);
+
+  // Grow once more, then erase every other key while it rehashes.
+  for (SwissIndex::Index key = kNumKeys; !index.IsRehashing(); ++key) {
+    index.Insert(key * 0x9e3779b97f4a7c15, key);
+  }
+  size_t size = index.Size();
+  for (SwissIndex::Index key = 0; key < kNumKeys; key += 2) {
+    assert(index.Erase(key * 0x9e3779b97f4a7c15, key));
+  }
+  assert(!index.IsRehashing());
+  assert(index.Size() == size - kNumKeys / 2);
+  for (SwissIndex::Index key = 0; key < kNumKeys; ++key) {
+    assert(find(key) == (key % 2 == 0 ? SwissIndex::kNullIndex : key));
+  }
+}
+
+void RUN_SWISS_INDEX_TESTS() {
+  SWISS_INDEX_TEST_INSERT_FIND_ERASE();
+  SWISS_INDEX_TEST_COLLISIONS();
+  SWISS_INDEX_TEST_RANDOM();
+  SWISS_INDEX_TEST_INCREMENTAL_REHASH();
+}
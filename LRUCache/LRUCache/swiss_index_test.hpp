@@ -0,0 +1,13 @@
+//
+//  swiss_index_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef swiss_index_test_hpp
+#define swiss_index_test_hpp
+
+extern void RUN_SWISS_INDEX_TESTS();
+
+#endif /* swiss_index_test_hpp */
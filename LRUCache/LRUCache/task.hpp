@@ -0,0 +1,166 @@
+//
+//  task.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef task_hpp
+#define task_hpp
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace std;
+
+// A coroutine that returns a T, for loaders (see LRUCache::GetAsync()).
+// It starts suspended, and runs when awaited, by one coroutine, which it
+// resumes once it has returned (by symmetric transfer, returning its
+// handle from await_suspend()). An exception it throws is rethrown to its
+// awaiter.
+// Code that isn't a coroutine can Start() it, and read its Result() once
+// IsDone(). T can't be void.
+template <typename T>
+class Task {
+public:
+  class promise_type {
+  public:
+    Task get_return_object() { return Task(coroutine_handle<promise_type>::from_promise(*this)); }
+    suspend_always initial_suspend() noexcept { return {}; }
+
+    // Resumes the awaiter, if there is one.
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      coroutine_handle<> await_suspend(coroutine_handle<promise_type> task) noexcept {
+        return task.promise().continuation_;
+      }
+      void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void return_value(T value) { result_.template emplace<1>(std::move(value)); }
+    void unhandled_exception() { result_.template emplace<2>(current_exception()); }
+
+  private:
+    friend class Task;
+
+    variant<monostate, T, exception_ptr> result_;
+    coroutine_handle<> continuation_ = noop_coroutine();
+  };
+
+  Task(Task&& other) noexcept : task_(exchange(other.task_, nullptr)) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Destroy();
+      task_ = exchange(other.task_, nullptr);
+    }
+    return *this;
+  }
+  virtual ~Task() { Destroy(); }
+
+  // Runs the task until it first suspends, or returns.
+  void Start() {
+    assert(task_ && !task_.done());
+    task_.resume();
+  }
+
+  bool IsDone() const { return task_.done(); }
+
+  // Returns what the task returned, or rethrows what it threw. Only once.
+  T Result() {
+    assert(task_.done());
+    variant<monostate, T, exception_ptr>& result = task_.promise().result_;
+    if (result.index() == 2) {
+      rethrow_exception(get<2>(result));
+    }
+    return std::move(get<1>(result));
+  }
+
+  // Awaiting runs the task, and resumes the awaiter once it is done.
+  bool await_ready() const noexcept { return false; }
+  coroutine_handle<> await_suspend(coroutine_handle<> awaiter) noexcept {
+    task_.promise().continuation_ = awaiter;
+    return task_;
+  }
+  T await_resume() { return Result(); }
+
+private:
+  explicit Task(coroutine_handle<promise_type> task) : task_(task) {}
+
+  void Destroy() {
+    if (task_) {
+      task_.destroy();
+    }
+  }
+
+  coroutine_handle<promise_type> task_;
+};
+
+// A coroutine that runs as soon as it is called, and frees itself when it
+// returns. Nothing awaits it, so it must not throw.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    suspend_never initial_suspend() noexcept { return {}; }
+    suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { terminate(); }
+  };
+};
+
+// A load of a Value in progress, shared by the coroutines waiting for it
+// (see LRUCache::GetAsync()).
+template <typename Value>
+class AsyncLoad {
+public:
+  bool IsDone() const { return done_; }
+
+  // Has awaiter resumed once the load is done, after those added before.
+  void AddWaiter(coroutine_handle<> awaiter) {
+    assert(!done_);
+    waiters_.push_back(awaiter);
+  }
+
+  // Ends the load with value, or with the exception thrown loading it, and
+  // resumes the waiters.
+  void SetValue(Value value) {
+    value_.emplace(std::move(value));
+    Finish();
+  }
+  void SetException(exception_ptr exception) {
+    exception_ = std::move(exception);
+    Finish();
+  }
+
+  // Returns a copy of the value loaded, or rethrows the exception.
+  Value Result() const {
+    assert(done_);
+    if (exception_) {
+      rethrow_exception(exception_);
+    }
+    return *value_;
+  }
+
+private:
+  // Waiters run inline, and may do anything, so they are moved out before
+  // any is resumed.
+  void Finish() {
+    done_ = true;
+    vector<coroutine_handle<>> waiters = std::move(waiters_);
+    for (coroutine_handle<> waiter : waiters) {
+      waiter.resume();
+    }
+  }
+
+  vector<coroutine_handle<>> waiters_;
+  optional<Value> value_;
+  exception_ptr exception_;
+  bool done_ = false;
+};
+
+#endif /* task_hpp */
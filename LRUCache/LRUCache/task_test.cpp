@@ -0,0 +1,141 @@
+//
+//  task_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "task_test.hpp"
+#include "task.hpp"
+
+#include <cassert>
+#include <coroutine>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// Suspends its awaiter, keeping its handle to be resumed by the test.
+struct Pause {
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(coroutine_handle<> awaiter) { *paused_ = awaiter; }
+  void await_resume() const noexcept {}
+
+  coroutine_handle<>* paused_;
+};
+
+Task<int> Answer(coroutine_handle<>* paused) {
+  if (paused) {
+    co_await Pause{ paused };
+  }
+  co_return 42;
+}
+
+Task<string> Describe(coroutine_handle<>* paused) {
+  int answer = co_await Answer(paused);
+  co_return "answer " + to_string(answer);
+}
+
+// Awaits a chain of depth tasks, each resuming the one before it as it
+// returns.
+Task<int> Chain(int depth) {
+  if (depth == 0) {
+    co_return 0;
+  }
+  co_return co_await Chain(depth - 1) + 1;
+}
+
+Task<int> Fail() {
+  throw runtime_error("failed");
+  co_return 0;
+}
+
+Task<int> Recover() {
+  try {
+    co_return co_await Fail();
+  } catch (const runtime_error&) {
+    co_return -1;
+  }
+}
+
+Task<int> Await(AsyncLoad<int>& load, coroutine_handle<>* paused) {
+  co_await Pause{ paused };
+  co_return load.Result();
+}
+
+} // namespace
+
+void TASK_TEST_AWAIT() {
+  // A task runs only once started, and then until it first suspends.
+  Task<string> task = Describe(nullptr);
+  assert(!task.IsDone());
+  task.Start();
+  assert(task.IsDone() && task.Result() == "answer 42");
+
+  // Resuming the innermost task resumes its awaiters.
+  coroutine_handle<> paused;
+  Task<string> paused_task = Describe(&paused);
+  paused_task.Start();
+  assert(!paused_task.IsDone() && paused);
+  paused.resume();
+  assert(paused_task.IsDone() && paused_task.Result() == "answer 42");
+
+  Task<int> chain = Chain(1000);
+  chain.Start();
+  assert(chain.Result() == 1000);
+}
+
+void TASK_TEST_EXCEPTION() {
+  Task<int> failed = Fail();
+  failed.Start();
+  assert(failed.IsDone());
+  bool thrown = false;
+  try {
+    failed.Result();
+  } catch (const runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // An awaiter gets the exception.
+  Task<int> recovered = Recover();
+  recovered.Start();
+  assert(recovered.Result() == -1);
+}
+
+void TASK_TEST_ASYNC_LOAD() {
+  // Waiters are resumed in the order they were added, and each reads the
+  // value.
+  AsyncLoad<int> load;
+  coroutine_handle<> first, second;
+  Task<int> first_task = Await(load, &first);
+  Task<int> second_task = Await(load, &second);
+  first_task.Start();
+  second_task.Start();
+  load.AddWaiter(first);
+  load.AddWaiter(second);
+  assert(!load.IsDone());
+  load.SetValue(7);
+  assert(load.IsDone());
+  assert(first_task.IsDone() && first_task.Result() == 7);
+  assert(second_task.IsDone() && second_task.Result() == 7);
+  assert(load.Result() == 7);
+
+  AsyncLoad<int> failed;
+  failed.SetException(make_exception_ptr(runtime_error("failed")));
+  bool thrown = false;
+  try {
+    failed.Result();
+  } catch (const runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void RUN_TASK_TESTS() {
+  TASK_TEST_AWAIT();
+  TASK_TEST_EXCEPTION();
+  TASK_TEST_ASYNC_LOAD();
+}
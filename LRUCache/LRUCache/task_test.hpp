@@ -0,0 +1,13 @@
+//
+//  task_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef task_test_hpp
+#define task_test_hpp
+
+extern void RUN_TASK_TESTS();
+
+#endif /* task_test_hpp */
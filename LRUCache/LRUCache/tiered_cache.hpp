@@ -0,0 +1,130 @@
+//
+//  tiered_cache.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef tiered_cache_hpp
+#define tiered_cache_hpp
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "lru_cache.hpp"
+#include "segment_log.hpp"
+#include "snapshot.hpp"
+
+using namespace std;
+
+// A two-tier cache for working sets bigger than memory: an LRUCache in
+// memory, whose evicted entries spill to a SegmentLog on local disk. A
+// miss in memory is looked up on disk, with one read, and a hit there is
+// moved back into memory (which may spill another entry in its place).
+// Disk space is reclaimed by the log's background compaction, and the log
+// drops its oldest segments when it is full.
+//
+// Keys and values are written to disk with their SnapshotCodec. Erased
+// and expired entries aren't spilled, only evicted ones. Like LRUCache,
+// not thread-safe (the log is, for its compaction thread).
+template <typename Key, typename Value, typename Hash = LRUCacheHash<Key>, typename Eq = equal_to<>>
+class TieredCache {
+public:
+  using MemoryCache = LRUCache<Key, Value, Hash, Eq>;
+
+  // A cache of max_size entries in memory, and about max_disk_bytes in a
+  // SegmentLog in directory, see there.
+  TieredCache(size_t max_size, const string& directory, uint64_t max_disk_bytes,
+              size_t segment_bytes = SegmentLog::kDefaultSegmentBytes, bool background_compaction = true)
+      : memory_(max_size), disk_(directory, max_disk_bytes, segment_bytes, background_compaction) {
+    memory_.SetEvictionListener([this](const Key& key, const Value& value, RemovalCause cause) {
+      if (cause == RemovalCause::kEvicted) {
+        Spill(key, value);
+      }
+    });
+  }
+  virtual ~TieredCache() {}
+
+  // Caches value under key in memory, see LRUCache::Put(). Any copy on
+  // disk is dropped, being stale.
+  template <typename K>
+  bool Put(K&& key, Value value) {
+    disk_.Erase(Hash()(key));
+    return memory_.Put(std::forward<K>(key), std::move(value));
+  }
+
+  // Returns a pointer to the cached value, from memory or promoted there
+  // from disk, or nullptr if key is in neither. The pointer is only valid
+  // until the next call that modifies the cache.
+  template <typename K>
+  Value* Get(const K& key) {
+    if (Value* value = memory_.Get(key)) {
+      return value;
+    }
+
+    Key owned_key(key);
+    EncodeKey(owned_key);
+    optional<string> encoded_value = disk_.Lookup(Hash()(key), key_buffer_, true);
+    if (!encoded_value) {
+      ++num_disk_misses_;
+      return nullptr;
+    }
+    SnapshotReader reader(encoded_value->data(), encoded_value->size());
+    Value value;
+    if (!SnapshotCodec<Value>::Decode(reader, value) || !reader.AtEnd()) {
+      ++num_disk_misses_;
+      return nullptr;
+    }
+    ++num_disk_hits_;
+    memory_.Put(std::move(owned_key), std::move(value));
+    return memory_.Peek(key);
+  }
+
+  // Removes key from both tiers. Returns false if it was in neither.
+  template <typename K>
+  bool Erase(const K& key) {
+    bool erased_from_disk = disk_.Erase(Hash()(key));
+    bool erased_from_memory = memory_.Erase(key);
+    return erased_from_disk || erased_from_memory;
+  }
+
+  // Returns the number of entries in memory, and on disk.
+  size_t MemorySize() const { return memory_.Size(); }
+  size_t DiskSize() const { return disk_.Size(); }
+
+  // Returns how many memory misses were hits, and misses, on disk.
+  uint64_t NumDiskHits() const { return num_disk_hits_; }
+  uint64_t NumDiskMisses() const { return num_disk_misses_; }
+
+  MemoryCache& Memory() { return memory_; }
+  SegmentLog& Disk() { return disk_; }
+
+private:
+  // Writes an evicted entry to disk.
+  void Spill(const Key& key, const Value& value) {
+    EncodeKey(key);
+    value_buffer_.clear();
+    SnapshotWriter writer(value_buffer_);
+    SnapshotCodec<Value>::Encode(value, writer);
+    disk_.Append(Hash()(key), key_buffer_, value_buffer_);
+  }
+
+  // Encodes key into key_buffer_.
+  void EncodeKey(const Key& key) {
+    key_buffer_.clear();
+    SnapshotWriter writer(key_buffer_);
+    SnapshotCodec<Key>::Encode(key, writer);
+  }
+
+  MemoryCache memory_;
+  SegmentLog disk_;
+  // Reused to encode keys and values.
+  string key_buffer_;
+  string value_buffer_;
+  uint64_t num_disk_hits_ = 0;
+  uint64_t num_disk_misses_ = 0;
+};
+
+#endif /* tiered_cache_hpp */
@@ -0,0 +1,64 @@
+//
+//  tiered_cache_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "tiered_cache_test.hpp"
+#include "tiered_cache.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+constexpr char kDirectory[] = "/tmp/tiered_cache_test";
+
+} // namespace
+
+void TIERED_CACHE_TEST_SPILL_AND_PROMOTE() {
+  TieredCache<string, string> cache(10, kDirectory, 1 << 20);
+  for (int i = 0; i < 100; ++i) {
+    cache.Put("key" + to_string(i), "value" + to_string(i));
+  }
+  assert(cache.MemorySize() == 10);
+  assert(cache.DiskSize() == 90);
+
+  // Every key is still there, from one tier or the other. Hits on disk
+  // come back into memory, and push others out to disk, so going through
+  // the keys in order, every one is on disk by the time it is looked up.
+  for (int i = 0; i < 100; ++i) {
+    string* value = cache.Get("key" + to_string(i));
+    assert(value && *value == "value" + to_string(i));
+  }
+  assert(cache.NumDiskHits() == 100);
+  assert(cache.MemorySize() == 10 && cache.DiskSize() == 90);
+  assert(cache.Memory().Peek("key99") != nullptr);
+  assert(cache.Get("key100") == nullptr);
+  assert(cache.NumDiskMisses() == 1);
+}
+
+void TIERED_CACHE_TEST_STALE() {
+  TieredCache<int, int> cache(1, kDirectory, 1 << 20);
+  cache.Put(1, 10);
+  cache.Put(2, 20);
+  assert(cache.DiskSize() == 1);
+
+  // A new value for a spilled key replaces it, and erasing erases both.
+  cache.Put(1, 11);
+  assert(*cache.Get(1) == 11);
+  assert(*cache.Get(2) == 20);
+  assert(cache.Erase(1));
+  assert(cache.Get(1) == nullptr);
+  assert(!cache.Erase(1));
+}
+
+void RUN_TIERED_CACHE_TESTS() {
+  TIERED_CACHE_TEST_SPILL_AND_PROMOTE();
+  TIERED_CACHE_TEST_STALE();
+  filesystem::remove_all(kDirectory);
+}
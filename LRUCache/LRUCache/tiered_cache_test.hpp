@@ -0,0 +1,13 @@
+//
+//  tiered_cache_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef tiered_cache_test_hpp
+#define tiered_cache_test_hpp
+
+extern void RUN_TIERED_CACHE_TESTS();
+
+#endif /* tiered_cache_test_hpp */
@@ -0,0 +1,182 @@
+//
+//  timer_wheel.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace {
+
+constexpr uint64_t kSlotMask = TimerWheel::kNumSlots - 1;
+
+// Returns the number of ticks one slot at level spans.
+constexpr int LevelShift(int level) {
+  return level * TimerWheel::kSlotBits;
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {
+  for (int level = 0; level < kNumLevels; ++level) {
+    fill(begin(heads_[level]), end(heads_[level]), kNullId);
+    occupied_[level] = 0;
+  }
+}
+
+TimerWheel::~TimerWheel() {
+}
+
+void TimerWheel::Reserve(size_t num_ids) {
+  assert(num_ids <= kNullId);
+  if (timers_.size() < num_ids) {
+    timers_.resize(num_ids);
+  }
+}
+
+void TimerWheel::Schedule(Id id, uint64_t expiry) {
+  if (id >= timers_.size()) {
+    // Grow geometrically, IDs are usually handed out densely.
+    Reserve(max<size_t>(id + 1, timers_.size() * 2));
+  }
+
+  Cancel(id);
+  timers_[id].expiry_ = expiry;
+  Link(id, now_ + 1);
+  ++size_;
+}
+
+void TimerWheel::Cancel(Id id) {
+  if (!IsScheduled(id)) {
+    return;
+  }
+
+  Unlink(id);
+  --size_;
+}
+
+bool TimerWheel::Advance(uint64_t now, size_t max_work, const function<void(Id)>& on_expired) {
+  size_t work = 0;
+
+  while (now_ < now) {
+    if (size_ == 0) {
+      // Nothing to do on any tick.
+      now_ = now;
+      break;
+    }
+
+    // Process the next tick with anything to do.
+    uint64_t tick = min(GetNextEventTick(), now);
+
+    // Cascade, from the highest level down, each level this tick is the
+    // start of a slot for.
+    for (int level = kNumLevels - 1; level > 0; --level) {
+      if ((tick & ((uint64_t(1) << LevelShift(level)) - 1)) != 0) {
+        continue;
+      }
+      Id* head = &heads_[level][(tick >> LevelShift(level)) & kSlotMask];
+      while (*head != kNullId) {
+        if (work == max_work) {
+          now_ = tick - 1;
+          return false;
+        }
+        Id id = *head;
+        Unlink(id);
+        Link(id, tick);
+        ++work;
+      }
+    }
+
+    // Expire everything in this tick's level 0 slot.
+    Id* head = &heads_[0][tick & kSlotMask];
+    while (*head != kNullId) {
+      if (work == max_work) {
+        now_ = tick - 1;
+        return false;
+      }
+      Id id = *head;
+      Unlink(id);
+      --size_;
+      ++work;
+      on_expired(id);
+    }
+
+    now_ = tick;
+  }
+
+  return true;
+}
+
+void TimerWheel::Link(Id id, uint64_t tick) {
+  Timer& timer = timers_[id];
+  uint64_t expiry = max(timer.expiry_, tick);
+  uint64_t delta = expiry - tick;
+
+  // The lowest level whose span reaches expiry, and the slot in it that
+  // time will reach (and cascade, or expire) first.
+  int level = delta == 0 ? 0 : (bit_width(delta) - 1) / kSlotBits;
+  uint64_t slot;
+  if (level < kNumLevels) {
+    slot = (expiry >> LevelShift(level)) & kSlotMask;
+  } else {
+    // Out of range. Park it in the top level slot that will be cascaded
+    // last, which is still well before it expires.
+    level = kNumLevels - 1;
+    slot = ((tick >> LevelShift(level)) + kNumSlots - 1) & kSlotMask;
+  }
+
+  timer.level_ = static_cast<uint8_t>(level);
+  timer.slot_ = static_cast<uint8_t>(slot);
+  timer.prev_ = kNullId;
+  timer.next_ = heads_[level][slot];
+  if (timer.next_ != kNullId) {
+    timers_[timer.next_].prev_ = id;
+  }
+  heads_[level][slot] = id;
+  occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::Unlink(Id id) {
+  Timer& timer = timers_[id];
+  assert(timer.level_ != kUnscheduled);
+
+  if (timer.prev_ != kNullId) {
+    timers_[timer.prev_].next_ = timer.next_;
+  } else {
+    heads_[timer.level_][timer.slot_] = timer.next_;
+    if (timer.next_ == kNullId) {
+      occupied_[timer.level_] &= ~(uint64_t(1) << timer.slot_);
+    }
+  }
+  if (timer.next_ != kNullId) {
+    timers_[timer.next_].prev_ = timer.prev_;
+  }
+
+  timer.next_ = timer.prev_ = kNullId;
+  timer.level_ = kUnscheduled;
+}
+
+uint64_t TimerWheel::GetNextEventTick() const {
+  uint64_t next_tick = numeric_limits<uint64_t>::max();
+
+  for (int level = 0; level < kNumLevels; ++level) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+
+    // Slots are reached in order after the current one, wrapping around,
+    // so rotate the current one's successor down to bit 0 and find the
+    // first occupied slot from there. Each slot is reached at the start
+    // of its span.
+    uint64_t current = now_ >> LevelShift(level);
+    int distance = countr_zero(rotr(occupied_[level], int((current + 1) & kSlotMask))) + 1;
+    next_tick = min(next_tick, (current + distance) << LevelShift(level));
+  }
+
+  return next_tick;
+}
@@ -0,0 +1,111 @@
+//
+//  timer_wheel.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef timer_wheel_hpp
+#define timer_wheel_hpp
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "memory_usage.hpp"
+
+using namespace std;
+
+// A hierarchical timer wheel, for scheduling many timers with O(1)
+// Schedule() and Cancel(). Timers are identified by small integer IDs
+// (an LRUCache uses its slab indices), and time is measured in ticks.
+//
+// There are kNumLevels wheels of kNumSlots slots each. A level 0 slot
+// holds the timers expiring on one tick, a level 1 slot those expiring
+// within kNumSlots ticks, and so on. When time reaches a higher level
+// slot, its timers are cascaded down to the lower levels, until they
+// reach level 0 and expire. Timers further out than the top level can
+// reach are parked in it, and cascaded again until they are in range.
+class TimerWheel {
+public:
+  using Id = uint32_t;
+
+  static constexpr int kNumLevels = 4;
+  static constexpr int kSlotBits = 6;
+  static constexpr int kNumSlots = 1 << kSlotBits;
+
+  // Starts the wheel at tick now.
+  TimerWheel(uint64_t now);
+  virtual ~TimerWheel();
+
+  // Makes room for timers with IDs below num_ids, so Schedule() doesn't
+  // allocate for them.
+  void Reserve(size_t num_ids);
+
+  // Schedules timer id to expire at tick expiry (or on the next tick, if
+  // that is already past), replacing any expiry it was scheduled for.
+  void Schedule(Id id, uint64_t expiry);
+
+  // Unschedules timer id. Does nothing if it isn't scheduled.
+  void Cancel(Id id);
+
+  bool IsScheduled(Id id) const {
+    return id < timers_.size() && timers_[id].level_ != kUnscheduled;
+  }
+
+  // Returns the tick timer id, which must be scheduled, expires at.
+  uint64_t GetExpiry(Id id) const { return timers_[id].expiry_; }
+
+  // Returns the number of timers scheduled.
+  size_t Size() const { return size_; }
+
+  // Adds the timers, scheduled or not, to component of usage.
+  void AddMemoryUsage(MemoryUsage& usage, size_t& component) const {
+    usage.AddBlock(component, timers_.capacity() * sizeof(Timer));
+  }
+
+  // Returns the last tick the wheel has fully advanced through.
+  uint64_t Now() const { return now_; }
+
+  // Advances the wheel to tick now, calling on_expired(id) for each timer
+  // that expires on the way, after unscheduling it. Cascading or expiring
+  // a timer is one unit of work; stops after max_work of them, and
+  // returns false if it did before reaching now. Calling again picks up
+  // where it left off. Runs of ticks with nothing to do are skipped.
+  bool Advance(uint64_t now, size_t max_work, const function<void(Id)>& on_expired);
+
+private:
+  static constexpr Id kNullId = numeric_limits<Id>::max();
+  static constexpr uint8_t kUnscheduled = numeric_limits<uint8_t>::max();
+
+  struct Timer {
+    uint64_t expiry_ = 0;
+    // Links to the other timers in the same slot.
+    Id next_ = kNullId;
+    Id prev_ = kNullId;
+    uint8_t level_ = kUnscheduled;
+    uint8_t slot_ = 0;
+  };
+
+  // Adds timer id to the slot it belongs in, given that tick is the next
+  // one to be processed (or the one being processed).
+  void Link(Id id, uint64_t tick);
+
+  // Removes timer id from its slot.
+  void Unlink(Id id);
+
+  // Returns the first tick after now_ on which some slot has timers to
+  // cascade or expire. There must be at least one timer scheduled.
+  uint64_t GetNextEventTick() const;
+
+  vector<Timer> timers_;
+  // The first timer in each slot.
+  Id heads_[kNumLevels][kNumSlots];
+  // A bit per slot, set if the slot has any timers.
+  uint64_t occupied_[kNumLevels];
+  uint64_t now_;
+  size_t size_ = 0;
+};
+
+#endif /* timer_wheel_hpp */
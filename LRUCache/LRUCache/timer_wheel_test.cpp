@@ -0,0 +1,154 @@
+//
+//  timer_wheel_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "timer_wheel_test.hpp"
+#include "timer_wheel.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+void TIMER_WHEEL_TEST_EXPIRE() {
+  TimerWheel wheel(1000);
+  vector<TimerWheel::Id> expired;
+  auto on_expired = [&expired](TimerWheel::Id id) { expired.push_back(id); };
+
+  // One timer in range of each level, one out of range of all of them,
+  // and one already past.
+  wheel.Schedule(0, 1010);
+  wheel.Schedule(1, 1000 + 100);
+  wheel.Schedule(2, 1000 + 5000);
+  wheel.Schedule(3, 1000 + 300000);
+  wheel.Schedule(4, 1000 + 20000000);
+  wheel.Schedule(5, 900);
+  assert(wheel.Size() == 6);
+  assert(wheel.IsScheduled(3));
+  assert(wheel.GetExpiry(3) == 301000);
+
+  // Each expires on its tick, not before.
+  assert(wheel.Advance(1001, 1000, on_expired));
+  assert(expired == vector<TimerWheel::Id>({ 5 }));
+  assert(wheel.Advance(1009, 1000, on_expired));
+  assert(expired.size() == 1);
+  assert(wheel.Advance(1010, 1000, on_expired));
+  assert(expired == vector<TimerWheel::Id>({ 5, 0 }));
+  assert(!wheel.IsScheduled(0));
+  assert(wheel.Advance(1099, 1000, on_expired));
+  assert(wheel.Advance(1100, 1000, on_expired));
+  assert(expired.back() == 1);
+  assert(wheel.Advance(5999, 1000, on_expired));
+  assert(expired.size() == 3);
+  assert(wheel.Advance(6000, 1000, on_expired));
+  assert(expired.back() == 2);
+  assert(wheel.Advance(300999, 1000, on_expired));
+  assert(expired.size() == 4);
+  assert(wheel.Advance(301000, 1000, on_expired));
+  assert(expired.back() == 3);
+  assert(wheel.Advance(20000999, 1000, on_expired));
+  assert(expired.size() == 5);
+  assert(wheel.Advance(20001000, 1000, on_expired));
+  assert(expired.back() == 4);
+  assert(wheel.Size() == 0);
+  assert(wheel.Now() == 20001000);
+}
+
+void TIMER_WHEEL_TEST_CANCEL_AND_RESCHEDULE() {
+  TimerWheel wheel(0);
+  vector<TimerWheel::Id> expired;
+  auto on_expired = [&expired](TimerWheel::Id id) { expired.push_back(id); };
+
+  wheel.Schedule(7, 10);
+  wheel.Schedule(8, 10);
+  wheel.Schedule(9, 10);
+  wheel.Cancel(8);
+  wheel.Cancel(8);
+  assert(!wheel.IsScheduled(8));
+  assert(wheel.Size() == 2);
+
+  // Rescheduling moves the timer rather than adding a second one.
+  wheel.Schedule(9, 5000);
+  assert(wheel.Size() == 2);
+  assert(wheel.Advance(10, 1000, on_expired));
+  assert(expired == vector<TimerWheel::Id>({ 7 }));
+  assert(wheel.Advance(5000, 1000, on_expired));
+  assert(expired == vector<TimerWheel::Id>({ 7, 9 }));
+}
+
+void TIMER_WHEEL_TEST_BOUNDED_WORK() {
+  TimerWheel wheel(0);
+  vector<TimerWheel::Id> expired;
+  auto on_expired = [&expired](TimerWheel::Id id) { expired.push_back(id); };
+
+  // 100 timers on one far tick, each has to be cascaded down and expired.
+  for (TimerWheel::Id id = 0; id < 100; ++id) {
+    wheel.Schedule(id, 100000);
+  }
+
+  // Each call does no more than its budget, and picks up where the last
+  // one stopped.
+  size_t num_calls = 0;
+  while (!wheel.Advance(200000, 10, on_expired)) {
+    assert(expired.size() <= 10 * ++num_calls);
+  }
+  assert(expired.size() == 100);
+  assert(wheel.Size() == 0);
+  assert(wheel.Now() == 200000);
+}
+
+void TIMER_WHEEL_TEST_RANDOM() {
+  // Compare against a map of id to expiry, over random schedules, cancels
+  // and advances of all sizes.
+  TimerWheel wheel(0);
+  map<TimerWheel::Id, uint64_t> expiries;
+  uint64_t now = 0;
+  auto on_expired = [&expiries, &now](TimerWheel::Id id) {
+    assert(expiries.count(id));
+    assert(expiries[id] <= now);
+    expiries.erase(id);
+  };
+
+  for (int i = 0; i < 20000; ++i) {
+    TimerWheel::Id id = rand() % 500;
+    switch (rand() % 4) {
+      case 0:
+      case 1: {
+        static const uint64_t kRanges[] = { 10, 100, 10000, 1000000, 100000000 };
+        uint64_t expiry = now + rand() % kRanges[rand() % 5];
+        wheel.Schedule(id, expiry);
+        expiries[id] = max(expiry, now + 1);
+        break;
+      }
+      case 2:
+        wheel.Cancel(id);
+        expiries.erase(id);
+        break;
+      case 3: {
+        static const uint64_t kSteps[] = { 1, 50, 5000, 500000, 50000000 };
+        now += rand() % kSteps[rand() % 5];
+        while (!wheel.Advance(now, 1 + rand() % 100, on_expired)) {
+        }
+        // Everything due has expired.
+        for (const pair<const TimerWheel::Id, uint64_t>& entry : expiries) {
+          assert(entry.second > now);
+          assert(wheel.IsScheduled(entry.first));
+        }
+        break;
+      }
+    }
+    assert(wheel.Size() == expiries.size());
+  }
+}
+
+void RUN_TIMER_WHEEL_TESTS() {
+  TIMER_WHEEL_TEST_EXPIRE();
+  TIMER_WHEEL_TEST_CANCEL_AND_RESCHEDULE();
+  TIMER_WHEEL_TEST_BOUNDED_WORK();
+  TIMER_WHEEL_TEST_RANDOM();
+}
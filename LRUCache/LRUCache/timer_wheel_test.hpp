@@ -0,0 +1,13 @@
+//
+//  timer_wheel_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef timer_wheel_test_hpp
+#define timer_wheel_test_hpp
+
+extern void RUN_TIMER_WHEEL_TESTS();
+
+#endif /* timer_wheel_test_hpp */
@@ -0,0 +1,152 @@
+//
+//  trace.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "trace.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// log1p(x) / x and expm1(x) / x, by their Taylor series near 0, where
+// dividing would lose precision.
+double Log1pOverX(double x) {
+  return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+double Expm1OverX(double x) {
+  return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+// Removes and returns the first word of line, empty if there is none.
+string_view NextWord(string_view& line) {
+  size_t start = line.find_first_not_of(" \t\r");
+  if (start == string_view::npos) {
+    line = string_view();
+    return string_view();
+  }
+  size_t end = min(line.find_first_of(" \t\r", start), line.size());
+  string_view word = line.substr(start, end - start);
+  line.remove_prefix(end);
+  return word;
+}
+
+} // namespace
+
+ZipfDistribution::ZipfDistribution(uint64_t num_keys, double s) : num_keys_(double(num_keys)), s_(s) {
+  assert(num_keys > 0 && s > 0);
+  h_integral_x1_ = HIntegral(1.5) - 1;
+  h_integral_num_keys_ = HIntegral(num_keys_ + 0.5);
+  threshold_ = 2 - HIntegralInverse(HIntegral(2.5) - H(2));
+}
+
+double ZipfDistribution::H(double x) const {
+  return exp(-s_ * log(x));
+}
+
+double ZipfDistribution::HIntegral(double x) const {
+  double log_x = log(x);
+  return Expm1OverX((1 - s_) * log_x) * log_x;
+}
+
+double ZipfDistribution::HIntegralInverse(double x) const {
+  double t = x * (1 - s_);
+  if (t < -1) {
+    t = -1;
+  }
+  return exp(Log1pOverX(t) * x);
+}
+
+Trace ZipfTrace(uint64_t num_keys, size_t num_ops, double s, uint32_t seed) {
+  ZipfDistribution zipf(num_keys, s);
+  mt19937_64 rng(seed);
+  Trace trace(num_ops);
+  for (TraceOp& op : trace) {
+    op.key_ = zipf(rng);
+  }
+  return trace;
+}
+
+Trace HotspotTrace(uint64_t num_keys, size_t num_ops, int hot_percent, uint32_t seed) {
+  mt19937_64 rng(seed);
+  uint64_t num_hot_keys = max<uint64_t>(num_keys / 10, 1);
+  Trace trace(num_ops);
+  for (TraceOp& op : trace) {
+    uint64_t range = int(rng() % 100) < hot_percent ? num_hot_keys : num_keys;
+    op.key_ = rng() % range;
+  }
+  return trace;
+}
+
+Trace ScanTrace(uint64_t num_keys, size_t num_ops, uint64_t first_key) {
+  Trace trace(num_ops);
+  for (size_t i = 0; i < num_ops; ++i) {
+    trace[i].key_ = first_key + i % num_keys;
+  }
+  return trace;
+}
+
+void InterleaveScans(Trace& trace, size_t scan_period, size_t scan_length, uint64_t first_key) {
+  for (size_t i = 0; i < trace.size(); ++i) {
+    if (i % scan_period < scan_length && i % 2 == 0) {
+      trace[i] = { first_key++, false };
+    }
+  }
+}
+
+void MixWrites(Trace& trace, int write_percent, uint32_t seed) {
+  mt19937_64 rng(seed);
+  for (TraceOp& op : trace) {
+    op.put_ = int(rng() % 100) < write_percent;
+  }
+}
+
+optional<Trace> LoadTrace(const string& path) {
+  ifstream file(path);
+  if (!file) {
+    return nullopt;
+  }
+  Trace trace;
+  unordered_map<string, uint64_t> key_numbers;
+  string line;
+  while (getline(file, line)) {
+    string_view rest = line;
+    string_view word = NextWord(rest);
+    if (word.empty()) {
+      continue;
+    }
+    bool put = false;
+    if (word == "get" || word == "put") {
+      put = word == "put";
+      word = NextWord(rest);
+      if (word.empty()) {
+        return nullopt;
+      }
+    }
+    auto [it, inserted] = key_numbers.try_emplace(string(word), key_numbers.size());
+    trace.push_back({ it->second, put });
+  }
+  if (file.bad()) {
+    return nullopt;
+  }
+  return trace;
+}
+
+bool SaveTrace(const string& path, const Trace& trace) {
+  ofstream file(path);
+  for (const TraceOp& op : trace) {
+    if (op.put_) {
+      file << "put ";
+    }
+    file << op.key_ << '\n';
+  }
+  file.close();
+  return !file.fail();
+}
@@ -0,0 +1,146 @@
+//
+//  trace.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef trace_hpp
+#define trace_hpp
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cache_stats.hpp"
+
+using namespace std;
+
+// Workloads for benchmarking caches: traces of operations on keys
+// numbered from 0, generated (Zipf, hotspot, scans, mixes of reads and
+// writes) or read back from a file, and RunTrace() to replay one against
+// a cache. Generating is a few ns per op, so traces of tens of millions
+// of ops take seconds.
+
+// One operation of a trace: a lookup of key_, read-through (a Put() if
+// it misses), or if put_, a Put() of key_.
+struct TraceOp {
+  uint64_t key_;
+  bool put_ = false;
+};
+
+using Trace = vector<TraceOp>;
+
+// Draws ranks from 0 to num_keys - 1 with probability proportional to
+// 1 / (rank + 1)^s, by rejection-inversion (Hörmann and Derflinger), so
+// in constant time and memory whatever num_keys is. s must be positive.
+class ZipfDistribution {
+public:
+  ZipfDistribution(uint64_t num_keys, double s);
+
+  template <typename Rng>
+  uint64_t operator()(Rng& rng) const {
+    uniform_real_distribution<double> uniform(0, 1);
+    while (true) {
+      double u = h_integral_num_keys_ + uniform(rng) * (h_integral_x1_ - h_integral_num_keys_);
+      double x = HIntegralInverse(u);
+      double k = floor(x + 0.5);
+      k = k < 1 ? 1 : k > num_keys_ ? num_keys_ : k;
+      if (k - x <= threshold_ || u >= HIntegral(k + 0.5) - H(k)) {
+        return uint64_t(k) - 1;
+      }
+    }
+  }
+
+private:
+  double H(double x) const;
+  double HIntegral(double x) const;
+  double HIntegralInverse(double x) const;
+
+  double num_keys_;
+  double s_;
+  double h_integral_x1_;
+  double h_integral_num_keys_;
+  double threshold_;
+};
+
+// Returns num_ops lookups of keys from 0 to num_keys - 1, Zipf-distributed
+// with exponent s, key 0 the most popular.
+Trace ZipfTrace(uint64_t num_keys, size_t num_ops, double s, uint32_t seed = 1);
+
+// Returns num_ops lookups of keys from 0 to num_keys - 1, hot_percent of
+// them uniformly in the first tenth of the keys, the rest uniformly over
+// all of them.
+Trace HotspotTrace(uint64_t num_keys, size_t num_ops, int hot_percent, uint32_t seed = 1);
+
+// Returns num_ops lookups of keys first_key, first_key + 1, and so on,
+// looping back every num_keys. A loop longer than the cache is LRU's
+// worst case: every lookup misses.
+Trace ScanTrace(uint64_t num_keys, size_t num_ops, uint64_t first_key = 0);
+
+// Replaces every other op of the first scan_length in each scan_period of
+// trace with a lookup of a key never seen before, counting up from
+// first_key: a scan of cold keys, interleaved with the workload.
+void InterleaveScans(Trace& trace, size_t scan_period, size_t scan_length, uint64_t first_key);
+
+// Turns write_percent of trace's ops, at random, into Put()s.
+void MixWrites(Trace& trace, int write_percent, uint32_t seed = 1);
+
+// Reads a trace recorded as text, one op per line: a key, optionally
+// after "get " or "put ". Keys can be any word; they are numbered in the
+// order they first appear, so a trace saved and loaded back keeps which
+// ops share a key, not the numbers. Returns nullopt if the file can't be
+// read.
+optional<Trace> LoadTrace(const string& path);
+
+// Writes trace in the format LoadTrace() reads. Returns false on failure.
+bool SaveTrace(const string& path, const Trace& trace);
+
+// What replaying a trace measured.
+struct TraceResult {
+  uint64_t num_ops_ = 0;
+  uint64_t num_lookups_ = 0;
+  uint64_t num_hits_ = 0;
+  double seconds_ = 0;
+  // Per op, including a lookup's Put() on a miss. Empty unless asked for.
+  LatencyHistogram latency_;
+
+  double HitRatio() const { return num_lookups_ ? double(num_hits_) / num_lookups_ : 0; }
+  double OpsPerSecond() const { return seconds_ > 0 ? num_ops_ / seconds_ : 0; }
+};
+
+// Replays trace against cache, whose keys and values must be constructible
+// from a uint64_t: each key is cached with itself as its value. Timing
+// every op costs two clock reads each, so only does it if
+// record_latencies.
+template <typename Cache>
+TraceResult RunTrace(Cache& cache, const Trace& trace, bool record_latencies = true) {
+  using Key = typename Cache::KeyType;
+  using Value = typename Cache::ValueType;
+  TraceResult result;
+  LatencyHistogram* latency = record_latencies ? &result.latency_ : nullptr;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (const TraceOp& op : trace) {
+    ScopedLatency timer(latency);
+    Key key(op.key_);
+    if (op.put_) {
+      cache.Put(key, Value(op.key_));
+    } else {
+      ++result.num_lookups_;
+      if (cache.Get(key)) {
+        ++result.num_hits_;
+      } else {
+        cache.Put(key, Value(op.key_));
+      }
+    }
+  }
+  result.seconds_ = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  result.num_ops_ = trace.size();
+  return result;
+}
+
+#endif /* trace_hpp */
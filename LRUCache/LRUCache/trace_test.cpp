@@ -0,0 +1,146 @@
+//
+//  trace_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "trace_test.hpp"
+#include "trace.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "lru_cache.hpp"
+
+using namespace std;
+
+void TRACE_TEST_ZIPF() {
+  constexpr uint64_t kNumKeys = 1000;
+  constexpr size_t kNumOps = 1000000;
+  for (double s : { 0.5, 0.99, 1.0, 1.2 }) {
+    Trace trace = ZipfTrace(kNumKeys, kNumOps, s);
+    vector<size_t> counts(kNumKeys);
+    for (const TraceOp& op : trace) {
+      assert(op.key_ < kNumKeys && !op.put_);
+      ++counts[op.key_];
+    }
+
+    // Each of the top ranks is drawn in proportion to 1 / (rank + 1)^s.
+    double sum = 0;
+    for (uint64_t rank = 1; rank <= kNumKeys; ++rank) {
+      sum += pow(rank, -s);
+    }
+    for (uint64_t rank = 0; rank < 10; ++rank) {
+      double expected = kNumOps * pow(rank + 1, -s) / sum;
+      assert(fabs(counts[rank] - expected) < 0.05 * expected);
+    }
+  }
+
+  // One key is always drawn.
+  for (const TraceOp& op : ZipfTrace(1, 100, 0.9)) {
+    assert(op.key_ == 0);
+  }
+}
+
+void TRACE_TEST_HOTSPOT() {
+  constexpr uint64_t kNumKeys = 10000;
+  constexpr size_t kNumOps = 100000;
+  Trace trace = HotspotTrace(kNumKeys, kNumOps, 80);
+  size_t num_hot = 0;
+  for (const TraceOp& op : trace) {
+    assert(op.key_ < kNumKeys);
+    num_hot += op.key_ < kNumKeys / 10;
+  }
+  // 80% to the hot keys, plus a tenth of the other 20%.
+  assert(num_hot > 0.81 * kNumOps && num_hot < 0.83 * kNumOps);
+}
+
+void TRACE_TEST_SCANS() {
+  Trace trace = ScanTrace(3, 7, 10);
+  vector<uint64_t> keys;
+  for (const TraceOp& op : trace) {
+    keys.push_back(op.key_);
+  }
+  assert((keys == vector<uint64_t>{ 10, 11, 12, 10, 11, 12, 10 }));
+
+  // Every other op of the first 4 in each 6 becomes a new key from 100.
+  trace = ScanTrace(1, 12);
+  InterleaveScans(trace, 6, 4, 100);
+  keys.clear();
+  for (const TraceOp& op : trace) {
+    keys.push_back(op.key_);
+  }
+  assert((keys == vector<uint64_t>{ 100, 0, 101, 0, 0, 0, 102, 0, 103, 0, 0, 0 }));
+}
+
+void TRACE_TEST_MIX_WRITES() {
+  Trace trace = ZipfTrace(1000, 100000, 0.9);
+  MixWrites(trace, 10);
+  size_t num_puts = 0;
+  for (const TraceOp& op : trace) {
+    num_puts += op.put_;
+  }
+  assert(num_puts > 9000 && num_puts < 11000);
+}
+
+void TRACE_TEST_SAVE_LOAD() {
+  string path = "/tmp/trace_test_save_load";
+  {
+    ofstream file(path);
+    file << "alpha\nget beta\n\nput alpha\n  gamma \nbeta\n";
+  }
+  optional<Trace> trace = LoadTrace(path);
+  assert(trace && trace->size() == 5);
+  vector<pair<uint64_t, bool>> ops;
+  for (const TraceOp& op : *trace) {
+    ops.emplace_back(op.key_, op.put_);
+  }
+  assert((ops == vector<pair<uint64_t, bool>>{ { 0, false }, { 1, false }, { 0, true }, { 2, false }, { 1, false } }));
+
+  // Saved and loaded back, it is the same trace.
+  assert(SaveTrace(path, *trace));
+  optional<Trace> reloaded = LoadTrace(path);
+  assert(reloaded && reloaded->size() == trace->size());
+  for (size_t i = 0; i < trace->size(); ++i) {
+    assert((*reloaded)[i].key_ == (*trace)[i].key_ && (*reloaded)[i].put_ == (*trace)[i].put_);
+  }
+
+  {
+    ofstream file(path);
+    file << "put\n";
+  }
+  assert(!LoadTrace(path));
+  unlink(path.c_str());
+  assert(!LoadTrace(path));
+}
+
+void TRACE_TEST_RUN() {
+  // A loop of 10 keys through a cache of 5 never hits under LRU.
+  LRUCache<uint64_t, uint64_t> cache(5);
+  TraceResult result = RunTrace(cache, ScanTrace(10, 100));
+  assert(result.num_ops_ == 100 && result.num_lookups_ == 100);
+  assert(result.num_hits_ == 0 && result.HitRatio() == 0);
+  assert(result.latency_.Count() == 100);
+
+  // A loop of 5 hits after the first time round. Puts aren't lookups.
+  Trace trace = ScanTrace(5, 100);
+  trace[0].put_ = true;
+  result = RunTrace(cache, trace, false);
+  assert(result.num_lookups_ == 99 && result.num_hits_ == 95);
+  assert(result.latency_.Count() == 0);
+  assert(*cache.Get(3) == 3);
+}
+
+void RUN_TRACE_TESTS() {
+  TRACE_TEST_ZIPF();
+  TRACE_TEST_HOTSPOT();
+  TRACE_TEST_SCANS();
+  TRACE_TEST_MIX_WRITES();
+  TRACE_TEST_SAVE_LOAD();
+  TRACE_TEST_RUN();
+}
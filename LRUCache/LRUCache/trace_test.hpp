@@ -0,0 +1,13 @@
+//
+//  trace_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef trace_test_hpp
+#define trace_test_hpp
+
+extern void RUN_TRACE_TESTS();
+
+#endif /* trace_test_hpp */
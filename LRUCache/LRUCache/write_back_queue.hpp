@@ -0,0 +1,149 @@
+//
+//  write_back_queue.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef write_back_queue_hpp
+#define write_back_queue_hpp
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// A bounded queue of entries to be written back to the store behind a
+// cache, drained by a background thread, so that whoever evicts a dirty
+// entry (an LRUCache's Put(), say) pays for moving it into the queue but
+// not for the write. The thread hands entries to a Writer in batches of
+// up to max_batch_size, in the order they were pushed.
+//
+// Push() blocks while the queue is full, so a store that can't keep up
+// slows its writers down rather than letting the queue grow without
+// bound. The Writer runs without the queue's lock, but must not call into
+// a cache that pushes to this queue, which may be blocked in Push().
+//
+// Key and Value must be default-constructible, since the queue's slots
+// are allocated up front; entries are moved in and out, never copied.
+template <typename Key, typename Value>
+class WriteBackQueue {
+public:
+  using Entry = pair<Key, Value>;
+  using Writer = function<void(span<Entry>)>;
+
+  static constexpr size_t kDefaultMaxBatchSize = 64;
+
+  // A queue of at most capacity entries, written back by writer. Starts
+  // the background thread.
+  WriteBackQueue(Writer writer, size_t capacity, size_t max_batch_size = kDefaultMaxBatchSize)
+      : writer_(std::move(writer)),
+        entries_(capacity),
+        max_batch_size_(max_batch_size) {
+    assert(writer_ && capacity > 0 && max_batch_size > 0);
+    batch_.reserve(min(capacity, max_batch_size));
+    thread_ = thread([this]() { Drain(); });
+  }
+
+  // Writes back whatever is still queued, then stops the thread.
+  virtual ~WriteBackQueue() {
+    {
+      lock_guard<mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    not_empty_.notify_one();
+    thread_.join();
+  }
+
+  // Queues an entry to be written back, moving from key and value.
+  // Blocks while the queue is full.
+  void Push(Key&& key, Value&& value) {
+    unique_lock<mutex> lock(mutex_);
+    not_full_.wait(lock, [this]() { return size_ < entries_.size(); });
+    Entry& entry = entries_[(head_ + size_) % entries_.size()];
+    entry.first = std::move(key);
+    entry.second = std::move(value);
+    ++size_;
+    ++num_pushed_;
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+
+  // Blocks until every entry pushed before the call has been written.
+  void Flush() {
+    unique_lock<mutex> lock(mutex_);
+    uint64_t num_pushed = num_pushed_;
+    written_.wait(lock, [this, num_pushed]() { return num_written_ >= num_pushed; });
+  }
+
+  // Returns the number of entries waiting for the thread to take them.
+  size_t Size() const {
+    lock_guard<mutex> lock(mutex_);
+    return size_;
+  }
+
+  size_t Capacity() const { return entries_.size(); }
+
+  // Returns the number of entries written back so far.
+  uint64_t NumWritten() const {
+    lock_guard<mutex> lock(mutex_);
+    return num_written_;
+  }
+
+private:
+  // The background thread: takes up to a batch at a time off the queue
+  // and writes it, until stopped with the queue empty.
+  void Drain() {
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+      not_empty_.wait(lock, [this]() { return size_ > 0 || stopping_; });
+      if (size_ == 0) {
+        return;
+      }
+
+      while (size_ > 0 && batch_.size() < max_batch_size_) {
+        batch_.push_back(std::move(entries_[head_]));
+        head_ = (head_ + 1) % entries_.size();
+        --size_;
+      }
+      lock.unlock();
+      not_full_.notify_all();
+
+      writer_(span<Entry>(batch_));
+      size_t num_written = batch_.size();
+      batch_.clear();
+
+      lock.lock();
+      num_written_ += num_written;
+      written_.notify_all();
+    }
+  }
+
+  Writer writer_;
+  // A ring buffer of size_ entries, starting at head_.
+  vector<Entry> entries_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+  size_t max_batch_size_;
+  // The entries being written, only touched by the thread.
+  vector<Entry> batch_;
+  uint64_t num_pushed_ = 0;
+  uint64_t num_written_ = 0;
+  bool stopping_ = false;
+
+  mutable mutex mutex_;
+  condition_variable not_empty_;
+  condition_variable not_full_;
+  condition_variable written_;
+  thread thread_;
+};
+
+#endif /* write_back_queue_hpp */
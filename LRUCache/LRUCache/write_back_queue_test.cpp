@@ -0,0 +1,94 @@
+//
+//  write_back_queue_test.cpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#include "write_back_queue_test.hpp"
+#include "write_back_queue.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void WRITE_BACK_QUEUE_TEST_BATCHES() {
+  vector<int> written;
+  size_t max_batch = 0;
+  WriteBackQueue<int, int> queue([&](span<pair<int, int>> batch) {
+    max_batch = max(max_batch, batch.size());
+    for (const pair<int, int>& entry : batch) {
+      written.push_back(entry.first * 100 + entry.second);
+    }
+  }, 100, 8);
+
+  for (int i = 0; i < 50; ++i) {
+    queue.Push(int(i), int(i % 10));
+  }
+  queue.Flush();
+
+  // Everything is written, in order, no more than a batch at a time.
+  assert(queue.NumWritten() == 50);
+  assert(queue.Size() == 0);
+  assert(written.size() == 50);
+  for (int i = 0; i < 50; ++i) {
+    assert(written[i] == i * 100 + i % 10);
+  }
+  assert(max_batch >= 1 && max_batch <= 8);
+}
+
+void WRITE_BACK_QUEUE_TEST_BOUNDED() {
+  // The writer holds up the queue until released.
+  mutex blocked;
+  blocked.lock();
+  WriteBackQueue<int, unique_ptr<int>> queue([&blocked](span<pair<int, unique_ptr<int>>> batch) {
+    lock_guard<mutex> lock(blocked);
+  }, 4, 1);
+
+  // One entry is taken by the blocked writer, four more fill the queue,
+  // and the next Push() has to wait for room.
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(int(i), make_unique<int>(i));
+  }
+  while (queue.Size() != 4) {
+    this_thread::yield();
+  }
+  bool pushed = false;
+  thread pusher([&queue, &pushed]() {
+    queue.Push(5, make_unique<int>(5));
+    pushed = true;
+  });
+  this_thread::sleep_for(chrono::milliseconds(20));
+  assert(queue.Size() == 4);
+
+  blocked.unlock();
+  pusher.join();
+  assert(pushed);
+  queue.Flush();
+  assert(queue.NumWritten() == 6);
+}
+
+void WRITE_BACK_QUEUE_TEST_DESTROY_DRAINS() {
+  size_t num_written = 0;
+  {
+    WriteBackQueue<int, int> queue([&num_written](span<pair<int, int>> batch) {
+      num_written += batch.size();
+    }, 1000);
+    for (int i = 0; i < 1000; ++i) {
+      queue.Push(int(i), int(i));
+    }
+  }
+  assert(num_written == 1000);
+}
+
+void RUN_WRITE_BACK_QUEUE_TESTS() {
+  WRITE_BACK_QUEUE_TEST_BATCHES();
+  WRITE_BACK_QUEUE_TEST_BOUNDED();
+  WRITE_BACK_QUEUE_TEST_DESTROY_DRAINS();
+}
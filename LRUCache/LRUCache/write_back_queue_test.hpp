@@ -0,0 +1,13 @@
+//
+//  write_back_queue_test.hpp
+//  LRUCache
+//
+//  Created by Roger Tinkoff on 10/16/26.
+//
+
+#ifndef write_back_queue_test_hpp
+#define write_back_queue_test_hpp
+
+extern void RUN_WRITE_BACK_QUEUE_TESTS();
+
+#endif /* write_back_queue_test_hpp */